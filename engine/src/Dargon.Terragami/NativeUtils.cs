@@ -1,24 +1,702 @@
 ﻿using System;
 using System.Collections.Generic;
+using System.Linq;
 using System.Runtime.InteropServices;
 using System.Text;
+using Dargon.PlayOn;
+using Dargon.PlayOn.DataStructures;
 using Dargon.PlayOn.Geometry;
+using Dargon.Terragami.Sectors;
 
 namespace Dargon.Terragami {
    public static unsafe class NativeUtils {
+      // Segments are packed natively, truncated to int16, so large sets don't need a stack copy.
       public static ApiResult LoadPrequeryAnySegmentIntersections(IntLineSegment2[] segments, out IntPtr handle) {
-         var buffer = stackalloc seg2i16[segments.Length];
-         
-         var current = buffer;
-         foreach (var b in segments) {
-            current->x1 = (short)b.X1;
-            current->y1 = (short)b.Y1;
-            current->x2 = (short)b.X2;
-            current->y2 = (short)b.Y2;
-            current++;
+         fixed (IntLineSegment2* pSegments = segments) {
+            return LoadPrequeryAnySegmentIntersectionsI32(pSegments, segments.Length, out handle);
          }
+      }
+
+      // BarrierCalculator.CalculateContourAndChildHoleBarriers' barriers, computed natively and packed
+      // straight into a prequery state for QueryAnySegmentIntersections. Zero-length edges are skipped.
+      public static ApiResult LoadPrequeryContourBarrierIntersections(PolygonNode root, out IntPtr handle, int exaggerationFactor = 10) {
+         PlayOn.Triangulator.FlattenPolygonTree(root, out var points, out var contourOffsets, out var contourParents);
+         return LoadPrequeryContourBarrierIntersections(points, contourOffsets, contourParents.Length, out handle, exaggerationFactor);
+      }
+
+      public static ApiResult LoadPrequeryContourBarrierIntersections(IntVector2[] points, int[] contourOffsets, int numContours, out IntPtr handle, int exaggerationFactor = 10) {
+         fixed (IntVector2* pPoints = points)
+         fixed (int* pContourOffsets = contourOffsets) {
+            return LoadPrequeryContourBarrierIntersections(pPoints, pContourOffsets, numContours, exaggerationFactor, out handle);
+         }
+      }
+
+      public static (int, int)[] FindAllSegmentIntersections(IntLineSegment2[] segments, bool detectEndpointContainment = false) {
+         var pairs = new pair2i32[segments.Length];
+         int numPairs;
+         fixed (IntLineSegment2* pSegments = segments) {
+            while (true) {
+               ApiResult res;
+               fixed (pair2i32* pPairs = pairs) {
+                  res = FindAllSegmentIntersections(pSegments, segments.Length, detectEndpointContainment, pPairs, pairs.Length, out numPairs);
+               }
+
+               if (res == ApiResult.Success) break;
+               if (res != ApiResult.ErrorInsufficientBuffer) throw new InvalidOperationException(res.ToString());
+               pairs = new pair2i32[numPairs];
+            }
+         }
+
+         var results = new (int, int)[numPairs];
+         for (var i = 0; i < numPairs; i++) {
+            results[i] = (pairs[i].a, pairs[i].b);
+         }
+         return results;
+      }
+
+      // Floyd-Warshall over an undirected CSR graph. Results are row-major [i * n + j]: the i-j
+      // distance (+inf if unreachable) and the node before j on that path, i.e. j's first hop towards i.
+      // That's the transpose of the managed Floyd-Warshall LUT: res[i][j].PriorIndex == predecessors[j * n + i].
+      public static (float[] costs, int[] predecessors) ComputeAllPairsShortestPaths(int[] offsets, int[] edgeTargets, float[] edgeCosts) {
+         var numNodes = offsets.Length - 1;
+         var costs = new float[numNodes * numNodes];
+         var predecessors = new int[numNodes * numNodes];
+         fixed (int* pOffsets = offsets)
+         fixed (int* pEdgeTargets = edgeTargets)
+         fixed (float* pEdgeCosts = edgeCosts)
+         fixed (float* pCosts = costs)
+         fixed (int* pPredecessors = predecessors) {
+            var res = ComputeAllPairsShortestPaths(pOffsets, pEdgeTargets, pEdgeCosts, numNodes, pCosts, pPredecessors);
+            if (res != ApiResult.Success) throw new InvalidOperationException(res.ToString());
+         }
+         return (costs, predecessors);
+      }
+
+      public static (float[] costs, int[] predecessors) Dijkstras(int[] offsets, int[] edgeTargets, float[] edgeCosts, dijkstra_seed[] seeds, int[] terminals = null) {
+         var numNodes = offsets.Length - 1;
+         var costs = new float[numNodes];
+         var predecessors = new int[numNodes];
+         fixed (int* pOffsets = offsets)
+         fixed (int* pEdgeTargets = edgeTargets)
+         fixed (float* pEdgeCosts = edgeCosts)
+         fixed (dijkstra_seed* pSeeds = seeds)
+         fixed (int* pTerminals = terminals)
+         fixed (float* pCosts = costs)
+         fixed (int* pPredecessors = predecessors) {
+            var res = Dijkstras(pOffsets, pEdgeTargets, pEdgeCosts, numNodes, pSeeds, seeds.Length, pTerminals, terminals?.Length ?? 0, pCosts, pPredecessors);
+            if (res != ApiResult.Success) throw new InvalidOperationException(res.ToString());
+         }
+         return (costs, predecessors);
+      }
+
+      // Row s of the results is a single-source Dijkstras from sources[s]; same layout as ComputeAllPairsShortestPaths.
+      public static (float[] costs, int[] predecessors) DijkstrasBatch(int[] offsets, int[] edgeTargets, float[] edgeCosts, int[] sources) {
+         var numNodes = offsets.Length - 1;
+         var costs = new float[sources.Length * numNodes];
+         var predecessors = new int[sources.Length * numNodes];
+         fixed (int* pOffsets = offsets)
+         fixed (int* pEdgeTargets = edgeTargets)
+         fixed (float* pEdgeCosts = edgeCosts)
+         fixed (int* pSources = sources)
+         fixed (float* pCosts = costs)
+         fixed (int* pPredecessors = predecessors) {
+            var res = DijkstrasBatch(pOffsets, pEdgeTargets, pEdgeCosts, numNodes, pSources, sources.Length, pCosts, pPredecessors);
+            if (res != ApiResult.Success) throw new InvalidOperationException(res.ToString());
+         }
+         return (costs, predecessors);
+      }
+
+      // Returns the waypoint visibility graph in CSR form; each link appears once per direction.
+      public static (int[] offsets, int[] edgeTargets, float[] edgeCosts) BuildVisibilityGraph(IntVector2[] waypoints, IntLineSegment2[] barriers) {
+         var offsets = new int[waypoints.Length + 1];
+         var edgeTargets = new int[waypoints.Length * 8];
+         var edgeCosts = new float[edgeTargets.Length];
+         int numEdges;
+         fixed (IntVector2* pWaypoints = waypoints)
+         fixed (IntLineSegment2* pBarriers = barriers)
+         fixed (int* pOffsets = offsets) {
+            while (true) {
+               ApiResult res;
+               fixed (int* pEdgeTargets = edgeTargets)
+               fixed (float* pEdgeCosts = edgeCosts) {
+                  res = BuildVisibilityGraph(pWaypoints, waypoints.Length, pBarriers, barriers.Length, pOffsets, pEdgeTargets, pEdgeCosts, edgeTargets.Length, out numEdges);
+               }
+
+               if (res == ApiResult.Success) break;
+               if (res != ApiResult.ErrorInsufficientBuffer) throw new InvalidOperationException(res.ToString());
+               edgeTargets = new int[numEdges];
+               edgeCosts = new float[numEdges];
+            }
+         }
+
+         Array.Resize(ref edgeTargets, numEdges);
+         Array.Resize(ref edgeCosts, numEdges);
+         return (offsets, edgeTargets, edgeCosts);
+      }
+
+      // Packed visibility polygons, one per origin: polygon i is ranges [offsets[i], offsets[i + 1]).
+      // Range r sees barrier rangeIds[r] (-1 if nothing) from pseudo-angle rangeThetaStarts[r] up to the
+      // next range's start (4 for the last), where pseudo-angles are diamond angles in [0, 4).
+      public static (int[] offsets, int[] rangeIds, double[] rangeThetaStarts) BuildVisibilityPolygons(IntVector2[] origins, IntLineSegment2[] barriers) {
+         var offsets = new int[origins.Length + 1];
+         var rangeIds = new int[origins.Length * 32];
+         var rangeThetaStarts = new double[rangeIds.Length];
+         int numRanges;
+         fixed (IntVector2* pOrigins = origins)
+         fixed (IntLineSegment2* pBarriers = barriers)
+         fixed (int* pOffsets = offsets) {
+            while (true) {
+               ApiResult res;
+               fixed (int* pRangeIds = rangeIds)
+               fixed (double* pRangeThetaStarts = rangeThetaStarts) {
+                  res = BuildVisibilityPolygons(pOrigins, origins.Length, pBarriers, barriers.Length, pOffsets, pRangeIds, pRangeThetaStarts, rangeIds.Length, out numRanges);
+               }
 
-         return LoadPrequeryAnySegmentIntersections(buffer, segments.Length, out handle);
+               if (res == ApiResult.Success) break;
+               if (res != ApiResult.ErrorInsufficientBuffer) throw new InvalidOperationException(res.ToString());
+               rangeIds = new int[numRanges];
+               rangeThetaStarts = new double[numRanges];
+            }
+         }
+
+         Array.Resize(ref rangeIds, numRanges);
+         Array.Resize(ref rangeThetaStarts, numRanges);
+         return (offsets, rangeIds, rangeThetaStarts);
+      }
+
+      public static IntPtr LoadVisibilityPolygons(IntVector2[] origins, IntLineSegment2[] barriers) {
+         IntPtr handle;
+         fixed (IntVector2* pOrigins = origins)
+         fixed (IntLineSegment2* pBarriers = barriers) {
+            var res = LoadVisibilityPolygons(pOrigins, origins.Length, pBarriers, barriers.Length, out handle);
+            if (res != ApiResult.Success) throw new InvalidOperationException(res.ToString());
+         }
+         return handle;
+      }
+
+      // For each point, the origins whose visibility polygon contains it and their distances to it:
+      // point i's results are [offsets[i], offsets[i + 1]), origins ascending.
+      public static (int[] offsets, int[] originIndices, float[] distances) QueryVisibilityPolygonsContainingPoints(IntPtr handle, DoubleVector2[] points) {
+         var buffer = new point2f64[points.Length];
+         for (var i = 0; i < points.Length; i++) {
+            buffer[i] = new point2f64((double)points[i].X, (double)points[i].Y);
+         }
+
+         var offsets = new int[points.Length + 1];
+         var originIndices = new int[points.Length * 8];
+         var distances = new float[originIndices.Length];
+         int numResults;
+         fixed (point2f64* pPoints = buffer)
+         fixed (int* pOffsets = offsets) {
+            while (true) {
+               ApiResult res;
+               fixed (int* pOriginIndices = originIndices)
+               fixed (float* pDistances = distances) {
+                  res = QueryVisibilityPolygonsContainingPoints(handle, pPoints, points.Length, pOffsets, pOriginIndices, pDistances, originIndices.Length, out numResults);
+               }
+
+               if (res == ApiResult.Success) break;
+               if (res != ApiResult.ErrorInsufficientBuffer) throw new InvalidOperationException(res.ToString());
+               originIndices = new int[numResults];
+               distances = new float[numResults];
+            }
+         }
+
+         Array.Resize(ref originIndices, numResults);
+         Array.Resize(ref distances, numResults);
+         return (offsets, originIndices, distances);
+      }
+
+      // For each segment, the origins that see part of it as a bitset of (numOrigins + 31) / 32 words:
+      // origin i sees segment s if bit i % 32 of bits[s * wordsPerSegment + i / 32] is set.
+      public static (uint[] bits, int wordsPerSegment) QueryVisibilityPolygonsSeeingSegments(IntPtr handle, int numOrigins, DoubleLineSegment2[] segments) {
+         var buffer = new seg2f64[segments.Length];
+         for (var i = 0; i < segments.Length; i++) {
+            buffer[i] = new seg2f64(segments[i]);
+         }
+
+         var wordsPerSegment = (numOrigins + 31) / 32;
+         var bits = new uint[segments.Length * wordsPerSegment];
+         fixed (seg2f64* pSegments = buffer)
+         fixed (uint* pBits = bits) {
+            var res = QueryVisibilityPolygonsSeeingSegments(handle, pSegments, segments.Length, pBits);
+            if (res != ApiResult.Success) throw new InvalidOperationException(res.ToString());
+         }
+         return (bits, wordsPerSegment);
+      }
+
+      public static IntPtr LoadOverlayGraph(int[] offsets, int[] edgeTargets, float[] edgeCosts) {
+         IntPtr handle;
+         fixed (int* pOffsets = offsets)
+         fixed (int* pEdgeTargets = edgeTargets)
+         fixed (float* pEdgeCosts = edgeCosts) {
+            var res = LoadOverlayGraph(pOffsets, pEdgeTargets, pEdgeCosts, offsets.Length - 1, out handle);
+            if (res != ApiResult.Success) throw new InvalidOperationException(res.ToString());
+         }
+         return handle;
+      }
+
+      // Destination d is terminal -1 - d, reached via terminalLinks { crossover, -1 - d, cost }.
+      // Destination d's path is pathLinks [pathOffsets[d], pathOffsets[d + 1]), seed to terminal.
+      public static (float[] destinationCosts, int[] pathOffsets, dijkstra_seed[] pathLinks) UniformCostSearch(IntPtr handle, bool followEdgesReversed, dijkstra_seed[] seeds, dijkstra_seed[] terminalLinks, int numDestinations) {
+         var destinationCosts = new float[numDestinations];
+         var pathOffsets = new int[numDestinations + 1];
+         var pathLinks = new dijkstra_seed[numDestinations * 16];
+         int numPathLinks;
+         fixed (dijkstra_seed* pSeeds = seeds)
+         fixed (dijkstra_seed* pTerminalLinks = terminalLinks)
+         fixed (float* pDestinationCosts = destinationCosts)
+         fixed (int* pPathOffsets = pathOffsets) {
+            while (true) {
+               ApiResult res;
+               fixed (dijkstra_seed* pPathLinks = pathLinks) {
+                  res = QueryOverlayUniformCostSearch(handle, followEdgesReversed, pSeeds, seeds.Length, pTerminalLinks, terminalLinks.Length, numDestinations, pDestinationCosts, pPathOffsets, pPathLinks, pathLinks.Length, out numPathLinks);
+               }
+
+               if (res == ApiResult.Success) break;
+               if (res != ApiResult.ErrorInsufficientBuffer) throw new InvalidOperationException(res.ToString());
+               pathLinks = new dijkstra_seed[numPathLinks];
+            }
+         }
+
+         Array.Resize(ref pathLinks, numPathLinks);
+         return (destinationCosts, pathOffsets, pathLinks);
+      }
+
+      // Paths for (source, destination) queries, sharing one reversed search per distinct destination.
+      // Links are { crossover, -1 - index, cost }; query q's path runs from int.MinValue (the source point)
+      // to -1 - destination and is pathLinks [pathOffsets[q], pathOffsets[q + 1]).
+      public static (float[] costs, int[] pathOffsets, dijkstra_seed[] pathLinks) QueryOverlayPathBatch(IntPtr handle, dijkstra_seed[] sourceLinks, int numSources, dijkstra_seed[] destinationLinks, int numDestinations, (int source, int destination)[] queries) {
+         var queryPairs = new pair2i32[queries.Length];
+         for (var i = 0; i < queries.Length; i++) {
+            queryPairs[i] = new pair2i32 { a = queries[i].source, b = queries[i].destination };
+         }
+
+         var costs = new float[queries.Length];
+         var pathOffsets = new int[queries.Length + 1];
+         var pathLinks = new dijkstra_seed[queries.Length * 16];
+         int numPathLinks;
+         fixed (dijkstra_seed* pSourceLinks = sourceLinks)
+         fixed (dijkstra_seed* pDestinationLinks = destinationLinks)
+         fixed (pair2i32* pQueries = queryPairs)
+         fixed (float* pCosts = costs)
+         fixed (int* pPathOffsets = pathOffsets) {
+            while (true) {
+               ApiResult res;
+               fixed (dijkstra_seed* pPathLinks = pathLinks) {
+                  res = QueryOverlayPathBatch(handle, pSourceLinks, sourceLinks.Length, numSources, pDestinationLinks, destinationLinks.Length, numDestinations, pQueries, queries.Length, pCosts, pPathOffsets, pPathLinks, pathLinks.Length, out numPathLinks);
+               }
+
+               if (res == ApiResult.Success) break;
+               if (res != ApiResult.ErrorInsufficientBuffer) throw new InvalidOperationException(res.ToString());
+               pathLinks = new dijkstra_seed[numPathLinks];
+            }
+         }
+
+         Array.Resize(ref pathLinks, numPathLinks);
+         return (costs, pathOffsets, pathLinks);
+      }
+
+      // Native copy of a compiled sector's PortalPointLinkStates, for the visible link queries below.
+      public static IntPtr LoadPortalLinkMatrix(PortalLinkStates linkStates) {
+         var numPortals = linkStates.NumPortals;
+         var portalPointOffsets = new int[numPortals + 1];
+         for (var i = 0; i < numPortals; i++) {
+            portalPointOffsets[i + 1] = portalPointOffsets[i] + linkStates.PortalPointCounts[i];
+         }
+
+         IntPtr handle;
+         fixed (int* pPortalPointOffsets = portalPointOffsets)
+         fixed (ulong* pVisibleBits = linkStates.VisibleBits) {
+            var res = LoadPortalLinkMatrix(pPortalPointOffsets, numPortals, pVisibleBits, out handle);
+            if (res != ApiResult.Success) throw new InvalidOperationException(res.ToString());
+         }
+         return handle;
+      }
+
+      public static int[] QueryPortalLinkVisibleCounts(IntPtr handle, (int a, int b)[] portalPairs) {
+         var pairs = new pair2i32[portalPairs.Length];
+         for (var i = 0; i < portalPairs.Length; i++) {
+            pairs[i] = new pair2i32 { a = portalPairs[i].a, b = portalPairs[i].b };
+         }
+
+         var counts = new int[portalPairs.Length];
+         fixed (pair2i32* pPairs = pairs)
+         fixed (int* pCounts = counts) {
+            var res = QueryPortalLinkVisibleCounts(handle, pPairs, pairs.Length, pCounts);
+            if (res != ApiResult.Success) throw new InvalidOperationException(res.ToString());
+         }
+         return counts;
+      }
+
+      // Visible links between portals a and b as { a = point index in a, b = point index in b }.
+      public static pair2i32[] QueryPortalLinksVisible(IntPtr handle, int a, int b) {
+         var links = new pair2i32[64];
+         int numLinks;
+         while (true) {
+            ApiResult res;
+            fixed (pair2i32* pLinks = links) {
+               res = QueryPortalLinksVisible(handle, a, b, pLinks, links.Length, out numLinks);
+            }
+
+            if (res == ApiResult.Success) break;
+            if (res != ApiResult.ErrorInsufficientBuffer) throw new InvalidOperationException(res.ToString());
+            links = new pair2i32[numLinks];
+         }
+
+         Array.Resize(ref links, numLinks);
+         return links;
+      }
+
+      // Native EntityGrid over a sector's local bounds: width x height cells of cellSize, origin at their top left.
+      public static IntPtr LoadSpatialHash(int originX, int originY, int width, int height, int cellSize) {
+         var res = LoadSpatialHash(originX, originY, width, height, cellSize, out var handle);
+         if (res != ApiResult.Success) throw new InvalidOperationException(res.ToString());
+         return handle;
+      }
+
+      // Re-buckets the hash's entities; call once per tick before querying.
+      public static void UpdateSpatialHash(IntPtr handle, IntVector2[] positions, int[] radii) {
+         fixed (IntVector2* pPositions = positions)
+         fixed (int* pRadii = radii) {
+            var res = UpdateSpatialHash(handle, pPositions, pRadii, positions.Length);
+            if (res != ApiResult.Success) throw new InvalidOperationException(res.ToString());
+         }
+      }
+
+      // EntityGridView neighborhoods of every entity at once: entity i's neighbors are
+      // neighbors [offsets[i], offsets[i + 1]), as indices into the last update's arrays.
+      public static (int[] offsets, int[] neighbors) QuerySpatialHashNeighbors(IntPtr handle, NeighborhoodShape shape, int[] queryRadii) {
+         var offsets = new int[queryRadii.Length + 1];
+         var neighbors = new int[queryRadii.Length * 8];
+         int numNeighbors;
+         fixed (int* pQueryRadii = queryRadii)
+         fixed (int* pOffsets = offsets) {
+            while (true) {
+               ApiResult res;
+               fixed (int* pNeighbors = neighbors) {
+                  res = QuerySpatialHashNeighbors(handle, (int)shape, pQueryRadii, queryRadii.Length, pOffsets, pNeighbors, neighbors.Length, out numNeighbors);
+               }
+
+               if (res == ApiResult.Success) break;
+               if (res != ApiResult.ErrorInsufficientBuffer) throw new InvalidOperationException(res.ToString());
+               neighbors = new int[numNeighbors];
+            }
+         }
+
+         Array.Resize(ref neighbors, numNeighbors);
+         return (offsets, neighbors);
+      }
+
+      // QuadTree<T> for rects that move every frame, keyed by small non-negative ids: loose grids
+      // whose cells double from minCellSize until one covers bounds. Rects outside bounds still work.
+      public static IntPtr LoadLooseGrid(IntRect2 bounds, int minCellSize) {
+         var res = LoadLooseGrid(bounds.Left, bounds.Top, bounds.Right - bounds.Left + 1, bounds.Bottom - bounds.Top + 1, minCellSize, out var handle);
+         if (res != ApiResult.Success) throw new InvalidOperationException(res.ToString());
+         return handle;
+      }
+
+      // Inserts or moves ids[i] to rects[i] for the first count entries; cheap enough to call every tick.
+      public static void UpdateLooseGrid(IntPtr handle, int[] ids, IntRect2[] rects, int count) {
+         fixed (int* pIds = ids)
+         fixed (IntRect2* pRects = rects) {
+            var res = UpdateLooseGrid(handle, pIds, pRects, count);
+            if (res != ApiResult.Success) throw new InvalidOperationException(res.ToString());
+         }
+      }
+
+      public static void RemoveLooseGridItems(IntPtr handle, int[] ids, int count) {
+         fixed (int* pIds = ids) {
+            var res = RemoveLooseGridItems(handle, pIds, count);
+            if (res != ApiResult.Success) throw new InvalidOperationException(res.ToString());
+         }
+      }
+
+      // QuadTree.Query for the first count queries at once, into the caller's buffers so they can be
+      // reused across ticks: query i's ids are ids [offsets[i], offsets[i + 1]). offsets needs
+      // count + 1 entries; ids is only replaced when too small. Returns the number of ids.
+      public static int QueryLooseGrid(IntPtr handle, IntRect2[] queries, int count, int[] offsets, ref int[] ids) {
+         int numIds;
+         fixed (IntRect2* pQueries = queries)
+         fixed (int* pOffsets = offsets) {
+            while (true) {
+               ApiResult res;
+               fixed (int* pIds = ids) {
+                  res = QueryLooseGrid(handle, pQueries, count, pOffsets, pIds, ids.Length, out numIds);
+               }
+
+               if (res == ApiResult.Success) break;
+               if (res != ApiResult.ErrorInsufficientBuffer) throw new InvalidOperationException(res.ToString());
+               ids = new int[numIds];
+            }
+         }
+         return numIds;
+      }
+
+      // FlockingSimulator's force passes fused over one sector's entities (SoA, local space) and their
+      // neighbor CSR from QuerySpatialHashNeighbors. Returns each entity's unit force direction.
+      public static (float[] forceXs, float[] forceYs) ComputeFlockingForces(int[] xs, int[] ys, float[] radii, float[] seekXs, float[] seekYs, float[] directSeekXs, float[] directSeekYs, bool[] onGoalTriangle, float[] seekAlignWeights, int[] neighborOffsets, int[] neighbors) {
+         var numEntities = xs.Length;
+         var onGoalTriangleFlags = new byte[numEntities];
+         for (var i = 0; i < numEntities; i++) {
+            onGoalTriangleFlags[i] = onGoalTriangle[i] ? (byte)1 : (byte)0;
+         }
+
+         var forceXs = new float[numEntities];
+         var forceYs = new float[numEntities];
+         fixed (int* pXs = xs)
+         fixed (int* pYs = ys)
+         fixed (float* pRadii = radii)
+         fixed (float* pSeekXs = seekXs)
+         fixed (float* pSeekYs = seekYs)
+         fixed (float* pDirectSeekXs = directSeekXs)
+         fixed (float* pDirectSeekYs = directSeekYs)
+         fixed (byte* pOnGoalTriangle = onGoalTriangleFlags)
+         fixed (float* pSeekAlignWeights = seekAlignWeights)
+         fixed (int* pNeighborOffsets = neighborOffsets)
+         fixed (int* pNeighbors = neighbors)
+         fixed (float* pForceXs = forceXs)
+         fixed (float* pForceYs = forceYs) {
+            var res = ComputeFlockingForces(numEntities, pXs, pYs, pRadii, pSeekXs, pSeekYs, pDirectSeekXs, pDirectSeekYs, pOnGoalTriangle, pSeekAlignWeights, pNeighborOffsets, pNeighbors, pForceXs, pForceYs);
+            if (res != ApiResult.Success) throw new InvalidOperationException(res.ToString());
+         }
+         return (forceXs, forceYs);
+      }
+
+      // Copies a triangulation island for walking; triangle i keeps its island index.
+      public static IntPtr LoadTriangleMesh(TriangulationIsland island) {
+         var triangles = island.Triangles;
+         var vertexIndices = new Dictionary<DoubleVector2, int>();
+         var vertices = new List<point2f64>();
+         var triangleVertices = new int[triangles.Length * 3];
+         var triangleNeighbors = new int[triangles.Length * 3];
+         var neighborSharedEdges = new int[triangles.Length * 3];
+         for (var i = 0; i < triangles.Length; i++) {
+            for (var j = 0; j < 3; j++) {
+               var p = triangles[i].Points[j];
+               if (!vertexIndices.TryGetValue(p, out var vertexIndex)) {
+                  vertexIndex = vertices.Count;
+                  vertexIndices.Add(p, vertexIndex);
+                  vertices.Add(new point2f64((double)p.X, (double)p.Y));
+               }
+               triangleVertices[i * 3 + j] = vertexIndex;
+               triangleNeighbors[i * 3 + j] = triangles[i].NeighborOppositePointIndices[j];
+               neighborSharedEdges[i * 3 + j] = triangles[i].NeighborVertexIndexSharingEdgeOppositePointIndices[j];
+            }
+         }
+
+         var verticesArray = vertices.ToArray();
+         fixed (point2f64* pVertices = verticesArray)
+         fixed (int* pTriangleVertices = triangleVertices)
+         fixed (int* pTriangleNeighbors = triangleNeighbors)
+         fixed (int* pNeighborSharedEdges = neighborSharedEdges) {
+            var res = LoadTriangleMesh(pVertices, verticesArray.Length, pTriangleVertices, pTriangleNeighbors, pNeighborSharedEdges, triangles.Length, out var handle);
+            if (res != ApiResult.Success) throw new InvalidOperationException(res.ToString());
+            return handle;
+         }
+      }
+
+      // TriangulationWalker2D.WalkTriangulation for many walkers at once: walker i starts at
+      // positions[i] in triangles[i] and walks displacements[i]. Halt segment s stops walkers
+      // crossing it from its haltClockness[s] side.
+      public static walk_result[] WalkTriangleMesh(IntPtr handle, DoubleLineSegment2[] haltSegments, Clockness[] haltClockness, int[] triangles, DoubleVector2[] positions, DoubleVector2[] displacements) {
+         var numWalks = triangles.Length;
+         var haltSegmentsNative = haltSegments.Select(s => new seg2f64(s)).ToArray();
+         var haltClocknessNative = haltClockness.Select(c => (int)c).ToArray();
+         var positionsNative = positions.Select(p => new point2f64((double)p.X, (double)p.Y)).ToArray();
+         var displacementsNative = displacements.Select(d => new point2f64((double)d.X, (double)d.Y)).ToArray();
+         var results = new walk_result[numWalks];
+         fixed (seg2f64* pHaltSegments = haltSegmentsNative)
+         fixed (int* pHaltClockness = haltClocknessNative)
+         fixed (int* pTriangles = triangles)
+         fixed (point2f64* pPositions = positionsNative)
+         fixed (point2f64* pDisplacements = displacementsNative)
+         fixed (walk_result* pResults = results) {
+            var res = WalkTriangleMesh(handle, pHaltSegments, pHaltClockness, haltSegments.Length, pTriangles, pPositions, pDisplacements, numWalks, pResults);
+            if (res != ApiResult.Success) throw new InvalidOperationException(res.ToString());
+         }
+         return results;
+      }
+
+      // TriangulationIsland.TryIntersect for many points at once: each point's triangle index in the
+      // loaded island, or -1 where TryIntersect would fail.
+      public static int[] LocateTriangleMeshPoints(IntPtr handle, DoubleVector2[] points) {
+         var pointsNative = points.Select(p => new point2f64((double)p.X, (double)p.Y)).ToArray();
+         var triangles = new int[points.Length];
+         fixed (point2f64* pPoints = pointsNative)
+         fixed (int* pTriangles = triangles) {
+            var res = LocateTriangleMeshPoints(handle, pPoints, points.Length, pTriangles);
+            if (res != ApiResult.Success) throw new InvalidOperationException(res.ToString());
+         }
+         return triangles;
+      }
+
+      // BvhILS2 over segments, built natively for batched QuerySegmentBvhAnyIntersections.
+      public static IntPtr LoadSegmentBvh(IntLineSegment2[] segments) {
+         var segmentsNative = segments.Select(s => new seg2i16(s)).ToArray();
+         fixed (seg2i16* pSegments = segmentsNative) {
+            var res = LoadSegmentBvh(pSegments, segments.Length, out var handle);
+            if (res != ApiResult.Success) throw new InvalidOperationException(res.ToString());
+            return handle;
+         }
+      }
+
+      // BvhILS2.Intersects for many queries at once.
+      public static bool[] QuerySegmentBvhAnyIntersections(IntPtr handle, IntLineSegment2[] queries) {
+         var queriesNative = queries.Select(q => new seg2i16(q)).ToArray();
+         var results = new byte[queries.Length];
+         fixed (seg2i16* pQueries = queriesNative)
+         fixed (byte* pResults = results) {
+            var res = QuerySegmentBvhAnyIntersections(handle, pQueries, queries.Length, pResults);
+            if (res != ApiResult.Success) throw new InvalidOperationException(res.ToString());
+         }
+         return results.Select(r => r != 0).ToArray();
+      }
+
+      // Constrained Delaunay triangulation of a flattened polygon tree (see Triangulator.TriangulateRootNative).
+      // Contour i's island is triangles [contourTriangleOffsets[i], contourTriangleOffsets[i + 1]), empty
+      // for holes; corners index points and neighbors are island-local, as LoadTriangleMesh takes them.
+      public static (int[] contourTriangleOffsets, int[] triangleVertices, int[] triangleNeighbors, int[] neighborSharedEdges) TriangulatePolygonTree(IntVector2[] points, int[] contourOffsets, int[] contourParents) {
+         var numContours = contourParents.Length;
+         var contourTriangleOffsets = new int[numContours + 1];
+         var triangleCapacity = points.Length + 2 * numContours;
+         var triangleVertices = new int[3 * triangleCapacity];
+         var triangleNeighbors = new int[3 * triangleCapacity];
+         var neighborSharedEdges = new int[3 * triangleCapacity];
+         int numTriangles;
+         fixed (IntVector2* pPoints = points)
+         fixed (int* pContourOffsets = contourOffsets)
+         fixed (int* pContourParents = contourParents)
+         fixed (int* pContourTriangleOffsets = contourTriangleOffsets) {
+            while (true) {
+               ApiResult res;
+               fixed (int* pTriangleVertices = triangleVertices)
+               fixed (int* pTriangleNeighbors = triangleNeighbors)
+               fixed (int* pNeighborSharedEdges = neighborSharedEdges) {
+                  res = TriangulatePolygonTree(pPoints, pContourOffsets, pContourParents, numContours, pContourTriangleOffsets, pTriangleVertices, pTriangleNeighbors, pNeighborSharedEdges, triangleVertices.Length / 3, out numTriangles);
+               }
+
+               if (res == ApiResult.Success) break;
+               if (res != ApiResult.ErrorInsufficientBuffer) throw new InvalidOperationException(res.ToString());
+               triangleVertices = new int[3 * numTriangles];
+               triangleNeighbors = new int[3 * numTriangles];
+               neighborSharedEdges = new int[3 * numTriangles];
+            }
+         }
+
+         Array.Resize(ref triangleVertices, 3 * numTriangles);
+         Array.Resize(ref triangleNeighbors, 3 * numTriangles);
+         Array.Resize(ref neighborSharedEdges, 3 * numTriangles);
+         return (contourTriangleOffsets, triangleVertices, triangleNeighbors, neighborSharedEdges);
+      }
+
+      // SectorCompiler.Compile's barriers, portal point link states and triangulation in one native
+      // call over the flattened punched land; the triangulation overlaps the link state queries.
+      // Results match BarrierCalculator (in preorder contour order), ComputePortalPointLinkStates and
+      // TriangulatePolygonTree.
+      public static (IntLineSegment2[] barriers, PortalLinkStates portalPointLinkStates, int[] contourTriangleOffsets, int[] triangleVertices, int[] triangleNeighbors, int[] neighborSharedEdges) CompileSector(IntVector2[] points, int[] contourOffsets, int[] contourParents, IntVector2[][] portalPoints, int exaggerationFactor = 10) {
+         var numContours = contourParents.Length;
+         var numPortals = portalPoints.Length;
+         var portalPointOffsets = new int[numPortals + 1];
+         for (var i = 0; i < numPortals; i++) {
+            portalPointOffsets[i + 1] = portalPointOffsets[i] + portalPoints[i].Length;
+         }
+
+         var flattenedPortalPoints = new IntVector2[portalPointOffsets[numPortals]];
+         for (var i = 0; i < numPortals; i++) {
+            portalPoints[i].CopyTo(flattenedPortalPoints, portalPointOffsets[i]);
+         }
+
+         var numLinkWords = PortalLinkStates.ComputePairWordOffsets(PortalLinkStates.GetPortalPointCounts(portalPoints))[^1];
+
+         // Barriers are at most one per point, triangles at most points + 2 * contours; the blob's
+         // section padding fits in the slack.
+         var blob = new byte[256 + sizeof(sector_compilation_header) + 16 * points.Length + 8 * numLinkWords + 4 * (numContours + 1) + 36 * (points.Length + 2 * numContours)];
+         fixed (IntVector2* pPoints = points)
+         fixed (int* pContourOffsets = contourOffsets)
+         fixed (int* pContourParents = contourParents)
+         fixed (IntVector2* pPortalPoints = flattenedPortalPoints)
+         fixed (int* pPortalPointOffsets = portalPointOffsets) {
+            while (true) {
+               ApiResult res;
+               int blobSize;
+               fixed (byte* pBlob = blob) {
+                  res = CompileSector(pPoints, pContourOffsets, pContourParents, numContours, pPortalPoints, pPortalPointOffsets, numPortals, exaggerationFactor, pBlob, blob.Length, out blobSize);
+               }
+
+               if (res == ApiResult.Success) break;
+               if (res != ApiResult.ErrorInsufficientBuffer) throw new InvalidOperationException(res.ToString());
+               blob = new byte[blobSize];
+            }
+         }
+
+         fixed (byte* pBlob = blob) {
+            return UnpackSectorCompilation(pBlob, portalPoints);
+         }
+      }
+
+      private static (IntLineSegment2[] barriers, PortalLinkStates portalPointLinkStates, int[] contourTriangleOffsets, int[] triangleVertices, int[] triangleNeighbors, int[] neighborSharedEdges) UnpackSectorCompilation(byte* pBlob, IntVector2[][] portalPoints) {
+         var header = *(sector_compilation_header*)pBlob;
+         var barriers = new Span<IntLineSegment2>(pBlob + header.barriersOffset, header.numBarriers).ToArray();
+         var contourTriangleOffsets = new Span<int>(pBlob + header.contourTriangleOffsetsOffset, header.numContours + 1).ToArray();
+         var triangleVertices = new Span<int>(pBlob + header.triangleVerticesOffset, 3 * header.numTriangles).ToArray();
+         var triangleNeighbors = new Span<int>(pBlob + header.triangleNeighborsOffset, 3 * header.numTriangles).ToArray();
+         var neighborSharedEdges = new Span<int>(pBlob + header.neighborSharedEdgesOffset, 3 * header.numTriangles).ToArray();
+
+         var linkVisibleBits = new Span<ulong>(pBlob + header.linkVisibleBitsOffset, header.numLinkWords).ToArray();
+         var portalPointLinkStates = new PortalLinkStates(PortalLinkStates.GetPortalPointCounts(portalPoints), linkVisibleBits);
+
+         return (barriers, portalPointLinkStates, contourTriangleOffsets, triangleVertices, triangleNeighbors, neighborSharedEdges);
+      }
+
+      // Per-sector portal-to-portal path cost bounds: entry a * numPortals + b bounds the cost between
+      // portal a's and portal b's crossover points. waypointCosts is the flattened waypoint-to-waypoint LUT.
+      public static distance_bounds[] ComputeSectorPortalDistanceBounds(IntVector2[][] portalPoints, PortalLinkStates portalPointLinkStates, IntVector2[] waypoints, float[] waypointCosts, IntLineSegment2[] barriers) {
+         var numPortals = portalPoints.Length;
+         var portalPointOffsets = new int[numPortals + 1];
+         for (var i = 0; i < numPortals; i++) {
+            portalPointOffsets[i + 1] = portalPointOffsets[i] + portalPoints[i].Length;
+         }
+
+         var points = new IntVector2[portalPointOffsets[numPortals]];
+         for (var i = 0; i < numPortals; i++) {
+            portalPoints[i].CopyTo(points, portalPointOffsets[i]);
+         }
+
+         var bounds = new distance_bounds[numPortals * numPortals];
+         fixed (IntVector2* pPoints = points)
+         fixed (int* pPortalPointOffsets = portalPointOffsets)
+         fixed (ulong* pLinkVisibleBits = portalPointLinkStates.VisibleBits)
+         fixed (IntVector2* pWaypoints = waypoints)
+         fixed (float* pWaypointCosts = waypointCosts)
+         fixed (IntLineSegment2* pBarriers = barriers)
+         fixed (distance_bounds* pBounds = bounds) {
+            var res = ComputeSectorPortalDistanceBounds(pPoints, pPortalPointOffsets, numPortals, pLinkVisibleBits, pWaypoints, waypoints.Length, pWaypointCosts, pBarriers, barriers.Length, pBounds);
+            if (res != ApiResult.Success) throw new InvalidOperationException(res.ToString());
+         }
+         return bounds;
+      }
+
+      // Sectors and portals an optimal path from the source links to the destination links can cross,
+      // given each sector's bounds matrix packed back to back; upperBound is the best guaranteed cost.
+      public static (bool[] portalInCorridor, bool[] sectorInCorridor, float upperBound) FindSectorCorridor(int numPortals, int[] sectorPortalOffsets, int[] sectorPortals, distance_bounds[] sectorBounds, int[] sourcePortals, distance_bounds[] sourceLinks, int[] destinationPortals, distance_bounds[] destinationLinks) {
+         var numSectors = sectorPortalOffsets.Length - 1;
+         var portalFlags = new byte[numPortals];
+         var sectorFlags = new byte[numSectors];
+         float upperBound;
+         fixed (int* pSectorPortalOffsets = sectorPortalOffsets)
+         fixed (int* pSectorPortals = sectorPortals)
+         fixed (distance_bounds* pSectorBounds = sectorBounds)
+         fixed (int* pSourcePortals = sourcePortals)
+         fixed (distance_bounds* pSourceLinks = sourceLinks)
+         fixed (int* pDestinationPortals = destinationPortals)
+         fixed (distance_bounds* pDestinationLinks = destinationLinks)
+         fixed (byte* pPortalFlags = portalFlags)
+         fixed (byte* pSectorFlags = sectorFlags) {
+            var res = FindSectorCorridor(numPortals, pSectorPortalOffsets, pSectorPortals, numSectors, pSectorBounds, pSourcePortals, pSourceLinks, sourceLinks.Length, pDestinationPortals, pDestinationLinks, destinationLinks.Length, pPortalFlags, pSectorFlags, out upperBound);
+            if (res != ApiResult.Success) throw new InvalidOperationException(res.ToString());
+         }
+         return (portalFlags.Select(f => f != 0).ToArray(), sectorFlags.Select(f => f != 0).ToArray(), upperBound);
       }
 
       [DllImport("nativeutils", EntryPoint = "NativeApi_" + nameof(GetVersion))]
@@ -27,16 +705,149 @@ namespace Dargon.Terragami {
       [DllImport("nativeutils", EntryPoint = "NativeApi_" + nameof(LoadPrequeryAnySegmentIntersections))]
       public static extern ApiResult LoadPrequeryAnySegmentIntersections(seg2i16* barriers, int numBarriers, out IntPtr handle);
 
+      [DllImport("nativeutils", EntryPoint = "NativeApi_" + nameof(LoadPrequeryAnySegmentIntersectionsI32))]
+      public static extern ApiResult LoadPrequeryAnySegmentIntersectionsI32(IntLineSegment2* barriers, int numBarriers, out IntPtr handle);
+
+      [DllImport("nativeutils", EntryPoint = "NativeApi_" + nameof(LoadPrequeryContourBarrierIntersections))]
+      public static extern ApiResult LoadPrequeryContourBarrierIntersections(IntVector2* points, int* contourOffsets, int numContours, int exaggerationFactor, out IntPtr handle);
+
       [DllImport("nativeutils", EntryPoint = "NativeApi_" + nameof(QueryAnySegmentIntersections))]
       public static extern ApiResult QueryAnySegmentIntersections(IntPtr prequeryStateHandle, seg2i16* queries, int numQueries, byte* results);
 
       [DllImport("nativeutils", EntryPoint = "NativeApi_" + nameof(FreePrequeryAnySegmentIntersections))]
       public static extern ApiResult FreePrequeryAnySegmentIntersections(IntPtr prequeryStateHandle);
+
+      [DllImport("nativeutils", EntryPoint = "NativeApi_" + nameof(FindAllSegmentIntersections))]
+      public static extern ApiResult FindAllSegmentIntersections(IntLineSegment2* segments, int numSegments, [MarshalAs(UnmanagedType.U1)] bool detectEndpointContainment, pair2i32* pairs, int pairCapacity, out int numPairs);
+
+      [DllImport("nativeutils", EntryPoint = "NativeApi_" + nameof(ComputeAllPairsShortestPaths))]
+      public static extern ApiResult ComputeAllPairsShortestPaths(int* offsets, int* edgeTargets, float* edgeCosts, int numNodes, float* costs, int* predecessors);
+
+      [DllImport("nativeutils", EntryPoint = "NativeApi_" + nameof(Dijkstras))]
+      public static extern ApiResult Dijkstras(int* offsets, int* edgeTargets, float* edgeCosts, int numNodes, dijkstra_seed* seeds, int numSeeds, int* terminals, int numTerminals, float* costs, int* predecessors);
+
+      [DllImport("nativeutils", EntryPoint = "NativeApi_" + nameof(DijkstrasBatch))]
+      public static extern ApiResult DijkstrasBatch(int* offsets, int* edgeTargets, float* edgeCosts, int numNodes, int* sources, int numSources, float* costs, int* predecessors);
+
+      [DllImport("nativeutils", EntryPoint = "NativeApi_" + nameof(BuildVisibilityGraph))]
+      public static extern ApiResult BuildVisibilityGraph(IntVector2* waypoints, int numWaypoints, IntLineSegment2* barriers, int numBarriers, int* offsets, int* edgeTargets, float* edgeCosts, int edgeCapacity, out int numEdges);
+
+      [DllImport("nativeutils", EntryPoint = "NativeApi_" + nameof(BuildVisibilityPolygons))]
+      public static extern ApiResult BuildVisibilityPolygons(IntVector2* origins, int numOrigins, IntLineSegment2* barriers, int numBarriers, int* offsets, int* rangeIds, double* rangeThetaStarts, int rangeCapacity, out int numRanges);
+
+      [DllImport("nativeutils", EntryPoint = "NativeApi_" + nameof(LoadVisibilityPolygons))]
+      public static extern ApiResult LoadVisibilityPolygons(IntVector2* origins, int numOrigins, IntLineSegment2* barriers, int numBarriers, out IntPtr handle);
+
+      [DllImport("nativeutils", EntryPoint = "NativeApi_" + nameof(QueryVisibilityPolygonsContainingPoints))]
+      public static extern ApiResult QueryVisibilityPolygonsContainingPoints(IntPtr visibilityPolygonsHandle, point2f64* points, int numPoints, int* resultOffsets, int* originIndices, float* distances, int resultCapacity, out int numResults);
+
+      [DllImport("nativeutils", EntryPoint = "NativeApi_" + nameof(QueryVisibilityPolygonsSeeingSegments))]
+      public static extern ApiResult QueryVisibilityPolygonsSeeingSegments(IntPtr visibilityPolygonsHandle, seg2f64* segments, int numSegments, uint* seeingOriginBits);
+
+      [DllImport("nativeutils", EntryPoint = "NativeApi_" + nameof(FreeVisibilityPolygons))]
+      public static extern ApiResult FreeVisibilityPolygons(IntPtr visibilityPolygonsHandle);
+
+      [DllImport("nativeutils", EntryPoint = "NativeApi_" + nameof(LoadOverlayGraph))]
+      public static extern ApiResult LoadOverlayGraph(int* offsets, int* edgeTargets, float* edgeCosts, int numVertices, out IntPtr handle);
+
+      [DllImport("nativeutils", EntryPoint = "NativeApi_" + nameof(QueryOverlayUniformCostSearch))]
+      public static extern ApiResult QueryOverlayUniformCostSearch(IntPtr overlayGraphHandle, [MarshalAs(UnmanagedType.U1)] bool followEdgesReversed, dijkstra_seed* seeds, int numSeeds, dijkstra_seed* terminalLinks, int numTerminalLinks, int numDestinations, float* destinationCosts, int* pathOffsets, dijkstra_seed* pathLinks, int pathCapacity, out int numPathLinks);
+
+      [DllImport("nativeutils", EntryPoint = "NativeApi_" + nameof(QueryOverlayPathBatch))]
+      public static extern ApiResult QueryOverlayPathBatch(IntPtr overlayGraphHandle, dijkstra_seed* sourceLinks, int numSourceLinks, int numSources, dijkstra_seed* destinationLinks, int numDestinationLinks, int numDestinations, pair2i32* queries, int numQueries, float* costs, int* pathOffsets, dijkstra_seed* pathLinks, int pathCapacity, out int numPathLinks);
+
+      [DllImport("nativeutils", EntryPoint = "NativeApi_" + nameof(FreeOverlayGraph))]
+      public static extern ApiResult FreeOverlayGraph(IntPtr overlayGraphHandle);
+
+      [DllImport("nativeutils", EntryPoint = "NativeApi_" + nameof(LoadPortalLinkMatrix))]
+      public static extern ApiResult LoadPortalLinkMatrix(int* portalPointOffsets, int numPortals, ulong* linkVisibleBits, out IntPtr handle);
+
+      [DllImport("nativeutils", EntryPoint = "NativeApi_" + nameof(QueryPortalLinkVisibleCounts))]
+      public static extern ApiResult QueryPortalLinkVisibleCounts(IntPtr portalLinkMatrixHandle, pair2i32* portalPairs, int numPortalPairs, int* counts);
+
+      [DllImport("nativeutils", EntryPoint = "NativeApi_" + nameof(QueryPortalLinksVisible))]
+      public static extern ApiResult QueryPortalLinksVisible(IntPtr portalLinkMatrixHandle, int a, int b, pair2i32* links, int linkCapacity, out int numLinks);
+
+      [DllImport("nativeutils", EntryPoint = "NativeApi_" + nameof(FreePortalLinkMatrix))]
+      public static extern ApiResult FreePortalLinkMatrix(IntPtr portalLinkMatrixHandle);
+
+      [DllImport("nativeutils", EntryPoint = "NativeApi_" + nameof(LoadSpatialHash))]
+      public static extern ApiResult LoadSpatialHash(int originX, int originY, int width, int height, int cellSize, out IntPtr handle);
+
+      [DllImport("nativeutils", EntryPoint = "NativeApi_" + nameof(UpdateSpatialHash))]
+      public static extern ApiResult UpdateSpatialHash(IntPtr spatialHashHandle, IntVector2* positions, int* radii, int numEntities);
+
+      [DllImport("nativeutils", EntryPoint = "NativeApi_" + nameof(QuerySpatialHashNeighbors))]
+      public static extern ApiResult QuerySpatialHashNeighbors(IntPtr spatialHashHandle, int shape, int* queryRadii, int numEntities, int* neighborOffsets, int* neighbors, int neighborCapacity, out int numNeighbors);
+
+      [DllImport("nativeutils", EntryPoint = "NativeApi_" + nameof(FreeSpatialHash))]
+      public static extern ApiResult FreeSpatialHash(IntPtr spatialHashHandle);
+
+      [DllImport("nativeutils", EntryPoint = "NativeApi_" + nameof(LoadLooseGrid))]
+      public static extern ApiResult LoadLooseGrid(int originX, int originY, int width, int height, int minCellSize, out IntPtr handle);
+
+      [DllImport("nativeutils", EntryPoint = "NativeApi_" + nameof(UpdateLooseGrid))]
+      public static extern ApiResult UpdateLooseGrid(IntPtr looseGridHandle, int* ids, IntRect2* rects, int numItems);
+
+      [DllImport("nativeutils", EntryPoint = "NativeApi_" + nameof(RemoveLooseGridItems))]
+      public static extern ApiResult RemoveLooseGridItems(IntPtr looseGridHandle, int* ids, int numIds);
+
+      [DllImport("nativeutils", EntryPoint = "NativeApi_" + nameof(QueryLooseGrid))]
+      public static extern ApiResult QueryLooseGrid(IntPtr looseGridHandle, IntRect2* queries, int numQueries, int* offsets, int* ids, int idCapacity, out int numIds);
+
+      [DllImport("nativeutils", EntryPoint = "NativeApi_" + nameof(FreeLooseGrid))]
+      public static extern ApiResult FreeLooseGrid(IntPtr looseGridHandle);
+
+      [DllImport("nativeutils", EntryPoint = "NativeApi_" + nameof(ComputeFlockingForces))]
+      public static extern ApiResult ComputeFlockingForces(int numEntities, int* xs, int* ys, float* radii, float* seekXs, float* seekYs, float* directSeekXs, float* directSeekYs, byte* onGoalTriangle, float* seekAlignWeights, int* neighborOffsets, int* neighbors, float* forceXs, float* forceYs);
+
+      [DllImport("nativeutils", EntryPoint = "NativeApi_" + nameof(LoadTriangleMesh))]
+      public static extern ApiResult LoadTriangleMesh(point2f64* vertices, int numVertices, int* triangleVertices, int* triangleNeighbors, int* neighborSharedEdges, int numTriangles, out IntPtr handle);
+
+      [DllImport("nativeutils", EntryPoint = "NativeApi_" + nameof(WalkTriangleMesh))]
+      public static extern ApiResult WalkTriangleMesh(IntPtr triangleMeshHandle, seg2f64* haltSegments, int* haltClockness, int numHaltSegments, int* triangles, point2f64* positions, point2f64* displacements, int numWalks, walk_result* results);
+
+      [DllImport("nativeutils", EntryPoint = "NativeApi_" + nameof(LocateTriangleMeshPoints))]
+      public static extern ApiResult LocateTriangleMeshPoints(IntPtr triangleMeshHandle, point2f64* points, int numPoints, int* triangles);
+
+      [DllImport("nativeutils", EntryPoint = "NativeApi_" + nameof(FreeTriangleMesh))]
+      public static extern ApiResult FreeTriangleMesh(IntPtr triangleMeshHandle);
+
+      [DllImport("nativeutils", EntryPoint = "NativeApi_" + nameof(LoadSegmentBvh))]
+      public static extern ApiResult LoadSegmentBvh(seg2i16* segments, int numSegments, out IntPtr handle);
+
+      [DllImport("nativeutils", EntryPoint = "NativeApi_" + nameof(QuerySegmentBvhAnyIntersections))]
+      public static extern ApiResult QuerySegmentBvhAnyIntersections(IntPtr segmentBvhHandle, seg2i16* queries, int numQueries, byte* results);
+
+      [DllImport("nativeutils", EntryPoint = "NativeApi_" + nameof(FreeSegmentBvh))]
+      public static extern ApiResult FreeSegmentBvh(IntPtr segmentBvhHandle);
+
+      [DllImport("nativeutils", EntryPoint = "NativeApi_" + nameof(TriangulatePolygonTree))]
+      public static extern ApiResult TriangulatePolygonTree(IntVector2* points, int* contourOffsets, int* contourParents, int numContours, int* contourTriangleOffsets, int* triangleVertices, int* triangleNeighbors, int* neighborSharedEdges, int triangleCapacity, out int numTriangles);
+
+      [DllImport("nativeutils", EntryPoint = "NativeApi_" + nameof(CompileSector))]
+      public static extern ApiResult CompileSector(IntVector2* points, int* contourOffsets, int* contourParents, int numContours, IntVector2* portalPoints, int* portalPointOffsets, int numPortals, int exaggerationFactor, byte* blob, int blobCapacity, out int blobSize);
+
+      [DllImport("nativeutils", EntryPoint = "NativeApi_" + nameof(ComputeSectorPortalDistanceBounds))]
+      public static extern ApiResult ComputeSectorPortalDistanceBounds(IntVector2* portalPoints, int* portalPointOffsets, int numPortals, ulong* linkVisibleBits, IntVector2* waypoints, int numWaypoints, float* waypointCosts, IntLineSegment2* barriers, int numBarriers, distance_bounds* bounds);
+
+      [DllImport("nativeutils", EntryPoint = "NativeApi_" + nameof(FindSectorCorridor))]
+      public static extern ApiResult FindSectorCorridor(int numPortals, int* sectorPortalOffsets, int* sectorPortals, int numSectors, distance_bounds* sectorBounds, int* sourcePortals, distance_bounds* sourceLinks, int numSourceLinks, int* destinationPortals, distance_bounds* destinationLinks, int numDestinationLinks, byte* portalInCorridor, byte* sectorInCorridor, out float upperBound);
    }
 
    public enum ApiResult : int {
       Success = 0,
       ErrorUnknownHandle = -100,
+      ErrorInsufficientBuffer = -101,
+      ErrorInvalidArgument = -102,
+      ErrorUnknown = -999,
+   }
+
+   // Mirrors the EntityGridView neighborhoods.
+   public enum NeighborhoodShape : int {
+      Circle = 0,
+      QuarterCircleBR = 1,
+      QuarterCircleBRExcludeCenter = 2,
    }
 
    [StructLayout(LayoutKind.Sequential, Pack = 1, Size = 8)]
@@ -53,4 +864,77 @@ namespace Dargon.Terragami {
          y2 = (short)s.Y2;
       }
    }
+
+   [StructLayout(LayoutKind.Sequential, Pack = 1, Size = 8)]
+   public struct pair2i32 {
+      public int a;
+      public int b;
+   }
+
+   [StructLayout(LayoutKind.Sequential, Pack = 1, Size = 16)]
+   public struct point2f64 {
+      public double x;
+      public double y;
+
+      public point2f64(double x, double y) {
+         this.x = x;
+         this.y = y;
+      }
+   }
+
+   [StructLayout(LayoutKind.Sequential, Pack = 1, Size = 32)]
+   public struct seg2f64 {
+      public double x1;
+      public double y1;
+      public double x2;
+      public double y2;
+
+      public seg2f64(DoubleLineSegment2 s) {
+         x1 = (double)s.X1;
+         y1 = (double)s.Y1;
+         x2 = (double)s.X2;
+         y2 = (double)s.Y2;
+      }
+   }
+
+   [StructLayout(LayoutKind.Sequential, Pack = 1, Size = 8)]
+   public struct distance_bounds {
+      public float lower;
+      public float upper;
+   }
+
+   [StructLayout(LayoutKind.Sequential, Pack = 1, Size = 32)]
+   public struct walk_result {
+      public point2f64 position;
+      public int triangle;
+      public int haltSegment;
+      public double distanceConsumed;
+   }
+
+   [StructLayout(LayoutKind.Sequential, Pack = 1, Size = 40)]
+   public struct sector_compilation_header {
+      public int numBarriers;
+      public int barriersOffset;
+      public int numLinkWords;
+      public int linkVisibleBitsOffset;
+      public int numContours;
+      public int contourTriangleOffsetsOffset;
+      public int numTriangles;
+      public int triangleVerticesOffset;
+      public int triangleNeighborsOffset;
+      public int neighborSharedEdgesOffset;
+   }
+
+   [StructLayout(LayoutKind.Sequential, Pack = 1, Size = 12)]
+   public struct dijkstra_seed {
+      public int prior;
+      public int current;
+      public float totalCost;
+
+      public dijkstra_seed(int prior, int current, float totalCost) {
+         this.prior = prior;
+         this.current = current;
+         this.totalCost = totalCost;
+      }
+   }
 }
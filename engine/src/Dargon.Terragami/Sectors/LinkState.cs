@@ -1,5 +0,0 @@
-﻿namespace Dargon.Terragami.Sectors {
-   public struct LinkState {
-      public bool Occluded;
-   }
-}
@@ -0,0 +1,70 @@
+﻿using System.Numerics;
+using Dargon.PlayOn.Geometry;
+
+namespace Dargon.Terragami.Sectors {
+   // Visibility of every (pointA, pointB) link between each pair of portals, one bit per link,
+   // set if the link is visible. Pair (a, b), a < b, holds a's points by b's points row-major,
+   // starting at word PairWordOffsets[pair]; pairs are in (a, b) lexicographic order. This is
+   // native PortalLinkMatrix's layout, so the bits pass through CompileSector and
+   // LoadPortalLinkMatrix unchanged.
+   public class PortalLinkStates {
+      public readonly int[] PortalPointCounts;
+      public readonly int[] PairWordOffsets;
+      public readonly ulong[] VisibleBits;
+
+      public PortalLinkStates(int[] portalPointCounts, ulong[] visibleBits) {
+         PortalPointCounts = portalPointCounts;
+         PairWordOffsets = ComputePairWordOffsets(portalPointCounts);
+         VisibleBits = visibleBits;
+      }
+
+      public int NumPortals => PortalPointCounts.Length;
+
+      public static int[] ComputePairWordOffsets(int[] portalPointCounts) {
+         var numPortals = portalPointCounts.Length;
+         var offsets = new int[numPortals * (numPortals - 1) / 2 + 1];
+         var pair = 0;
+         for (var a = 0; a < numPortals; a++) {
+            for (var b = a + 1; b < numPortals; b++, pair++) {
+               offsets[pair + 1] = offsets[pair] + (portalPointCounts[a] * portalPointCounts[b] + 63) / 64;
+            }
+         }
+         return offsets;
+      }
+
+      public static int[] GetPortalPointCounts(IntVector2[][] portalPoints) {
+         var counts = new int[portalPoints.Length];
+         for (var i = 0; i < portalPoints.Length; i++) counts[i] = portalPoints[i].Length;
+         return counts;
+      }
+
+      private int PairIndex(int a, int b) => a * (2 * NumPortals - a - 1) / 2 + (b - a - 1);
+
+      // Whether portal a's i-th point sees portal b's j-th point (a != b, either order).
+      public bool IsVisible(int a, int i, int b, int j) {
+         if (a > b) (a, i, b, j) = (b, j, a, i);
+         var link = i * PortalPointCounts[b] + j;
+         var word = VisibleBits[PairWordOffsets[PairIndex(a, b)] + link / 64];
+         return ((word >> (link % 64)) & 1) != 0;
+      }
+
+      // Number of visible links between portals a and b (either order); a == b counts none.
+      public int CountVisible(int a, int b) {
+         if (a == b) return 0;
+         if (a > b) (a, b) = (b, a);
+
+         var pair = PairIndex(a, b);
+         var count = 0;
+         for (var w = PairWordOffsets[pair]; w < PairWordOffsets[pair + 1]; w++) {
+            count += BitOperations.PopCount(VisibleBits[w]);
+         }
+         return count;
+      }
+
+      public int CountVisible() {
+         var count = 0;
+         foreach (var word in VisibleBits) count += BitOperations.PopCount(word);
+         return count;
+      }
+   }
+}
@@ -1,7 +1,9 @@
 ﻿using System;
 using System.Collections.Generic;
+using System.Diagnostics;
 using System.Linq;
 using System.Numerics;
+using System.Threading.Tasks;
 using Dargon.Commons.Collections;
 using Dargon.Dviz;
 using Dargon.PlayOn;
@@ -11,92 +13,74 @@ using Dargon.Terragami.Dviz;
 namespace Dargon.Terragami.Sectors {
    public class SectorCompiler {
       public SectorCompilationOutput Compile(SectorCompilationInput input, IDebugCanvas debugCanvasOpt) {
-         var portals = input.Portals;
-         var portalPoints = ComputePortalPoints(portals);
-
-         var punchedLand = ComputePunchedLand(input, debugCanvasOpt);
-         var barriers = ComputeVisibilityBarriers(punchedLand);
-         var triangulation = ComputeTriangulation(punchedLand);
-
-         var portalPointLinkStates = ComputePortalPointLinkStates(debugCanvasOpt, portals, portalPoints, barriers);
-
-         return new SectorCompilationOutput { 
-            Input = input,
-            PortalPoints = portalPoints,
-            PunchedLand = punchedLand,
-            VisibilityBarriers = barriers,
-            PortalPointLinkStates = portalPointLinkStates,
-            Triangulation = triangulation,
-         };
+         var holeContours = input.Holes.Select(hole => ProjectHoleContours(hole, input.Land.Transform));
+         return Compile(input, holeContours, debugCanvasOpt, null);
       }
 
-      private Triangulation ComputeTriangulation(PolygonNode punchedLand) {
-         return new Triangulator().TriangulateRoot(punchedLand);
-      }
-
-      private static unsafe List<LinkState[]> ComputePortalPointLinkStates(IDebugCanvas debugCanvasOpt, ExposedArrayList<SectorPortal> portals, IntVector2[][] portalPoints, IntLineSegment2[] barriers) {
-         var allLinkStates = new List<LinkState[]>();
-         var pass = 0;
-
-         NativeUtils.LoadPrequeryAnySegmentIntersections(barriers, out var segsIntersectPrequeryState);
-         
-         for (var a = 0; a < portals.Count; a++) {
-            var portalA = portals[a];
-            var pointsA = portalPoints[a];
-
-            for (var b = a + 1; b < portals.Count; b++) {
-               var portalB = portals[b];
-               var pointsB = portalPoints[b];
-
-               var numLinks = pointsA.Length * pointsB.Length;
-               var linkStates = new LinkState[numLinks];
-               var linkStateIndex = 0;
-
-               var queries = stackalloc seg2i16[numLinks];
-               var pNextQuerySegment = queries;
-
-               for (var i = 0; i < pointsA.Length; i++) {
-                  var pa = pointsA[i];
-                  for (var j = 0; j < pointsB.Length; j++) {
-                     var pb = pointsB[j];
-                     pNextQuerySegment->x1 = (short)pa.X;
-                     pNextQuerySegment->y1 = (short)pa.Y;
-                     pNextQuerySegment->x2 = (short)pb.X;
-                     pNextQuerySegment->y2 = (short)pb.Y;
-                     pNextQuerySegment++;
-                  }
+      // Compile for a whole sector set, sectors on the thread pool. A hole is projected once per
+      // distinct (primitive, hole transform, land transform), compared by value, and shared by
+      // every sector it lands on.
+      public SectorCompilationOutput[] CompileAll(IReadOnlyList<SectorCompilationInput> inputs) {
+         var holeProjectionKeys = new List<HoleProjectionKey>();
+         var holeProjectionIndices = new Dictionary<HoleProjectionKey, int>();
+         var sectorHoleProjectionIndices = new int[inputs.Count][];
+         for (var i = 0; i < inputs.Count; i++) {
+            var input = inputs[i];
+            sectorHoleProjectionIndices[i] = new int[input.Holes.Count];
+            for (var j = 0; j < input.Holes.Count; j++) {
+               var key = new HoleProjectionKey(input.Holes[j], input.Land.Transform);
+               if (!holeProjectionIndices.TryGetValue(key, out var index)) {
+                  index = holeProjectionKeys.Count;
+                  holeProjectionKeys.Add(key);
+                  holeProjectionIndices.Add(key, index);
                }
-
-               var results = stackalloc byte[numLinks];
-               NativeUtils.QueryAnySegmentIntersections(segsIntersectPrequeryState, queries, numLinks, results);
-
-               for (var i = 0; i < pointsA.Length; i++) {
-                  for (var j = 0; j < pointsB.Length; j++) {
-                     var occluded = *results != 0;
-                     linkStates[linkStateIndex] = new LinkState {
-                        Occluded = occluded,
-                     };
-                     linkStateIndex++;
-                     results++;
-                     if (!occluded) pass++;
-                  }
-               }
-
-               allLinkStates.Add(linkStates);
+               sectorHoleProjectionIndices[i][j] = index;
             }
          }
 
-         NativeUtils.FreePrequeryAnySegmentIntersections(segsIntersectPrequeryState);
+         var holeProjections = new List<List<IntVector2>>[holeProjectionKeys.Count];
+         Parallel.For(0, holeProjectionKeys.Count, i => {
+            holeProjections[i] = ProjectHoleContours(holeProjectionKeys[i].Hole, holeProjectionKeys[i].LandTransform);
+         });
+
+         var outputs = new SectorCompilationOutput[inputs.Count];
+         Parallel.For(0, inputs.Count, i => {
+            var holeContours = sectorHoleProjectionIndices[i].Select(index => holeProjections[index]);
+            outputs[i] = Compile(inputs[i], holeContours, null, new SectorCompilationTimings());
+         });
+         return outputs;
+      }
+
+      private static SectorCompilationOutput Compile(SectorCompilationInput input, IEnumerable<List<List<IntVector2>>> holeContours, IDebugCanvas debugCanvasOpt, SectorCompilationTimings timingsOpt) {
+         var sw = Stopwatch.StartNew();
+         var portalPoints = ComputePortalPoints(input.Portals);
+         var punchedLand = ComputePunchedLand(input, holeContours, debugCanvasOpt);
+         var punchMilliseconds = sw.Elapsed.TotalMilliseconds;
+
+         // Barriers, portal point link states and triangulation in one native pass.
+         Triangulator.FlattenPolygonTree(punchedLand, out var points, out var contourOffsets, out var contourParents);
+         var (barriers, portalPointLinkStates, contourTriangleOffsets, triangleVertices, triangleNeighbors, neighborSharedEdges) =
+            NativeUtils.CompileSector(points, contourOffsets, contourParents, portalPoints);
+         var triangulation = new Triangulator().CreateTriangulation(points, contourTriangleOffsets, triangleVertices, triangleNeighbors, neighborSharedEdges);
 
          if (debugCanvasOpt != null) {
-            Console.WriteLine(pass);
+            Console.WriteLine(portalPointLinkStates.CountVisible());
          }
 
-         return allLinkStates;
-      }
+         if (timingsOpt != null) {
+            timingsOpt.PunchMilliseconds = punchMilliseconds;
+            timingsOpt.CompileMilliseconds = sw.Elapsed.TotalMilliseconds - punchMilliseconds;
+         }
 
-      private static IntLineSegment2[] ComputeVisibilityBarriers(PolygonNode punchedLand) {
-         return new BarrierCalculator().CalculateContourAndChildHoleBarriers(punchedLand);
+         return new SectorCompilationOutput { 
+            Input = input,
+            PortalPoints = portalPoints,
+            PunchedLand = punchedLand,
+            VisibilityBarriers = barriers,
+            PortalPointLinkStates = portalPointLinkStates,
+            Triangulation = triangulation,
+            Timings = timingsOpt,
+         };
       }
 
       private static IntVector2[][] ComputePortalPoints(ExposedArrayList<SectorPortal> portals) {
@@ -112,32 +96,40 @@ namespace Dargon.Terragami.Sectors {
          return portalPoints;
       }
 
-      private static PolygonNode ComputePunchedLand(SectorCompilationInput input, IDebugCanvas debugCanvasOpt) {
-         var punch = PolygonOperations.Punch();
-         punch.Include(input.Land.Blueprint.Root);
-         foreach (var hole in input.Holes) {
-            var holeProjection = hole.HolePrimitive.Project(hole.Transform, input.Land.Transform);
-            var holeTransform = holeProjection.Transform.Flatten();
-            var mat = holeTransform.Matrix;
-
-            var s = new Stack<PolygonNode>();
-            var transformedContour = new List<IntVector2>();
-            s.Push(holeProjection.Root);
-            while (s.Count > 0) {
-               var n = s.Pop();
-               foreach (var succ in n.Children) {
-                  s.Push(succ);
-               }
+      // The hole's contours projected onto land with the given transform.
+      private static List<List<IntVector2>> ProjectHoleContours(HoleInput hole, CoreTransform landTransform) {
+         var holeProjection = hole.HolePrimitive.Project(hole.Transform, landTransform);
+         var holeTransform = holeProjection.Transform.Flatten();
+         var mat = holeTransform.Matrix;
+
+         var contours = new List<List<IntVector2>>();
+         var s = new Stack<PolygonNode>();
+         s.Push(holeProjection.Root);
+         while (s.Count > 0) {
+            var n = s.Pop();
+            foreach (var succ in n.Children) {
+               s.Push(succ);
+            }
 
-               if (n.Contour == null) continue;
+            if (n.Contour == null) continue;
 
-               transformedContour.Clear();
-               foreach (var p in n.Contour) {
-                  var q = Vector2.Transform(p.ToDotNetVector(), mat).ToOpenMobaVector().LossyToIntVector2();
-                  transformedContour.Add(q);
-               }
+            var transformedContour = new List<IntVector2>(n.Contour.Length);
+            foreach (var p in n.Contour) {
+               var q = Vector2.Transform(p.ToDotNetVector(), mat).ToOpenMobaVector().LossyToIntVector2();
+               transformedContour.Add(q);
+            }
+            contours.Add(transformedContour);
+         }
+
+         return contours;
+      }
 
-               punch.Exclude(transformedContour);
+      private static PolygonNode ComputePunchedLand(SectorCompilationInput input, IEnumerable<List<List<IntVector2>>> holeContours, IDebugCanvas debugCanvasOpt) {
+         var punch = PolygonOperations.Punch();
+         punch.Include(input.Land.Blueprint.Root);
+         foreach (var contours in holeContours) {
+            foreach (var contour in contours) {
+               punch.Exclude(contour);
             }
          }
 
@@ -159,7 +151,43 @@ namespace Dargon.Terragami.Sectors {
       public PolygonNode PunchedLand;
       public IntVector2[][] PortalPoints;
       public IntLineSegment2[] VisibilityBarriers;
-      public List<LinkState[]> PortalPointLinkStates;
+      public PortalLinkStates PortalPointLinkStates;
       public Triangulation Triangulation;
+      public SectorCompilationTimings Timings; // CompileAll only
+   }
+
+   // Per-stage times of one sector's compilation: the managed punch, then the native pass and
+   // triangulation unpacking.
+   public class SectorCompilationTimings {
+      public double PunchMilliseconds;
+      public double CompileMilliseconds;
+   }
+
+   // A hole projection's inputs. Transforms are compared by value: sectors are usually given
+   // their own CoreTransform instances even where they coincide.
+   internal readonly struct HoleProjectionKey : IEquatable<HoleProjectionKey> {
+      public readonly HoleInput Hole;
+      public readonly CoreTransform LandTransform;
+
+      public HoleProjectionKey(HoleInput hole, CoreTransform landTransform) {
+         Hole = hole;
+         LandTransform = landTransform;
+      }
+
+      public bool Equals(HoleProjectionKey other) {
+         return Hole.HolePrimitive == other.Hole.HolePrimitive &&
+                TransformEquals(Hole.Transform, other.Hole.Transform) &&
+                TransformEquals(LandTransform, other.LandTransform);
+      }
+
+      public override bool Equals(object obj) => obj is HoleProjectionKey other && Equals(other);
+
+      public override int GetHashCode() {
+         return HashCode.Combine(Hole.HolePrimitive, Hole.Transform.Matrix, Hole.Transform.Scale, LandTransform.Matrix, LandTransform.Scale);
+      }
+
+      private static bool TransformEquals(CoreTransform a, CoreTransform b) {
+         return a.Matrix == b.Matrix && a.InverseMatrix == b.InverseMatrix && a.Scale.Equals(b.Scale);
+      }
    }
 }
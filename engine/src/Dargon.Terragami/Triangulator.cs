@@ -184,6 +184,78 @@ namespace Dargon.PlayOn {
 #endif
             }
          }
+         islands.Add(CreateIsland(triangles));
+         foreach (var innerChild in node.Children.SelectMany(hole => hole.Children)) {
+            TriangulateHelper(innerChild, islands);
+         }
+      }
+
+      // TriangulateRoot through the native constrained Delaunay triangulator: same islands in the
+      // same order, land islands triangulated in parallel. Triangle order within an island differs.
+      public Triangulation TriangulateRootNative(PolygonNode polyTree) {
+         FlattenPolygonTree(polyTree, out var points, out var contourOffsets, out var contourParents);
+         var (contourTriangleOffsets, triangleVertices, triangleNeighbors, neighborSharedEdges) =
+            NativeUtils.TriangulatePolygonTree(points, contourOffsets, contourParents);
+         return CreateTriangulation(points, contourTriangleOffsets, triangleVertices, triangleNeighbors, neighborSharedEdges);
+      }
+
+      // The native polygon tree format: contour i is points [contourOffsets[i], contourOffsets[i + 1])
+      // under contour contourParents[i] (-1 under the root). Preorder, so land contours come out in
+      // TriangulateHelper's island order.
+      public static void FlattenPolygonTree(PolygonNode polyTree, out IntVector2[] points, out int[] contourOffsets, out int[] contourParents) {
+         if (!polyTree.IsHole || polyTree.Contour != null) {
+            throw new ArgumentException("Expected polytree to be contourless root hole!");
+         }
+
+         var pointList = new List<IntVector2>();
+         var contourOffsetList = new List<int> { 0 };
+         var contourParentList = new List<int>();
+         foreach (var child in polyTree.Children) {
+            FlattenContours(child, -1, pointList, contourOffsetList, contourParentList);
+         }
+         points = pointList.ToArray();
+         contourOffsets = contourOffsetList.ToArray();
+         contourParents = contourParentList.ToArray();
+      }
+
+      private static void FlattenContours(PolygonNode node, int parent, List<IntVector2> points, List<int> contourOffsets, List<int> contourParents) {
+         var index = contourParents.Count;
+         points.AddRange(node.Contour);
+         contourOffsets.Add(points.Count);
+         contourParents.Add(parent);
+         foreach (var child in node.Children) {
+            FlattenContours(child, index, points, contourOffsets, contourParents);
+         }
+      }
+
+      // Islands from a native triangulation of a flattened polygon tree, one per land contour.
+      public Triangulation CreateTriangulation(IntVector2[] points, int[] contourTriangleOffsets, int[] triangleVertices, int[] triangleNeighbors, int[] neighborSharedEdges) {
+         var islands = new List<TriangulationIsland>();
+         for (var c = 0; c + 1 < contourTriangleOffsets.Length; c++) {
+            var begin = contourTriangleOffsets[c];
+            var triangles = new Triangle3[contourTriangleOffsets[c + 1] - begin];
+            if (triangles.Length == 0) continue;
+
+            for (var i = 0; i < triangles.Length; i++) {
+               ref Triangle3 t = ref triangles[i];
+               var k = 3 * (begin + i);
+               t.Index = i;
+               t.Points = new Array3<DoubleVector2>(
+                  points[triangleVertices[k]].ToDoubleVector2(),
+                  points[triangleVertices[k + 1]].ToDoubleVector2(),
+                  points[triangleVertices[k + 2]].ToDoubleVector2()
+               );
+               t.Centroid = (t.Points[0] + t.Points[1] + t.Points[2]) / CDoubleMath.c3;
+               t.IntPaddedBounds2D = CreatePaddedIntAxisAlignedBoundingBoxXY2D(ref triangles[i].Points);
+               t.NeighborOppositePointIndices = new Array3<int>(triangleNeighbors[k], triangleNeighbors[k + 1], triangleNeighbors[k + 2]);
+               t.NeighborVertexIndexSharingEdgeOppositePointIndices = new Array3<int>(neighborSharedEdges[k], neighborSharedEdges[k + 1], neighborSharedEdges[k + 2]);
+            }
+            islands.Add(CreateIsland(triangles));
+         }
+         return new Triangulation { Islands = islands };
+      }
+
+      private TriangulationIsland CreateIsland(Triangle3[] triangles) {
          var islandBoundingBox = new IntRect2 {
             Left = triangles.Min(t => t.IntPaddedBounds2D.Left),
             Top = triangles.Min(t => t.IntPaddedBounds2D.Top),
@@ -194,17 +266,14 @@ namespace Dargon.PlayOn {
          for (var i = 0; i < triangles.Length; i++) {
             triangleIndexQuadTree.Insert(i, triangles[i].IntPaddedBounds2D);
          }
-         islands.Add(new TriangulationIsland {
+         return new TriangulationIsland {
             Triangles = triangles,
             IntBounds = islandBoundingBox,
             TriangleIndexQuadTree = triangleIndexQuadTree,
 #if use_fixed
             FixedOptimizationTriangleBounds = triangles.Map(t => AxisAlignedBoundingBox2.BoundingPoints(new []{ t.Points[0], t.Points[1], t.Points[2] })),
 #endif
-         });
-         foreach (var innerChild in node.Children.SelectMany(hole => hole.Children)) {
-            TriangulateHelper(innerChild, islands);
-         }
+         };
       }
 
       private IntRect2 CreatePaddedIntAxisAlignedBoundingBoxXY2D(ref Array3<DoubleVector2> points) {
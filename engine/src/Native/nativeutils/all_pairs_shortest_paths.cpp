@@ -0,0 +1,213 @@
+#include "pch.h"
+#include "all_pairs_shortest_paths.hpp"
+#include "geometry.hpp"
+#include <atomic>
+#include <barrier>
+#include <limits>
+#include <thread>
+
+namespace {
+   // 32x32 tiles: a tile's costs and predecessors are 8KB, so the three tiles a relaxation
+   // touches stay in L1, and a tile row is exactly four AVX2 registers.
+   constexpr int kTileSize = 32;
+   constexpr int kLanes = 8;
+
+   // Below this many tiles per side, threads cost more than they save.
+   constexpr int kParallelMinTiles = 4;
+
+   struct Matrices {
+      int Stride;
+      float* Costs;
+      int32_t* Predecessors;
+
+      FORCEINLINE size_t TileOffset(int ti, int tj) const {
+         return static_cast<size_t>(ti) * kTileSize * Stride + static_cast<size_t>(tj) * kTileSize;
+      }
+   };
+
+   FORCEINLINE void RelaxRow(float* dst, int32_t* dstPred, __m256 dik, const float* dkj, const int32_t* pkj) {
+      for (auto j = 0; j < kTileSize; j += kLanes) {
+         auto current = _mm256_loadu_ps(dst + j);
+         auto candidate = _mm256_add_ps(dik, _mm256_loadu_ps(dkj + j));
+         auto improved = _mm256_cmp_ps(candidate, current, _CMP_LT_OQ);
+         _mm256_storeu_ps(dst + j, _mm256_blendv_ps(current, candidate, improved));
+
+         auto pred = _mm256_loadu_ps(reinterpret_cast<const float*>(dstPred + j));
+         auto viaK = _mm256_loadu_ps(reinterpret_cast<const float*>(pkj + j));
+         _mm256_storeu_ps(reinterpret_cast<float*>(dstPred + j), _mm256_blendv_ps(pred, viaK, improved));
+      }
+   }
+
+   // tile(ti, tj) = min(tile(ti, tj), tile(ti, tk) + tile(tk, tj)) for each k of tk in order.
+   // k is the outer loop so this is safe when the destination is also one of the sources
+   // (phases 1 and 2): row k / column k of a tile never change during step k.
+   void RelaxTile(const Matrices& m, int ti, int tj, int tk) {
+      const auto stride = m.Stride;
+      auto dij = m.Costs + m.TileOffset(ti, tj);
+      auto pij = m.Predecessors + m.TileOffset(ti, tj);
+      const auto dik = m.Costs + m.TileOffset(ti, tk);
+      const auto dkj = m.Costs + m.TileOffset(tk, tj);
+      const auto pkj = m.Predecessors + m.TileOffset(tk, tj);
+
+      for (auto k = 0; k < kTileSize; k++) {
+         for (auto i = 0; i < kTileSize; i++) {
+            auto c = dik[i * stride + k];
+            if (c == std::numeric_limits<float>::infinity()) continue;
+
+            RelaxRow(dij + i * stride, pij + i * stride, _mm256_set1_ps(c), dkj + k * stride, pkj + k * stride);
+         }
+      }
+   }
+
+   // Phase 3 for an off-diagonal pair ti > tj: costs are symmetric, so tile(tj, ti) is the
+   // transpose of tile(ti, tj) and improves exactly where it does. Only its predecessors
+   // differ - pred[j][i] takes pred[k][i] - so they're tracked in a transposed scratch tile
+   // alongside, and both are written back once at the end.
+   void RelaxTilePairSymmetric(const Matrices& m, int ti, int tj, int tk) {
+      const auto stride = m.Stride;
+      auto dij = m.Costs + m.TileOffset(ti, tj);
+      auto pij = m.Predecessors + m.TileOffset(ti, tj);
+      auto dji = m.Costs + m.TileOffset(tj, ti);
+      auto pji = m.Predecessors + m.TileOffset(tj, ti);
+      const auto dik = m.Costs + m.TileOffset(ti, tk);
+      const auto pki = m.Predecessors + m.TileOffset(tk, ti);
+      const auto dkj = m.Costs + m.TileOffset(tk, tj);
+      const auto pkj = m.Predecessors + m.TileOffset(tk, tj);
+
+      alignas(32) int32_t mirrorPred[kTileSize * kTileSize];
+      for (auto i = 0; i < kTileSize; i++) {
+         for (auto j = 0; j < kTileSize; j++) {
+            mirrorPred[i * kTileSize + j] = pji[j * stride + i];
+         }
+      }
+
+      for (auto i = 0; i < kTileSize; i++) {
+         auto dRow = dij + i * stride;
+         auto pRow = pij + i * stride;
+         auto mirrorRow = mirrorPred + i * kTileSize;
+
+         for (auto k = 0; k < kTileSize; k++) {
+            auto c = dik[i * stride + k];
+            if (c == std::numeric_limits<float>::infinity()) continue;
+
+            const auto vdik = _mm256_set1_ps(c);
+            const auto vpki = _mm256_castsi256_ps(_mm256_set1_epi32(pki[k * stride + i]));
+            const auto dkjRow = dkj + k * stride;
+            const auto pkjRow = pkj + k * stride;
+
+            for (auto j = 0; j < kTileSize; j += kLanes) {
+               auto current = _mm256_loadu_ps(dRow + j);
+               auto candidate = _mm256_add_ps(vdik, _mm256_loadu_ps(dkjRow + j));
+               auto improved = _mm256_cmp_ps(candidate, current, _CMP_LT_OQ);
+               _mm256_storeu_ps(dRow + j, _mm256_blendv_ps(current, candidate, improved));
+
+               auto pred = _mm256_loadu_ps(reinterpret_cast<const float*>(pRow + j));
+               auto viaK = _mm256_loadu_ps(reinterpret_cast<const float*>(pkjRow + j));
+               _mm256_storeu_ps(reinterpret_cast<float*>(pRow + j), _mm256_blendv_ps(pred, viaK, improved));
+
+               auto mirror = _mm256_load_ps(reinterpret_cast<const float*>(mirrorRow + j));
+               _mm256_store_ps(reinterpret_cast<float*>(mirrorRow + j), _mm256_blendv_ps(mirror, vpki, improved));
+            }
+         }
+      }
+
+      for (auto i = 0; i < kTileSize; i++) {
+         for (auto j = 0; j < kTileSize; j++) {
+            dji[j * stride + i] = dij[i * stride + j];
+            pji[j * stride + i] = mirrorPred[i * kTileSize + j];
+         }
+      }
+   }
+}
+
+void FloydWarshallBlocked(const int* offsets, const int* edgeTargets, const float* edgeCosts, int numNodes, float* costs, int32_t* predecessors) {
+   if (numNodes <= 0) return;
+
+   // Work on a copy padded to whole tiles; padding nodes are unreachable so never relax anything.
+   const auto numTiles = (numNodes + kTileSize - 1) / kTileSize;
+   const auto stride = numTiles * kTileSize;
+   std::vector<float> paddedCosts(static_cast<size_t>(stride) * stride, std::numeric_limits<float>::infinity());
+   std::vector<int32_t> paddedPredecessors(static_cast<size_t>(stride) * stride, -1);
+   Matrices m{ stride, paddedCosts.data(), paddedPredecessors.data() };
+
+   for (auto i = 0; i < stride; i++) {
+      m.Costs[static_cast<size_t>(i) * stride + i] = 0;
+      m.Predecessors[static_cast<size_t>(i) * stride + i] = i;
+   }
+   for (auto i = 0; i < numNodes; i++) {
+      for (auto e = offsets[i]; e < offsets[i + 1]; e++) {
+         auto j = edgeTargets[e];
+         auto ij = static_cast<size_t>(i) * stride + j;
+         auto ji = static_cast<size_t>(j) * stride + i;
+         if (i == j || edgeCosts[e] >= m.Costs[ij]) continue;
+
+         m.Costs[ij] = m.Costs[ji] = edgeCosts[e];
+         m.Predecessors[ij] = i;
+         m.Predecessors[ji] = j;
+      }
+   }
+
+   // Pairs (ti, tj) with ti >= tj; phase 3 handles each off-diagonal pair as one task.
+   std::vector<pair2i32> lowerTiles;
+   lowerTiles.reserve(static_cast<size_t>(numTiles) * (numTiles + 1) / 2);
+   for (auto ti = 0; ti < numTiles; ti++) {
+      for (auto tj = 0; tj <= ti; tj++) {
+         lowerTiles.push_back({ ti, tj });
+      }
+   }
+
+   // One team of threads runs every pivot, meeting at a barrier after each phase: spawning a
+   // ParallelFor per phase would cost more than a small graph's phases take. Each pivot's phases
+   // hand out tiles from their own counters, so none need resetting.
+   const auto numThreads = numTiles < kParallelMinTiles ? 1 : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+   const auto numLowerTiles = static_cast<int>(lowerTiles.size());
+   std::vector<std::atomic<int>> nextTiles(2 * static_cast<size_t>(numTiles));
+   std::barrier phaseEnd(numThreads);
+
+   auto worker = [&](int thread) {
+      for (auto tk = 0; tk < numTiles; tk++) {
+         // Phase 1: the pivot tile depends only on itself.
+         if (thread == 0) RelaxTile(m, tk, tk, tk);
+         phaseEnd.arrive_and_wait();
+
+         // Phase 2: pivot row and column tiles depend on themselves and the pivot tile.
+         auto& nextRowOrColumn = nextTiles[2 * tk];
+         for (auto index = nextRowOrColumn++; index < 2 * numTiles; index = nextRowOrColumn++) {
+            auto t = index >> 1;
+            if (t == tk) continue;
+
+            if (index & 1) {
+               RelaxTile(m, t, tk, tk);
+            } else {
+               RelaxTile(m, tk, t, tk);
+            }
+         }
+         phaseEnd.arrive_and_wait();
+
+         // Phase 3: everything else depends only on the pivot row and column.
+         auto& nextLower = nextTiles[2 * tk + 1];
+         for (auto index = nextLower++; index < numLowerTiles; index = nextLower++) {
+            auto ti = lowerTiles[index].a, tj = lowerTiles[index].b;
+            if (ti == tk || tj == tk) continue;
+
+            if (ti == tj) {
+               RelaxTile(m, ti, tj, tk);
+            } else {
+               RelaxTilePairSymmetric(m, ti, tj, tk);
+            }
+         }
+         phaseEnd.arrive_and_wait();
+      }
+   };
+
+   std::vector<std::thread> threads;
+   threads.reserve(numThreads - 1);
+   for (auto t = 1; t < numThreads; t++) threads.emplace_back(worker, t);
+   worker(0);
+   for (auto& thread : threads) thread.join();
+
+   for (auto i = 0; i < numNodes; i++) {
+      std::copy_n(m.Costs + static_cast<size_t>(i) * stride, numNodes, costs + static_cast<size_t>(i) * numNodes);
+      std::copy_n(m.Predecessors + static_cast<size_t>(i) * stride, numNodes, predecessors + static_cast<size_t>(i) * numNodes);
+   }
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+// All-pairs shortest paths over an undirected graph in CSR form: node i's edges are
+// [offsets[i], offsets[i + 1]), edge e runs to edgeTargets[e] at cost edgeCosts[e] >= 0.
+// An edge listed in only one direction is still taken to exist in both.
+//
+// Writes two numNodes x numNodes row-major matrices:
+//    costs[i * numNodes + j]        - shortest distance from i to j, +inf if unreachable.
+//    predecessors[i * numNodes + j] - the node before j on that path; i on the diagonal, -1 if unreachable.
+// As paths are undirected, predecessors[d * numNodes + s] is also the first hop from s towards d.
+// The managed Floyd-Warshall LUT is the transpose: its res[s][d].PriorIndex is that first hop, indexed
+// [source][destination], so res[s][d].PriorIndex == predecessors[d * numNodes + s].
+void FloydWarshallBlocked(const int* offsets, const int* edgeTargets, const float* edgeCosts, int numNodes, float* costs, int32_t* predecessors);
@@ -1,6 +1,15 @@
 #include "pch.h"
 #include "api.hpp"
 #include "api_context.hpp"
+#include "all_pairs_shortest_paths.hpp"
+#include "constrained_delaunay.hpp"
+#include "dijkstras.hpp"
+#include "flocking.hpp"
+#include "sector_compiler.hpp"
+#include "sector_portal_bounds.hpp"
+#include "segment_intersections.hpp"
+#include "visibility_graph.hpp"
+#include "visibility_polygons.hpp"
 
 namespace {
    std::shared_ptr<ApiContext> context = std::make_shared<ApiContext>();
@@ -28,6 +37,18 @@ IMPLEMENT_API(LoadPrequeryAnySegmentIntersections)(const seg2i16* barriers, int
    ERROR_WRAPPER_END
 }
 
+IMPLEMENT_API(LoadPrequeryAnySegmentIntersectionsI32)(const seg2i32* barriers, int numBarriers, OUT OPAQUE_HANDLE& handle) {
+   ERROR_WRAPPER_BEGIN
+   return context->LoadPrequeryBarriersIntersectionState(barriers, numBarriers, OUT reinterpret_cast<uint64_t&>(handle));
+   ERROR_WRAPPER_END
+}
+
+IMPLEMENT_API(LoadPrequeryContourBarrierIntersections)(const point2i32* points, const int* contourOffsets, int numContours, int exaggerationFactor, OUT OPAQUE_HANDLE& handle) {
+   ERROR_WRAPPER_BEGIN
+   return context->LoadContourBarriersIntersectionState(points, contourOffsets, numContours, exaggerationFactor, OUT reinterpret_cast<uint64_t&>(handle));
+   ERROR_WRAPPER_END
+}
+
 IMPLEMENT_API(QueryAnySegmentIntersections)(OPAQUE_HANDLE prequeryStateHandle, const seg2i16* queries, int numQueries, uint8_t* results) {
    ERROR_WRAPPER_BEGIN
    return context->AnyIntersections(reinterpret_cast<uint64_t>(prequeryStateHandle), queries, numQueries, results);
@@ -38,4 +59,314 @@ IMPLEMENT_API(FreePrequeryAnySegmentIntersections)(OPAQUE_HANDLE prequeryStateHa
    ERROR_WRAPPER_BEGIN
    return context->FreePrequeryAnySegmentIntersections(reinterpret_cast<uint64_t>(prequeryStateHandle));
    ERROR_WRAPPER_END
+}
+
+IMPLEMENT_API(FindAllSegmentIntersections)(const seg2i32* segments, int numSegments, bool detectEndpointContainment, pair2i32* pairs, int pairCapacity, OUT int& numPairs) {
+   ERROR_WRAPPER_BEGIN
+   std::vector<pair2i32> results;
+   ::FindAllIntersectingPairs(segments, numSegments, detectEndpointContainment, results);
+
+   numPairs = static_cast<int>(results.size());
+   std::copy_n(results.begin(), std::min(numPairs, pairCapacity), pairs);
+   return numPairs <= pairCapacity ? ApiResult::Success : ApiResult::ErrorInsufficientBuffer;
+   ERROR_WRAPPER_END
+}
+
+IMPLEMENT_API(ComputeAllPairsShortestPaths)(const int* offsets, const int* edgeTargets, const float* edgeCosts, int numNodes, float* costs, int32_t* predecessors) {
+   ERROR_WRAPPER_BEGIN
+   ::FloydWarshallBlocked(offsets, edgeTargets, edgeCosts, numNodes, costs, predecessors);
+   return ApiResult::Success;
+   ERROR_WRAPPER_END
+}
+
+IMPLEMENT_API(Dijkstras)(const int* offsets, const int* edgeTargets, const float* edgeCosts, int numNodes, const dijkstra_seed_s* seeds, int numSeeds, const int* terminals, int numTerminals, float* costs, int32_t* predecessors) {
+   ERROR_WRAPPER_BEGIN
+   for (auto i = 0; i < numSeeds; i++) {
+      if (!IsValidDijkstraSeed(seeds[i], numNodes)) return ApiResult::ErrorInvalidArgument;
+   }
+
+   ::Dijkstras(offsets, edgeTargets, edgeCosts, numNodes, seeds, numSeeds, terminals, numTerminals, costs, predecessors);
+   return ApiResult::Success;
+   ERROR_WRAPPER_END
+}
+
+IMPLEMENT_API(DijkstrasBatch)(const int* offsets, const int* edgeTargets, const float* edgeCosts, int numNodes, const int* sources, int numSources, float* costs, int32_t* predecessors) {
+   ERROR_WRAPPER_BEGIN
+   for (auto i = 0; i < numSources; i++) {
+      if (sources[i] < 0 || sources[i] >= numNodes) return ApiResult::ErrorInvalidArgument;
+   }
+
+   ::DijkstrasBatch(offsets, edgeTargets, edgeCosts, numNodes, sources, numSources, costs, predecessors);
+   return ApiResult::Success;
+   ERROR_WRAPPER_END
+}
+
+IMPLEMENT_API(BuildVisibilityGraph)(const point2i32* waypoints, int numWaypoints, const seg2i32* barriers, int numBarriers, int* offsets, int* edgeTargets, float* edgeCosts, int edgeCapacity, OUT int& numEdges) {
+   ERROR_WRAPPER_BEGIN
+   ::BuildVisibilityGraph(waypoints, numWaypoints, barriers, numBarriers, offsets, edgeTargets, edgeCosts, edgeCapacity, OUT numEdges);
+   return numEdges <= edgeCapacity ? ApiResult::Success : ApiResult::ErrorInsufficientBuffer;
+   ERROR_WRAPPER_END
+}
+
+IMPLEMENT_API(BuildVisibilityPolygons)(const point2i32* origins, int numOrigins, const seg2i32* barriers, int numBarriers, int* offsets, int32_t* rangeIds, double* rangeThetaStarts, int rangeCapacity, OUT int& numRanges) {
+   ERROR_WRAPPER_BEGIN
+   VisibilityPolygonSet polygons;
+   ::BuildVisibilityPolygons(origins, numOrigins, barriers, numBarriers, OUT polygons);
+
+   std::copy(polygons.Offsets.begin(), polygons.Offsets.end(), offsets);
+   numRanges = static_cast<int>(polygons.Ids.size());
+   std::copy_n(polygons.Ids.begin(), std::min(numRanges, rangeCapacity), rangeIds);
+   std::copy_n(polygons.ThetaStarts.begin(), std::min(numRanges, rangeCapacity), rangeThetaStarts);
+   return numRanges <= rangeCapacity ? ApiResult::Success : ApiResult::ErrorInsufficientBuffer;
+   ERROR_WRAPPER_END
+}
+
+IMPLEMENT_API(LoadVisibilityPolygons)(const point2i32* origins, int numOrigins, const seg2i32* barriers, int numBarriers, OUT OPAQUE_HANDLE& handle) {
+   ERROR_WRAPPER_BEGIN
+   return context->LoadVisibilityPolygonQueryState(origins, numOrigins, barriers, numBarriers, OUT reinterpret_cast<uint64_t&>(handle));
+   ERROR_WRAPPER_END
+}
+
+IMPLEMENT_API(QueryVisibilityPolygonsContainingPoints)(OPAQUE_HANDLE visibilityPolygonsHandle, const point2f64* points, int numPoints, int* resultOffsets, int32_t* originIndices, float* distances, int resultCapacity, OUT int& numResults) {
+   ERROR_WRAPPER_BEGIN
+   std::vector<int> offsets;
+   std::vector<int32_t> indices;
+   std::vector<float> dists;
+   auto res = context->QueryPointSeeingOrigins(reinterpret_cast<uint64_t>(visibilityPolygonsHandle), points, numPoints, offsets, indices, dists);
+   if (res != ApiResult::Success) return res;
+
+   std::copy(offsets.begin(), offsets.end(), resultOffsets);
+   numResults = static_cast<int>(indices.size());
+   std::copy_n(indices.begin(), std::min(numResults, resultCapacity), originIndices);
+   std::copy_n(dists.begin(), std::min(numResults, resultCapacity), distances);
+   return numResults <= resultCapacity ? ApiResult::Success : ApiResult::ErrorInsufficientBuffer;
+   ERROR_WRAPPER_END
+}
+
+IMPLEMENT_API(QueryVisibilityPolygonsSeeingSegments)(OPAQUE_HANDLE visibilityPolygonsHandle, const seg2f64* segments, int numSegments, uint32_t* seeingOriginBits) {
+   ERROR_WRAPPER_BEGIN
+   return context->QuerySegmentSeeingOrigins(reinterpret_cast<uint64_t>(visibilityPolygonsHandle), segments, numSegments, seeingOriginBits);
+   ERROR_WRAPPER_END
+}
+
+IMPLEMENT_API(FreeVisibilityPolygons)(OPAQUE_HANDLE visibilityPolygonsHandle) {
+   ERROR_WRAPPER_BEGIN
+   return context->FreeVisibilityPolygonQueryState(reinterpret_cast<uint64_t>(visibilityPolygonsHandle));
+   ERROR_WRAPPER_END
+}
+
+IMPLEMENT_API(LoadOverlayGraph)(const int* offsets, const int* edgeTargets, const float* edgeCosts, int numVertices, OUT OPAQUE_HANDLE& handle) {
+   ERROR_WRAPPER_BEGIN
+   return context->LoadOverlayGraph(offsets, edgeTargets, edgeCosts, numVertices, OUT reinterpret_cast<uint64_t&>(handle));
+   ERROR_WRAPPER_END
+}
+
+IMPLEMENT_API(QueryOverlayUniformCostSearch)(OPAQUE_HANDLE overlayGraphHandle, bool followEdgesReversed, const dijkstra_seed* seeds, int numSeeds, const dijkstra_seed* terminalLinks, int numTerminalLinks, int numDestinations, float* destinationCosts, int* pathOffsets, dijkstra_seed* pathLinks, int pathCapacity, OUT int& numPathLinks) {
+   ERROR_WRAPPER_BEGIN
+   std::vector<dijkstra_seed> links;
+   auto res = context->UniformCostSearch(reinterpret_cast<uint64_t>(overlayGraphHandle), followEdgesReversed, seeds, numSeeds, terminalLinks, numTerminalLinks, numDestinations, destinationCosts, pathOffsets, links);
+   if (res != ApiResult::Success) return res;
+
+   numPathLinks = static_cast<int>(links.size());
+   std::copy_n(links.begin(), std::min(numPathLinks, pathCapacity), pathLinks);
+   return numPathLinks <= pathCapacity ? ApiResult::Success : ApiResult::ErrorInsufficientBuffer;
+   ERROR_WRAPPER_END
+}
+
+IMPLEMENT_API(QueryOverlayPathBatch)(OPAQUE_HANDLE overlayGraphHandle, const dijkstra_seed* sourceLinks, int numSourceLinks, int numSources, const dijkstra_seed* destinationLinks, int numDestinationLinks, int numDestinations, const pair2i32* queries, int numQueries, float* costs, int* pathOffsets, dijkstra_seed* pathLinks, int pathCapacity, OUT int& numPathLinks) {
+   ERROR_WRAPPER_BEGIN
+   std::vector<dijkstra_seed> links;
+   auto res = context->BatchPathQueries(reinterpret_cast<uint64_t>(overlayGraphHandle), sourceLinks, numSourceLinks, numSources, destinationLinks, numDestinationLinks, numDestinations, queries, numQueries, costs, pathOffsets, links);
+   if (res != ApiResult::Success) return res;
+
+   numPathLinks = static_cast<int>(links.size());
+   std::copy_n(links.begin(), std::min(numPathLinks, pathCapacity), pathLinks);
+   return numPathLinks <= pathCapacity ? ApiResult::Success : ApiResult::ErrorInsufficientBuffer;
+   ERROR_WRAPPER_END
+}
+
+IMPLEMENT_API(FreeOverlayGraph)(OPAQUE_HANDLE overlayGraphHandle) {
+   ERROR_WRAPPER_BEGIN
+   return context->FreeOverlayGraph(reinterpret_cast<uint64_t>(overlayGraphHandle));
+   ERROR_WRAPPER_END
+}
+
+IMPLEMENT_API(LoadPortalLinkMatrix)(const int* portalPointOffsets, int numPortals, const uint64_t* linkVisibleBits, OUT OPAQUE_HANDLE& handle) {
+   ERROR_WRAPPER_BEGIN
+   return context->LoadPortalLinkMatrix(portalPointOffsets, numPortals, linkVisibleBits, OUT reinterpret_cast<uint64_t&>(handle));
+   ERROR_WRAPPER_END
+}
+
+IMPLEMENT_API(QueryPortalLinkVisibleCounts)(OPAQUE_HANDLE portalLinkMatrixHandle, const pair2i32* portalPairs, int numPortalPairs, int* counts) {
+   ERROR_WRAPPER_BEGIN
+   return context->CountVisibleLinks(reinterpret_cast<uint64_t>(portalLinkMatrixHandle), portalPairs, numPortalPairs, counts);
+   ERROR_WRAPPER_END
+}
+
+IMPLEMENT_API(QueryPortalLinksVisible)(OPAQUE_HANDLE portalLinkMatrixHandle, int a, int b, pair2i32* links, int linkCapacity, OUT int& numLinks) {
+   ERROR_WRAPPER_BEGIN
+   std::vector<pair2i32> visibleLinks;
+   auto res = context->QueryVisibleLinks(reinterpret_cast<uint64_t>(portalLinkMatrixHandle), a, b, visibleLinks);
+   if (res != ApiResult::Success) return res;
+
+   numLinks = static_cast<int>(visibleLinks.size());
+   std::copy_n(visibleLinks.begin(), std::min(numLinks, linkCapacity), links);
+   return numLinks <= linkCapacity ? ApiResult::Success : ApiResult::ErrorInsufficientBuffer;
+   ERROR_WRAPPER_END
+}
+
+IMPLEMENT_API(FreePortalLinkMatrix)(OPAQUE_HANDLE portalLinkMatrixHandle) {
+   ERROR_WRAPPER_BEGIN
+   return context->FreePortalLinkMatrix(reinterpret_cast<uint64_t>(portalLinkMatrixHandle));
+   ERROR_WRAPPER_END
+}
+
+IMPLEMENT_API(LoadSpatialHash)(int originX, int originY, int width, int height, int cellSize, OUT OPAQUE_HANDLE& handle) {
+   ERROR_WRAPPER_BEGIN
+   return context->LoadSpatialHash(originX, originY, width, height, cellSize, OUT reinterpret_cast<uint64_t&>(handle));
+   ERROR_WRAPPER_END
+}
+
+IMPLEMENT_API(UpdateSpatialHash)(OPAQUE_HANDLE spatialHashHandle, const point2i32* positions, const int32_t* radii, int numEntities) {
+   ERROR_WRAPPER_BEGIN
+   return context->UpdateSpatialHash(reinterpret_cast<uint64_t>(spatialHashHandle), positions, radii, numEntities);
+   ERROR_WRAPPER_END
+}
+
+IMPLEMENT_API(QuerySpatialHashNeighbors)(OPAQUE_HANDLE spatialHashHandle, int shape, const int32_t* queryRadii, int numEntities, int* neighborOffsets, int* neighbors, int neighborCapacity, OUT int& numNeighbors) {
+   ERROR_WRAPPER_BEGIN
+   std::vector<int> offsets, entityNeighbors;
+   auto res = context->QuerySpatialHashNeighbors(reinterpret_cast<uint64_t>(spatialHashHandle), static_cast<NeighborhoodShape>(shape), queryRadii, numEntities, offsets, entityNeighbors);
+   if (res != ApiResult::Success) return res;
+
+   std::copy_n(offsets.begin(), numEntities + 1, neighborOffsets);
+   numNeighbors = static_cast<int>(entityNeighbors.size());
+   std::copy_n(entityNeighbors.begin(), std::min(numNeighbors, neighborCapacity), neighbors);
+   return numNeighbors <= neighborCapacity ? ApiResult::Success : ApiResult::ErrorInsufficientBuffer;
+   ERROR_WRAPPER_END
+}
+
+IMPLEMENT_API(FreeSpatialHash)(OPAQUE_HANDLE spatialHashHandle) {
+   ERROR_WRAPPER_BEGIN
+   return context->FreeSpatialHash(reinterpret_cast<uint64_t>(spatialHashHandle));
+   ERROR_WRAPPER_END
+}
+
+IMPLEMENT_API(ComputeFlockingForces)(int numEntities, const int32_t* xs, const int32_t* ys, const float* radii, const float* seekXs, const float* seekYs, const float* directSeekXs, const float* directSeekYs, const uint8_t* onGoalTriangle, const float* seekAlignWeights, const int* neighborOffsets, const int* neighbors, float* forceXs, float* forceYs) {
+   ERROR_WRAPPER_BEGIN
+   ::ComputeFlockingForces(numEntities, xs, ys, radii, seekXs, seekYs, directSeekXs, directSeekYs, onGoalTriangle, seekAlignWeights, neighborOffsets, neighbors, forceXs, forceYs);
+   return ApiResult::Success;
+   ERROR_WRAPPER_END
+}
+
+IMPLEMENT_API(LoadTriangleMesh)(const point2f64* vertices, int numVertices, const int32_t* triangleVertices, const int32_t* triangleNeighbors, const int32_t* neighborSharedEdges, int numTriangles, OUT OPAQUE_HANDLE& handle) {
+   ERROR_WRAPPER_BEGIN
+   return context->LoadTriangleMesh(vertices, numVertices, triangleVertices, triangleNeighbors, neighborSharedEdges, numTriangles, OUT reinterpret_cast<uint64_t&>(handle));
+   ERROR_WRAPPER_END
+}
+
+IMPLEMENT_API(WalkTriangleMesh)(OPAQUE_HANDLE triangleMeshHandle, const seg2f64* haltSegments, const int32_t* haltClockness, int numHaltSegments, const int32_t* triangles, const point2f64* positions, const point2f64* displacements, int numWalks, walk_result* results) {
+   ERROR_WRAPPER_BEGIN
+   return context->WalkTriangleMesh(reinterpret_cast<uint64_t>(triangleMeshHandle), haltSegments, haltClockness, numHaltSegments, triangles, positions, displacements, numWalks, results);
+   ERROR_WRAPPER_END
+}
+
+IMPLEMENT_API(LocateTriangleMeshPoints)(OPAQUE_HANDLE triangleMeshHandle, const point2f64* points, int numPoints, int32_t* triangles) {
+   ERROR_WRAPPER_BEGIN
+   return context->LocateTriangleMeshPoints(reinterpret_cast<uint64_t>(triangleMeshHandle), points, numPoints, triangles);
+   ERROR_WRAPPER_END
+}
+
+IMPLEMENT_API(FreeTriangleMesh)(OPAQUE_HANDLE triangleMeshHandle) {
+   ERROR_WRAPPER_BEGIN
+   return context->FreeTriangleMesh(reinterpret_cast<uint64_t>(triangleMeshHandle));
+   ERROR_WRAPPER_END
+}
+
+IMPLEMENT_API(LoadSegmentBvh)(const seg2i16* segments, int numSegments, OUT OPAQUE_HANDLE& handle) {
+   ERROR_WRAPPER_BEGIN
+   return context->LoadSegmentBvh(segments, numSegments, OUT reinterpret_cast<uint64_t&>(handle));
+   ERROR_WRAPPER_END
+}
+
+IMPLEMENT_API(QuerySegmentBvhAnyIntersections)(OPAQUE_HANDLE segmentBvhHandle, const seg2i16* queries, int numQueries, uint8_t* results) {
+   ERROR_WRAPPER_BEGIN
+   return context->QuerySegmentBvhAnyIntersections(reinterpret_cast<uint64_t>(segmentBvhHandle), queries, numQueries, results);
+   ERROR_WRAPPER_END
+}
+
+IMPLEMENT_API(FreeSegmentBvh)(OPAQUE_HANDLE segmentBvhHandle) {
+   ERROR_WRAPPER_BEGIN
+   return context->FreeSegmentBvh(reinterpret_cast<uint64_t>(segmentBvhHandle));
+   ERROR_WRAPPER_END
+}
+
+IMPLEMENT_API(LoadLooseGrid)(int originX, int originY, int width, int height, int minCellSize, OUT OPAQUE_HANDLE& handle) {
+   ERROR_WRAPPER_BEGIN
+   return context->LoadLooseGrid(originX, originY, width, height, minCellSize, OUT reinterpret_cast<uint64_t&>(handle));
+   ERROR_WRAPPER_END
+}
+
+IMPLEMENT_API(UpdateLooseGrid)(OPAQUE_HANDLE looseGridHandle, const int32_t* ids, const rect2i32* rects, int numItems) {
+   ERROR_WRAPPER_BEGIN
+   return context->UpdateLooseGrid(reinterpret_cast<uint64_t>(looseGridHandle), ids, rects, numItems);
+   ERROR_WRAPPER_END
+}
+
+IMPLEMENT_API(RemoveLooseGridItems)(OPAQUE_HANDLE looseGridHandle, const int32_t* ids, int numIds) {
+   ERROR_WRAPPER_BEGIN
+   return context->RemoveLooseGridItems(reinterpret_cast<uint64_t>(looseGridHandle), ids, numIds);
+   ERROR_WRAPPER_END
+}
+
+IMPLEMENT_API(QueryLooseGrid)(OPAQUE_HANDLE looseGridHandle, const rect2i32* queries, int numQueries, int* offsets, int32_t* ids, int idCapacity, OUT int& numIds) {
+   ERROR_WRAPPER_BEGIN
+   return context->QueryLooseGrid(reinterpret_cast<uint64_t>(looseGridHandle), queries, numQueries, offsets, ids, idCapacity, OUT numIds);
+   ERROR_WRAPPER_END
+}
+
+IMPLEMENT_API(FreeLooseGrid)(OPAQUE_HANDLE looseGridHandle) {
+   ERROR_WRAPPER_BEGIN
+   return context->FreeLooseGrid(reinterpret_cast<uint64_t>(looseGridHandle));
+   ERROR_WRAPPER_END
+}
+
+IMPLEMENT_API(TriangulatePolygonTree)(const point2i32* points, const int* contourOffsets, const int* contourParents, int numContours, int* contourTriangleOffsets, int32_t* triangleVertices, int32_t* triangleNeighbors, int32_t* neighborSharedEdges, int triangleCapacity, OUT int& numTriangles) {
+   ERROR_WRAPPER_BEGIN
+   PolygonTreeTriangulation triangulation;
+   ::TriangulatePolygonTree(points, contourOffsets, contourParents, numContours, OUT triangulation);
+
+   std::copy(triangulation.ContourTriangleOffsets.begin(), triangulation.ContourTriangleOffsets.end(), contourTriangleOffsets);
+   numTriangles = triangulation.ContourTriangleOffsets[numContours];
+   auto numCopied = 3 * std::min(numTriangles, triangleCapacity);
+   std::copy_n(triangulation.TriangleVertices.begin(), numCopied, triangleVertices);
+   std::copy_n(triangulation.TriangleNeighbors.begin(), numCopied, triangleNeighbors);
+   std::copy_n(triangulation.NeighborSharedEdges.begin(), numCopied, neighborSharedEdges);
+   return numTriangles <= triangleCapacity ? ApiResult::Success : ApiResult::ErrorInsufficientBuffer;
+   ERROR_WRAPPER_END
+}
+
+IMPLEMENT_API(CompileSector)(const point2i32* points, const int* contourOffsets, const int* contourParents, int numContours, const point2i32* portalPoints, const int* portalPointOffsets, int numPortals, int exaggerationFactor, uint8_t* blob, int blobCapacity, OUT int& blobSize) {
+   ERROR_WRAPPER_BEGIN
+   SectorCompilation compilation;
+   ::CompileSector(points, contourOffsets, contourParents, numContours, portalPoints, portalPointOffsets, numPortals, exaggerationFactor, OUT compilation);
+
+   blobSize = ::PackSectorCompilation(compilation, blob, blobCapacity);
+   return blobSize <= blobCapacity ? ApiResult::Success : ApiResult::ErrorInsufficientBuffer;
+   ERROR_WRAPPER_END
+}
+
+IMPLEMENT_API(ComputeSectorPortalDistanceBounds)(const point2i32* portalPoints, const int* portalPointOffsets, int numPortals, const uint64_t* linkVisibleBits, const point2i32* waypoints, int numWaypoints, const float* waypointCosts, const seg2i32* barriers, int numBarriers, distance_bounds* bounds) {
+   ERROR_WRAPPER_BEGIN
+   auto links = ::LoadPortalLinkMatrix(portalPointOffsets, numPortals, linkVisibleBits);
+   ::ComputeSectorPortalDistanceBounds(portalPoints, portalPointOffsets, numPortals, *links, waypoints, numWaypoints, waypointCosts, barriers, numBarriers, bounds);
+   return ApiResult::Success;
+   ERROR_WRAPPER_END
+}
+
+IMPLEMENT_API(FindSectorCorridor)(int numPortals, const int* sectorPortalOffsets, const int* sectorPortals, int numSectors, const distance_bounds* sectorBounds, const int* sourcePortals, const distance_bounds* sourceLinks, int numSourceLinks, const int* destinationPortals, const distance_bounds* destinationLinks, int numDestinationLinks, uint8_t* portalInCorridor, uint8_t* sectorInCorridor, OUT float& upperBound) {
+   ERROR_WRAPPER_BEGIN
+   ::FindSectorCorridor(numPortals, sectorPortalOffsets, sectorPortals, numSectors, sectorBounds, sourcePortals, sourceLinks, numSourceLinks, destinationPortals, destinationLinks, numDestinationLinks, portalInCorridor, sectorInCorridor, OUT upperBound);
+   return ApiResult::Success;
+   ERROR_WRAPPER_END
 }
\ No newline at end of file
@@ -2,10 +2,60 @@
 #include "pch.h"
 
 struct seg2i16;
+struct point2i32;
+struct seg2i32;
+struct point2f64;
+struct seg2f64;
+struct rect2i32;
+struct pair2i32;
+struct dijkstra_seed_s;
+struct distance_bounds_s;
+struct walk_result_s;
 
 extern "C" {
    DECLARE_API(GetVersion)(OUT int& version);
    DECLARE_API(LoadPrequeryAnySegmentIntersections)(const seg2i16* barriers, int numBarriers, OUT OPAQUE_HANDLE& handle);
+   DECLARE_API(LoadPrequeryAnySegmentIntersectionsI32)(const seg2i32* barriers, int numBarriers, OUT OPAQUE_HANDLE& handle);
+   DECLARE_API(LoadPrequeryContourBarrierIntersections)(const point2i32* points, const int* contourOffsets, int numContours, int exaggerationFactor, OUT OPAQUE_HANDLE& handle);
    DECLARE_API(QueryAnySegmentIntersections)(OPAQUE_HANDLE prequeryStateHandle, const seg2i16* queries, int numQueries, uint8_t* results);
    DECLARE_API(FreePrequeryAnySegmentIntersections)(OPAQUE_HANDLE prequeryStateHandle);
+   DECLARE_API(FindAllSegmentIntersections)(const seg2i32* segments, int numSegments, bool detectEndpointContainment, pair2i32* pairs, int pairCapacity, OUT int& numPairs);
+   DECLARE_API(ComputeAllPairsShortestPaths)(const int* offsets, const int* edgeTargets, const float* edgeCosts, int numNodes, float* costs, int32_t* predecessors);
+   DECLARE_API(Dijkstras)(const int* offsets, const int* edgeTargets, const float* edgeCosts, int numNodes, const dijkstra_seed_s* seeds, int numSeeds, const int* terminals, int numTerminals, float* costs, int32_t* predecessors);
+   DECLARE_API(DijkstrasBatch)(const int* offsets, const int* edgeTargets, const float* edgeCosts, int numNodes, const int* sources, int numSources, float* costs, int32_t* predecessors);
+   DECLARE_API(BuildVisibilityGraph)(const point2i32* waypoints, int numWaypoints, const seg2i32* barriers, int numBarriers, int* offsets, int* edgeTargets, float* edgeCosts, int edgeCapacity, OUT int& numEdges);
+   DECLARE_API(BuildVisibilityPolygons)(const point2i32* origins, int numOrigins, const seg2i32* barriers, int numBarriers, int* offsets, int32_t* rangeIds, double* rangeThetaStarts, int rangeCapacity, OUT int& numRanges);
+   DECLARE_API(LoadVisibilityPolygons)(const point2i32* origins, int numOrigins, const seg2i32* barriers, int numBarriers, OUT OPAQUE_HANDLE& handle);
+   DECLARE_API(QueryVisibilityPolygonsContainingPoints)(OPAQUE_HANDLE visibilityPolygonsHandle, const point2f64* points, int numPoints, int* resultOffsets, int32_t* originIndices, float* distances, int resultCapacity, OUT int& numResults);
+   DECLARE_API(QueryVisibilityPolygonsSeeingSegments)(OPAQUE_HANDLE visibilityPolygonsHandle, const seg2f64* segments, int numSegments, uint32_t* seeingOriginBits);
+   DECLARE_API(FreeVisibilityPolygons)(OPAQUE_HANDLE visibilityPolygonsHandle);
+   DECLARE_API(LoadOverlayGraph)(const int* offsets, const int* edgeTargets, const float* edgeCosts, int numVertices, OUT OPAQUE_HANDLE& handle);
+   DECLARE_API(QueryOverlayUniformCostSearch)(OPAQUE_HANDLE overlayGraphHandle, bool followEdgesReversed, const dijkstra_seed_s* seeds, int numSeeds, const dijkstra_seed_s* terminalLinks, int numTerminalLinks, int numDestinations, float* destinationCosts, int* pathOffsets, dijkstra_seed_s* pathLinks, int pathCapacity, OUT int& numPathLinks);
+   DECLARE_API(QueryOverlayPathBatch)(OPAQUE_HANDLE overlayGraphHandle, const dijkstra_seed_s* sourceLinks, int numSourceLinks, int numSources, const dijkstra_seed_s* destinationLinks, int numDestinationLinks, int numDestinations, const pair2i32* queries, int numQueries, float* costs, int* pathOffsets, dijkstra_seed_s* pathLinks, int pathCapacity, OUT int& numPathLinks);
+   DECLARE_API(FreeOverlayGraph)(OPAQUE_HANDLE overlayGraphHandle);
+   DECLARE_API(LoadPortalLinkMatrix)(const int* portalPointOffsets, int numPortals, const uint64_t* linkVisibleBits, OUT OPAQUE_HANDLE& handle);
+   DECLARE_API(QueryPortalLinkVisibleCounts)(OPAQUE_HANDLE portalLinkMatrixHandle, const pair2i32* portalPairs, int numPortalPairs, int* counts);
+   DECLARE_API(QueryPortalLinksVisible)(OPAQUE_HANDLE portalLinkMatrixHandle, int a, int b, pair2i32* links, int linkCapacity, OUT int& numLinks);
+   DECLARE_API(FreePortalLinkMatrix)(OPAQUE_HANDLE portalLinkMatrixHandle);
+   DECLARE_API(LoadSpatialHash)(int originX, int originY, int width, int height, int cellSize, OUT OPAQUE_HANDLE& handle);
+   DECLARE_API(UpdateSpatialHash)(OPAQUE_HANDLE spatialHashHandle, const point2i32* positions, const int32_t* radii, int numEntities);
+   DECLARE_API(QuerySpatialHashNeighbors)(OPAQUE_HANDLE spatialHashHandle, int shape, const int32_t* queryRadii, int numEntities, int* neighborOffsets, int* neighbors, int neighborCapacity, OUT int& numNeighbors);
+   DECLARE_API(FreeSpatialHash)(OPAQUE_HANDLE spatialHashHandle);
+   DECLARE_API(ComputeFlockingForces)(int numEntities, const int32_t* xs, const int32_t* ys, const float* radii, const float* seekXs, const float* seekYs, const float* directSeekXs, const float* directSeekYs, const uint8_t* onGoalTriangle, const float* seekAlignWeights, const int* neighborOffsets, const int* neighbors, float* forceXs, float* forceYs);
+   DECLARE_API(LoadTriangleMesh)(const point2f64* vertices, int numVertices, const int32_t* triangleVertices, const int32_t* triangleNeighbors, const int32_t* neighborSharedEdges, int numTriangles, OUT OPAQUE_HANDLE& handle);
+   DECLARE_API(WalkTriangleMesh)(OPAQUE_HANDLE triangleMeshHandle, const seg2f64* haltSegments, const int32_t* haltClockness, int numHaltSegments, const int32_t* triangles, const point2f64* positions, const point2f64* displacements, int numWalks, walk_result_s* results);
+   DECLARE_API(LocateTriangleMeshPoints)(OPAQUE_HANDLE triangleMeshHandle, const point2f64* points, int numPoints, int32_t* triangles);
+   DECLARE_API(FreeTriangleMesh)(OPAQUE_HANDLE triangleMeshHandle);
+   DECLARE_API(LoadSegmentBvh)(const seg2i16* segments, int numSegments, OUT OPAQUE_HANDLE& handle);
+   DECLARE_API(QuerySegmentBvhAnyIntersections)(OPAQUE_HANDLE segmentBvhHandle, const seg2i16* queries, int numQueries, uint8_t* results);
+   DECLARE_API(FreeSegmentBvh)(OPAQUE_HANDLE segmentBvhHandle);
+   DECLARE_API(LoadLooseGrid)(int originX, int originY, int width, int height, int minCellSize, OUT OPAQUE_HANDLE& handle);
+   DECLARE_API(UpdateLooseGrid)(OPAQUE_HANDLE looseGridHandle, const int32_t* ids, const rect2i32* rects, int numItems);
+   DECLARE_API(RemoveLooseGridItems)(OPAQUE_HANDLE looseGridHandle, const int32_t* ids, int numIds);
+   DECLARE_API(QueryLooseGrid)(OPAQUE_HANDLE looseGridHandle, const rect2i32* queries, int numQueries, int* offsets, int32_t* ids, int idCapacity, OUT int& numIds);
+   DECLARE_API(FreeLooseGrid)(OPAQUE_HANDLE looseGridHandle);
+   DECLARE_API(TriangulatePolygonTree)(const point2i32* points, const int* contourOffsets, const int* contourParents, int numContours, int* contourTriangleOffsets, int32_t* triangleVertices, int32_t* triangleNeighbors, int32_t* neighborSharedEdges, int triangleCapacity, OUT int& numTriangles);
+   DECLARE_API(CompileSector)(const point2i32* points, const int* contourOffsets, const int* contourParents, int numContours, const point2i32* portalPoints, const int* portalPointOffsets, int numPortals, int exaggerationFactor, uint8_t* blob, int blobCapacity, OUT int& blobSize);
+   DECLARE_API(ComputeSectorPortalDistanceBounds)(const point2i32* portalPoints, const int* portalPointOffsets, int numPortals, const uint64_t* linkVisibleBits, const point2i32* waypoints, int numWaypoints, const float* waypointCosts, const seg2i32* barriers, int numBarriers, distance_bounds_s* bounds);
+   DECLARE_API(FindSectorCorridor)(int numPortals, const int* sectorPortalOffsets, const int* sectorPortals, int numSectors, const distance_bounds_s* sectorBounds, const int* sourcePortals, const distance_bounds_s* sourceLinks, int numSourceLinks, const int* destinationPortals, const distance_bounds_s* destinationLinks, int numDestinationLinks, uint8_t* portalInCorridor, uint8_t* sectorInCorridor, OUT float& upperBound);
 }
\ No newline at end of file
@@ -12,6 +12,26 @@ ApiResult ApiContext::LoadPrequeryBarriersIntersectionState(const seg2i16* barri
    return ApiResult::Success;
 }
 
+ApiResult ApiContext::LoadPrequeryBarriersIntersectionState(const seg2i32* barriers, int numBarriers, OUT uint64_t& handle) {
+   auto state = ::LoadPrequeryBarriersIntersectionState(barriers, numBarriers);
+
+   std::lock_guard<std::mutex> lock(sync);
+   handle = this->nextHandle++;
+   this->handleToPrequeryState[handle] = state;
+
+   return ApiResult::Success;
+}
+
+ApiResult ApiContext::LoadContourBarriersIntersectionState(const point2i32* points, const int* contourOffsets, int numContours, int exaggerationFactor, OUT uint64_t& handle) {
+   auto state = ::LoadContourBarriersIntersectionState(points, contourOffsets, numContours, exaggerationFactor);
+
+   std::lock_guard<std::mutex> lock(sync);
+   handle = this->nextHandle++;
+   this->handleToPrequeryState[handle] = state;
+
+   return ApiResult::Success;
+}
+
 ApiResult ApiContext::AnyIntersections(uint64_t prequeryStateHandle, const seg2i16* queries, int numQueries, uint8_t* results) {
    std::unique_lock<std::mutex> lock(sync);
 
@@ -33,3 +53,379 @@ ApiResult ApiContext::FreePrequeryAnySegmentIntersections(uint64_t prequeryState
       ? ApiResult::Success
       : ApiResult::ErrorUnknownHandle;
 }
+
+ApiResult ApiContext::LoadVisibilityPolygonQueryState(const point2i32* origins, int numOrigins, const seg2i32* barriers, int numBarriers, OUT uint64_t& handle) {
+   auto state = ::LoadVisibilityPolygonQueryState(origins, numOrigins, barriers, numBarriers);
+
+   std::lock_guard<std::mutex> lock(sync);
+   handle = this->nextHandle++;
+   this->handleToVisibilityPolygonQueryState[handle] = state;
+
+   return ApiResult::Success;
+}
+
+ApiResult ApiContext::QueryPointSeeingOrigins(uint64_t visibilityPolygonsHandle, const point2f64* points, int numPoints, std::vector<int>& offsets, std::vector<int32_t>& originIndices, std::vector<float>& distances) {
+   std::unique_lock<std::mutex> lock(sync);
+
+   auto it = handleToVisibilityPolygonQueryState.find(visibilityPolygonsHandle);
+   if (it == handleToVisibilityPolygonQueryState.end()) {
+      return ApiResult::ErrorUnknownHandle;
+   }
+
+   auto state = it->second;
+   lock.unlock();
+
+   ::QueryPointSeeingOrigins(state, points, numPoints, offsets, originIndices, distances);
+   return ApiResult::Success;
+}
+
+ApiResult ApiContext::QuerySegmentSeeingOrigins(uint64_t visibilityPolygonsHandle, const seg2f64* segments, int numSegments, uint32_t* seeingOriginBits) {
+   std::unique_lock<std::mutex> lock(sync);
+
+   auto it = handleToVisibilityPolygonQueryState.find(visibilityPolygonsHandle);
+   if (it == handleToVisibilityPolygonQueryState.end()) {
+      return ApiResult::ErrorUnknownHandle;
+   }
+
+   auto state = it->second;
+   lock.unlock();
+
+   ::QuerySegmentSeeingOrigins(state, segments, numSegments, seeingOriginBits);
+   return ApiResult::Success;
+}
+
+ApiResult ApiContext::FreeVisibilityPolygonQueryState(uint64_t visibilityPolygonsHandle) {
+   std::lock_guard<std::mutex> lock(sync);
+   return handleToVisibilityPolygonQueryState.erase(visibilityPolygonsHandle) > 0
+      ? ApiResult::Success
+      : ApiResult::ErrorUnknownHandle;
+}
+
+ApiResult ApiContext::LoadOverlayGraph(const int* offsets, const int* edgeTargets, const float* edgeCosts, int numVertices, OUT uint64_t& handle) {
+   auto graph = ::LoadOverlayGraph(offsets, edgeTargets, edgeCosts, numVertices);
+
+   std::lock_guard<std::mutex> lock(sync);
+   handle = this->nextHandle++;
+   this->handleToOverlayGraph[handle] = graph;
+
+   return ApiResult::Success;
+}
+
+ApiResult ApiContext::UniformCostSearch(uint64_t overlayGraphHandle, bool followEdgesReversed, const dijkstra_seed* seeds, int numSeeds, const dijkstra_seed* terminalLinks, int numTerminalLinks, int numDestinations, float* destinationCosts, int* pathOffsets, std::vector<dijkstra_seed>& pathLinks) {
+   std::unique_lock<std::mutex> lock(sync);
+
+   auto it = handleToOverlayGraph.find(overlayGraphHandle);
+   if (it == handleToOverlayGraph.end()) {
+      return ApiResult::ErrorUnknownHandle;
+   }
+
+   auto graph = it->second;
+   lock.unlock();
+
+   if (numDestinations < 0) return ApiResult::ErrorInvalidArgument;
+   for (auto i = 0; i < numSeeds; i++) {
+      auto current = seeds[i].current;
+      if (!IsOverlayVertex(*graph, current) && !IsOverlayTerminal(current, numDestinations)) {
+         return ApiResult::ErrorInvalidArgument;
+      }
+   }
+   for (auto i = 0; i < numTerminalLinks; i++) {
+      if (!IsOverlayVertex(*graph, terminalLinks[i].prior) || !IsOverlayTerminal(terminalLinks[i].current, numDestinations)) {
+         return ApiResult::ErrorInvalidArgument;
+      }
+   }
+
+   ::UniformCostSearch(*graph, followEdgesReversed, seeds, numSeeds, terminalLinks, numTerminalLinks, numDestinations, destinationCosts, pathOffsets, pathLinks);
+   return ApiResult::Success;
+}
+
+ApiResult ApiContext::BatchPathQueries(uint64_t overlayGraphHandle, const dijkstra_seed* sourceLinks, int numSourceLinks, int numSources, const dijkstra_seed* destinationLinks, int numDestinationLinks, int numDestinations, const pair2i32* queries, int numQueries, float* costs, int* pathOffsets, std::vector<dijkstra_seed>& pathLinks) {
+   std::unique_lock<std::mutex> lock(sync);
+
+   auto it = handleToOverlayGraph.find(overlayGraphHandle);
+   if (it == handleToOverlayGraph.end()) {
+      return ApiResult::ErrorUnknownHandle;
+   }
+
+   auto graph = it->second;
+   lock.unlock();
+
+   if (numSources < 0 || numDestinations < 0) return ApiResult::ErrorInvalidArgument;
+   for (auto i = 0; i < numSourceLinks; i++) {
+      if (!IsOverlayVertex(*graph, sourceLinks[i].prior) || !IsOverlayTerminal(sourceLinks[i].current, numSources)) {
+         return ApiResult::ErrorInvalidArgument;
+      }
+   }
+   for (auto i = 0; i < numDestinationLinks; i++) {
+      if (!IsOverlayVertex(*graph, destinationLinks[i].prior) || !IsOverlayTerminal(destinationLinks[i].current, numDestinations)) {
+         return ApiResult::ErrorInvalidArgument;
+      }
+   }
+   for (auto q = 0; q < numQueries; q++) {
+      if (queries[q].a < 0 || queries[q].a >= numSources || queries[q].b < 0 || queries[q].b >= numDestinations) {
+         return ApiResult::ErrorInvalidArgument;
+      }
+   }
+
+   ::BatchPathQueries(*graph, sourceLinks, numSourceLinks, numSources, destinationLinks, numDestinationLinks, numDestinations, queries, numQueries, costs, pathOffsets, pathLinks);
+   return ApiResult::Success;
+}
+
+ApiResult ApiContext::FreeOverlayGraph(uint64_t overlayGraphHandle) {
+   std::lock_guard<std::mutex> lock(sync);
+   return handleToOverlayGraph.erase(overlayGraphHandle) > 0
+      ? ApiResult::Success
+      : ApiResult::ErrorUnknownHandle;
+}
+
+ApiResult ApiContext::LoadPortalLinkMatrix(const int* portalPointOffsets, int numPortals, const uint64_t* linkVisibleBits, OUT uint64_t& handle) {
+   auto matrix = ::LoadPortalLinkMatrix(portalPointOffsets, numPortals, linkVisibleBits);
+
+   std::lock_guard<std::mutex> lock(sync);
+   handle = this->nextHandle++;
+   this->handleToPortalLinkMatrix[handle] = matrix;
+
+   return ApiResult::Success;
+}
+
+ApiResult ApiContext::CountVisibleLinks(uint64_t portalLinkMatrixHandle, const pair2i32* portalPairs, int numPortalPairs, int* counts) {
+   std::unique_lock<std::mutex> lock(sync);
+
+   auto it = handleToPortalLinkMatrix.find(portalLinkMatrixHandle);
+   if (it == handleToPortalLinkMatrix.end()) {
+      return ApiResult::ErrorUnknownHandle;
+   }
+
+   auto matrix = it->second;
+   lock.unlock();
+
+   for (auto i = 0; i < numPortalPairs; i++) {
+      if (!IsPortalIndex(*matrix, portalPairs[i].a) || !IsPortalIndex(*matrix, portalPairs[i].b)) {
+         return ApiResult::ErrorInvalidArgument;
+      }
+   }
+
+   for (auto i = 0; i < numPortalPairs; i++) {
+      counts[i] = ::CountVisibleLinks(*matrix, portalPairs[i].a, portalPairs[i].b);
+   }
+   return ApiResult::Success;
+}
+
+ApiResult ApiContext::QueryVisibleLinks(uint64_t portalLinkMatrixHandle, int a, int b, std::vector<pair2i32>& links) {
+   std::unique_lock<std::mutex> lock(sync);
+
+   auto it = handleToPortalLinkMatrix.find(portalLinkMatrixHandle);
+   if (it == handleToPortalLinkMatrix.end()) {
+      return ApiResult::ErrorUnknownHandle;
+   }
+
+   auto matrix = it->second;
+   lock.unlock();
+
+   if (!IsPortalIndex(*matrix, a) || !IsPortalIndex(*matrix, b)) {
+      return ApiResult::ErrorInvalidArgument;
+   }
+
+   ::QueryVisibleLinks(*matrix, a, b, links);
+   return ApiResult::Success;
+}
+
+ApiResult ApiContext::FreePortalLinkMatrix(uint64_t portalLinkMatrixHandle) {
+   std::lock_guard<std::mutex> lock(sync);
+   return handleToPortalLinkMatrix.erase(portalLinkMatrixHandle) > 0
+      ? ApiResult::Success
+      : ApiResult::ErrorUnknownHandle;
+}
+
+ApiResult ApiContext::LoadSpatialHash(int originX, int originY, int width, int height, int cellSize, OUT uint64_t& handle) {
+   auto hash = ::LoadSpatialHash(originX, originY, width, height, cellSize);
+
+   std::lock_guard<std::mutex> lock(sync);
+   handle = this->nextHandle++;
+   this->handleToSpatialHash[handle] = hash;
+
+   return ApiResult::Success;
+}
+
+ApiResult ApiContext::UpdateSpatialHash(uint64_t spatialHashHandle, const point2i32* positions, const int32_t* radii, int numEntities) {
+   std::unique_lock<std::mutex> lock(sync);
+
+   auto it = handleToSpatialHash.find(spatialHashHandle);
+   if (it == handleToSpatialHash.end()) {
+      return ApiResult::ErrorUnknownHandle;
+   }
+
+   auto hash = it->second;
+   lock.unlock();
+
+   ::UpdateSpatialHash(*hash, positions, radii, numEntities);
+   return ApiResult::Success;
+}
+
+ApiResult ApiContext::QuerySpatialHashNeighbors(uint64_t spatialHashHandle, NeighborhoodShape shape, const int32_t* queryRadii, int numEntities, std::vector<int>& offsets, std::vector<int>& neighbors) {
+   std::unique_lock<std::mutex> lock(sync);
+
+   auto it = handleToSpatialHash.find(spatialHashHandle);
+   if (it == handleToSpatialHash.end()) {
+      return ApiResult::ErrorUnknownHandle;
+   }
+
+   auto hash = it->second;
+   lock.unlock();
+
+   // queryRadii has one entry per entity in the hash.
+   if (numEntities != static_cast<int>(hash->EntityIndices.size())) {
+      return ApiResult::ErrorInvalidArgument;
+   }
+
+   ::QuerySpatialHashNeighbors(*hash, shape, queryRadii, offsets, neighbors);
+   return ApiResult::Success;
+}
+
+ApiResult ApiContext::FreeSpatialHash(uint64_t spatialHashHandle) {
+   std::lock_guard<std::mutex> lock(sync);
+   return handleToSpatialHash.erase(spatialHashHandle) > 0
+      ? ApiResult::Success
+      : ApiResult::ErrorUnknownHandle;
+}
+
+ApiResult ApiContext::LoadTriangleMesh(const point2f64* vertices, int numVertices, const int32_t* triangleVertices, const int32_t* triangleNeighbors, const int32_t* neighborSharedEdges, int numTriangles, OUT uint64_t& handle) {
+   auto mesh = ::LoadTriangleMesh(vertices, numVertices, triangleVertices, triangleNeighbors, neighborSharedEdges, numTriangles);
+
+   std::lock_guard<std::mutex> lock(sync);
+   handle = this->nextHandle++;
+   this->handleToTriangleMesh[handle] = mesh;
+
+   return ApiResult::Success;
+}
+
+ApiResult ApiContext::WalkTriangleMesh(uint64_t triangleMeshHandle, const seg2f64* haltSegments, const int32_t* haltClockness, int numHaltSegments, const int32_t* triangles, const point2f64* positions, const point2f64* displacements, int numWalks, walk_result* results) {
+   std::unique_lock<std::mutex> lock(sync);
+
+   auto it = handleToTriangleMesh.find(triangleMeshHandle);
+   if (it == handleToTriangleMesh.end()) {
+      return ApiResult::ErrorUnknownHandle;
+   }
+
+   auto mesh = it->second;
+   lock.unlock();
+
+   ::WalkTriangleMesh(*mesh, haltSegments, haltClockness, numHaltSegments, triangles, positions, displacements, numWalks, results);
+   return ApiResult::Success;
+}
+
+ApiResult ApiContext::LocateTriangleMeshPoints(uint64_t triangleMeshHandle, const point2f64* points, int numPoints, int32_t* triangles) {
+   std::unique_lock<std::mutex> lock(sync);
+
+   auto it = handleToTriangleMesh.find(triangleMeshHandle);
+   if (it == handleToTriangleMesh.end()) {
+      return ApiResult::ErrorUnknownHandle;
+   }
+
+   auto mesh = it->second;
+   lock.unlock();
+
+   ::LocateTriangles(*mesh, points, numPoints, triangles);
+   return ApiResult::Success;
+}
+
+ApiResult ApiContext::FreeTriangleMesh(uint64_t triangleMeshHandle) {
+   std::lock_guard<std::mutex> lock(sync);
+   return handleToTriangleMesh.erase(triangleMeshHandle) > 0
+      ? ApiResult::Success
+      : ApiResult::ErrorUnknownHandle;
+}
+
+ApiResult ApiContext::LoadSegmentBvh(const seg2i16* segments, int numSegments, OUT uint64_t& handle) {
+   auto bvh = ::LoadSegmentBvh(segments, numSegments);
+
+   std::lock_guard<std::mutex> lock(sync);
+   handle = this->nextHandle++;
+   this->handleToSegmentBvh[handle] = bvh;
+
+   return ApiResult::Success;
+}
+
+ApiResult ApiContext::QuerySegmentBvhAnyIntersections(uint64_t segmentBvhHandle, const seg2i16* queries, int numQueries, uint8_t* results) {
+   std::unique_lock<std::mutex> lock(sync);
+
+   auto it = handleToSegmentBvh.find(segmentBvhHandle);
+   if (it == handleToSegmentBvh.end()) {
+      return ApiResult::ErrorUnknownHandle;
+   }
+
+   auto bvh = it->second;
+   lock.unlock();
+
+   ::QuerySegmentBvhAnyIntersections(*bvh, queries, numQueries, results);
+   return ApiResult::Success;
+}
+
+ApiResult ApiContext::FreeSegmentBvh(uint64_t segmentBvhHandle) {
+   std::lock_guard<std::mutex> lock(sync);
+   return handleToSegmentBvh.erase(segmentBvhHandle) > 0
+      ? ApiResult::Success
+      : ApiResult::ErrorUnknownHandle;
+}
+
+ApiResult ApiContext::LoadLooseGrid(int originX, int originY, int width, int height, int minCellSize, OUT uint64_t& handle) {
+   auto grid = ::LoadLooseGrid(originX, originY, width, height, minCellSize);
+
+   std::lock_guard<std::mutex> lock(sync);
+   handle = this->nextHandle++;
+   this->handleToLooseGrid[handle] = grid;
+
+   return ApiResult::Success;
+}
+
+ApiResult ApiContext::UpdateLooseGrid(uint64_t looseGridHandle, const int32_t* ids, const rect2i32* rects, int numItems) {
+   std::unique_lock<std::mutex> lock(sync);
+
+   auto it = handleToLooseGrid.find(looseGridHandle);
+   if (it == handleToLooseGrid.end()) {
+      return ApiResult::ErrorUnknownHandle;
+   }
+
+   auto grid = it->second;
+   lock.unlock();
+
+   ::UpdateLooseGrid(*grid, ids, rects, numItems);
+   return ApiResult::Success;
+}
+
+ApiResult ApiContext::RemoveLooseGridItems(uint64_t looseGridHandle, const int32_t* ids, int numIds) {
+   std::unique_lock<std::mutex> lock(sync);
+
+   auto it = handleToLooseGrid.find(looseGridHandle);
+   if (it == handleToLooseGrid.end()) {
+      return ApiResult::ErrorUnknownHandle;
+   }
+
+   auto grid = it->second;
+   lock.unlock();
+
+   ::RemoveLooseGridItems(*grid, ids, numIds);
+   return ApiResult::Success;
+}
+
+ApiResult ApiContext::QueryLooseGrid(uint64_t looseGridHandle, const rect2i32* queries, int numQueries, int* offsets, int32_t* ids, int idCapacity, OUT int& numIds) {
+   std::unique_lock<std::mutex> lock(sync);
+
+   auto it = handleToLooseGrid.find(looseGridHandle);
+   if (it == handleToLooseGrid.end()) {
+      return ApiResult::ErrorUnknownHandle;
+   }
+
+   auto grid = it->second;
+   lock.unlock();
+
+   numIds = ::QueryLooseGrid(*grid, queries, numQueries, offsets, ids, idCapacity);
+   return numIds <= idCapacity ? ApiResult::Success : ApiResult::ErrorInsufficientBuffer;
+}
+
+ApiResult ApiContext::FreeLooseGrid(uint64_t looseGridHandle) {
+   std::lock_guard<std::mutex> lock(sync);
+   return handleToLooseGrid.erase(looseGridHandle) > 0
+      ? ApiResult::Success
+      : ApiResult::ErrorUnknownHandle;
+}
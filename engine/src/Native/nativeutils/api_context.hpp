@@ -2,17 +2,70 @@
 
 #include "pch.h"
 #include <unordered_map>
+#include "barrier_calculator.hpp"
 #include "dllmain.hpp"
+#include "loose_grid.hpp"
+#include "overlay_search.hpp"
+#include "portal_link_matrix.hpp"
+#include "segment_bvh.hpp"
+#include "spatial_hash.hpp"
+#include "triangle_locator.hpp"
+#include "triangulation_walker.hpp"
+#include "visibility_polygon_queries.hpp"
 
 struct seg2i16;
 
 class ApiContext {
    std::mutex sync;
    std::unordered_map<uint64_t, std::shared_ptr<Avx2IntersectionPrequeryState>> handleToPrequeryState;
+   std::unordered_map<uint64_t, std::shared_ptr<VisibilityPolygonQueryState>> handleToVisibilityPolygonQueryState;
+   std::unordered_map<uint64_t, std::shared_ptr<OverlayGraph>> handleToOverlayGraph;
+   std::unordered_map<uint64_t, std::shared_ptr<PortalLinkMatrix>> handleToPortalLinkMatrix;
+   std::unordered_map<uint64_t, std::shared_ptr<SpatialHash>> handleToSpatialHash;
+   std::unordered_map<uint64_t, std::shared_ptr<TriangleMesh>> handleToTriangleMesh;
+   std::unordered_map<uint64_t, std::shared_ptr<SegmentBvh>> handleToSegmentBvh;
+   std::unordered_map<uint64_t, std::shared_ptr<LooseGrid>> handleToLooseGrid;
    uint64_t nextHandle = 1;
 
 public:
    ApiResult LoadPrequeryBarriersIntersectionState(const seg2i16* barriers, int numBarriers, OUT uint64_t& handle);
+   ApiResult LoadPrequeryBarriersIntersectionState(const seg2i32* barriers, int numBarriers, OUT uint64_t& handle);
+   ApiResult LoadContourBarriersIntersectionState(const point2i32* points, const int* contourOffsets, int numContours, int exaggerationFactor, OUT uint64_t& handle);
    ApiResult AnyIntersections(uint64_t prequeryStateHandle, const seg2i16* queries, int numQueries, uint8_t* results);
    ApiResult FreePrequeryAnySegmentIntersections(uint64_t prequeryStateHandle);
+
+   ApiResult LoadVisibilityPolygonQueryState(const point2i32* origins, int numOrigins, const seg2i32* barriers, int numBarriers, OUT uint64_t& handle);
+   ApiResult QueryPointSeeingOrigins(uint64_t visibilityPolygonsHandle, const point2f64* points, int numPoints, std::vector<int>& offsets, std::vector<int32_t>& originIndices, std::vector<float>& distances);
+   ApiResult QuerySegmentSeeingOrigins(uint64_t visibilityPolygonsHandle, const seg2f64* segments, int numSegments, uint32_t* seeingOriginBits);
+   ApiResult FreeVisibilityPolygonQueryState(uint64_t visibilityPolygonsHandle);
+
+   ApiResult LoadOverlayGraph(const int* offsets, const int* edgeTargets, const float* edgeCosts, int numVertices, OUT uint64_t& handle);
+   ApiResult UniformCostSearch(uint64_t overlayGraphHandle, bool followEdgesReversed, const dijkstra_seed* seeds, int numSeeds, const dijkstra_seed* terminalLinks, int numTerminalLinks, int numDestinations, float* destinationCosts, int* pathOffsets, std::vector<dijkstra_seed>& pathLinks);
+   ApiResult BatchPathQueries(uint64_t overlayGraphHandle, const dijkstra_seed* sourceLinks, int numSourceLinks, int numSources, const dijkstra_seed* destinationLinks, int numDestinationLinks, int numDestinations, const pair2i32* queries, int numQueries, float* costs, int* pathOffsets, std::vector<dijkstra_seed>& pathLinks);
+   ApiResult FreeOverlayGraph(uint64_t overlayGraphHandle);
+
+   ApiResult LoadPortalLinkMatrix(const int* portalPointOffsets, int numPortals, const uint64_t* linkVisibleBits, OUT uint64_t& handle);
+   ApiResult CountVisibleLinks(uint64_t portalLinkMatrixHandle, const pair2i32* portalPairs, int numPortalPairs, int* counts);
+   ApiResult QueryVisibleLinks(uint64_t portalLinkMatrixHandle, int a, int b, std::vector<pair2i32>& links);
+   ApiResult FreePortalLinkMatrix(uint64_t portalLinkMatrixHandle);
+
+   ApiResult LoadSpatialHash(int originX, int originY, int width, int height, int cellSize, OUT uint64_t& handle);
+   ApiResult UpdateSpatialHash(uint64_t spatialHashHandle, const point2i32* positions, const int32_t* radii, int numEntities);
+   ApiResult QuerySpatialHashNeighbors(uint64_t spatialHashHandle, NeighborhoodShape shape, const int32_t* queryRadii, int numEntities, std::vector<int>& offsets, std::vector<int>& neighbors);
+   ApiResult FreeSpatialHash(uint64_t spatialHashHandle);
+
+   ApiResult LoadTriangleMesh(const point2f64* vertices, int numVertices, const int32_t* triangleVertices, const int32_t* triangleNeighbors, const int32_t* neighborSharedEdges, int numTriangles, OUT uint64_t& handle);
+   ApiResult WalkTriangleMesh(uint64_t triangleMeshHandle, const seg2f64* haltSegments, const int32_t* haltClockness, int numHaltSegments, const int32_t* triangles, const point2f64* positions, const point2f64* displacements, int numWalks, walk_result* results);
+   ApiResult LocateTriangleMeshPoints(uint64_t triangleMeshHandle, const point2f64* points, int numPoints, int32_t* triangles);
+   ApiResult FreeTriangleMesh(uint64_t triangleMeshHandle);
+
+   ApiResult LoadSegmentBvh(const seg2i16* segments, int numSegments, OUT uint64_t& handle);
+   ApiResult QuerySegmentBvhAnyIntersections(uint64_t segmentBvhHandle, const seg2i16* queries, int numQueries, uint8_t* results);
+   ApiResult FreeSegmentBvh(uint64_t segmentBvhHandle);
+
+   ApiResult LoadLooseGrid(int originX, int originY, int width, int height, int minCellSize, OUT uint64_t& handle);
+   ApiResult UpdateLooseGrid(uint64_t looseGridHandle, const int32_t* ids, const rect2i32* rects, int numItems);
+   ApiResult RemoveLooseGridItems(uint64_t looseGridHandle, const int32_t* ids, int numIds);
+   ApiResult QueryLooseGrid(uint64_t looseGridHandle, const rect2i32* queries, int numQueries, int* offsets, int32_t* ids, int idCapacity, OUT int& numIds);
+   ApiResult FreeLooseGrid(uint64_t looseGridHandle);
 };
@@ -0,0 +1,56 @@
+#include "pch.h"
+#include "barrier_calculator.hpp"
+
+namespace {
+   // Calls emit(barrier) for each contour edge's barrier, contours in order.
+   template <typename Emit>
+   FORCEINLINE void ForEachContourBarrier(const point2i32* points, const int* contourOffsets, int numContours, int exaggerationFactor, const Emit& emit) {
+      for (auto c = 0; c < numContours; c++) {
+         auto begin = contourOffsets[c];
+         auto pointCount = contourOffsets[c + 1] - begin;
+         for (auto i = 0; i < pointCount; i++) {
+            auto a = points[begin + i];
+            auto b = points[begin + (i + 1) % pointCount];
+
+            auto dx = b.x - a.x;
+            auto dy = b.y - a.y;
+            auto mag = static_cast<int32_t>(std::sqrt(static_cast<double>(dx * dx + dy * dy)));
+            if (mag == 0) continue;
+
+            // Same integer ops in the same order as managed, so rounding matches. Holes are wound
+            // opposite land, so one dilation direction pushes both out of their node.
+            auto dilateOffsetX = exaggerationFactor * dy * kBarrierPolyTreeDilationFactor / mag;
+            auto dilateOffsetY = exaggerationFactor * -dx * kBarrierPolyTreeDilationFactor / mag;
+            auto expandOffsetX = exaggerationFactor * dx * kBarrierSegmentExpansionFactor / mag;
+            auto expandOffsetY = exaggerationFactor * dy * kBarrierSegmentExpansionFactor / mag;
+
+            seg2i32 barrier;
+            barrier.x1 = a.x - expandOffsetX + dilateOffsetX;
+            barrier.y1 = a.y - expandOffsetY + dilateOffsetY;
+            barrier.x2 = b.x + expandOffsetX + dilateOffsetX;
+            barrier.y2 = b.y + expandOffsetY + dilateOffsetY;
+            emit(barrier);
+         }
+      }
+   }
+}
+
+void CalculateContourBarriers(const point2i32* points, const int* contourOffsets, int numContours, int exaggerationFactor, OUT std::vector<seg2i32>& barriers) {
+   barriers.clear();
+   ForEachContourBarrier(points, contourOffsets, numContours, exaggerationFactor, [&](const seg2i32& barrier) {
+      barriers.push_back(barrier);
+   });
+}
+
+std::shared_ptr<Avx2IntersectionPrequeryState> LoadContourBarriersIntersectionState(const point2i32* points, const int* contourOffsets, int numContours, int exaggerationFactor) {
+   // At most one barrier per point; degenerate edges just leave the tail unused.
+   auto maxBarriers = contourOffsets[numContours] - contourOffsets[0];
+   auto state = AllocatePrequeryBarriersIntersectionState(maxBarriers);
+
+   auto numBarriers = 0;
+   ForEachContourBarrier(points, contourOffsets, numContours, exaggerationFactor, [&](const seg2i32& barrier) {
+      StorePrequeryBarrier(*state, numBarriers++, static_cast<short>(barrier.x1), static_cast<short>(barrier.y1), static_cast<short>(barrier.x2), static_cast<short>(barrier.y2));
+   });
+   SetPrequeryBarrierCount(*state, numBarriers);
+   return state;
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "geometry.hpp"
+#include "dllmain.hpp"
+
+// Managed BarrierCalculator: each contour edge is pushed 5 units out of its node and stretched
+// 10 units past both ends (times the exaggeration factor) so neighboring barriers cross.
+constexpr int kBarrierPolyTreeDilationFactor = 5;
+constexpr int kBarrierSegmentExpansionFactor = 10;
+
+// BarrierCalculator.CalculateContourAndChildHoleBarriers over a flattened polygon tree
+// (TriangulatePolygonTree's format), contours in order. Zero-length edges, which the managed
+// version divides by zero on, are skipped.
+void CalculateContourBarriers(const point2i32* points, const int* contourOffsets, int numContours, int exaggerationFactor, OUT std::vector<seg2i32>& barriers);
+
+// The same barriers packed straight into a prequery state's chunks, truncated to int16 as
+// managed LoadPrequeryAnySegmentIntersections does.
+std::shared_ptr<Avx2IntersectionPrequeryState> LoadContourBarriersIntersectionState(const point2i32* points, const int* contourOffsets, int numContours, int exaggerationFactor);
@@ -0,0 +1,652 @@
+#include "pch.h"
+#include "constrained_delaunay.hpp"
+#include "parallel.hpp"
+
+#include <deque>
+#include <stdexcept>
+
+namespace {
+   constexpr int kNumSuperVertices = 3;
+
+   // Caps on the walks and flip loops below. Valid input never comes close; crossing contours
+   // could otherwise cycle.
+   constexpr int kMaxStepsPerVertex = 1 << 20;
+
+   // Relative error bound on the double incircle determinant (Shewchuk's iccerrboundA, rounded up).
+   constexpr double kInCircleErrorBound = 1.2E-15;
+
+   // Signed 128-bit two's complement, just enough for an exact incircle determinant.
+   struct int128 {
+      uint64_t lo;
+      uint64_t hi;
+   };
+
+   FORCEINLINE int128 Multiply(int64_t a, int64_t b) {
+      auto ua = static_cast<uint64_t>(a < 0 ? -a : a);
+      auto ub = static_cast<uint64_t>(b < 0 ? -b : b);
+      auto a0 = ua & 0xFFFFFFFF, a1 = ua >> 32;
+      auto b0 = ub & 0xFFFFFFFF, b1 = ub >> 32;
+      auto p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0, p11 = a1 * b1;
+      auto mid = (p00 >> 32) + (p01 & 0xFFFFFFFF) + (p10 & 0xFFFFFFFF);
+
+      int128 res;
+      res.lo = (p00 & 0xFFFFFFFF) | (mid << 32);
+      res.hi = p11 + (p01 >> 32) + (p10 >> 32) + (mid >> 32);
+      if ((a < 0) != (b < 0)) {
+         res.lo = ~res.lo + 1;
+         res.hi = ~res.hi + (res.lo == 0);
+      }
+      return res;
+   }
+
+   FORCEINLINE int128 Add(int128 a, int128 b) {
+      int128 res;
+      res.lo = a.lo + b.lo;
+      res.hi = a.hi + b.hi + (res.lo < a.lo);
+      return res;
+   }
+
+   FORCEINLINE int Sign(int128 v) {
+      return static_cast<int64_t>(v.hi) < 0 ? -1 : ((v.hi | v.lo) != 0 ? 1 : 0);
+   }
+
+   // Position along a 2^16 x 2^16 Hilbert curve; inserting in this order keeps point location
+   // walks short.
+   FORCEINLINE uint32_t HilbertIndex(uint32_t x, uint32_t y) {
+      constexpr uint32_t n = 1u << 16;
+      uint32_t d = 0;
+      for (auto s = n >> 1; s > 0; s >>= 1) {
+         uint32_t rx = (x & s) != 0;
+         uint32_t ry = (y & s) != 0;
+         d += s * s * ((3 * rx) ^ ry);
+         if (ry == 0) {
+            if (rx == 1) {
+               x = n - 1 - x;
+               y = n - 1 - y;
+            }
+            std::swap(x, y);
+         }
+      }
+      return d;
+   }
+
+   FORCEINLINE int Next(int corner) { return corner == 2 ? 0 : corner + 1; }
+   FORCEINLINE int Prev(int corner) { return corner == 0 ? 2 : corner - 1; }
+
+   // Incremental Delaunay triangulation inside a super triangle, then constraint edges forced in
+   // by flipping (Sloan) and Delaunay restored around them by Lawson flips. Triangle t's corners
+   // are Vertices [3t, 3t + 3), counterclockwise; Neighbors and Constrained describe the edge
+   // opposite each corner, Constrained counting the contour edges lying on it. All predicates are
+   // exact integer arithmetic.
+   class CdtBuilder {
+   public:
+      std::vector<int64_t> Xs, Ys;
+      std::vector<int32_t> Vertices, Neighbors;
+      std::vector<uint8_t> Constrained;
+      std::vector<int32_t> VertexTriangles;
+
+      CdtBuilder(std::vector<int64_t> xs, std::vector<int64_t> ys) : Xs(std::move(xs)), Ys(std::move(ys)) {
+         VertexTriangles.assign(Xs.size(), -1);
+         AddTriangle();
+         SetTriangle(0, 0, 1, 2, -1, -1, -1, 0, 0, 0);
+      }
+
+      // Inserts vertex v, which must lie strictly inside the super triangle and not on another
+      // vertex. Returns false if the location walk doesn't terminate.
+      bool InsertVertex(int v, OUT int& hint) {
+         auto t = hint;
+         auto rotation = 0;
+         for (auto steps = 0; ; steps++) {
+            if (steps == kMaxStepsPerVertex) return false;
+
+            auto next = -1;
+            for (auto k = 0; k < 3 && next < 0; k++) {
+               auto i = (k + rotation) % 3;
+               if (Orient(V(t, Next(i)), V(t, Prev(i)), v) < 0) next = N(t, i);
+            }
+            rotation = rotation == 2 ? 0 : rotation + 1;
+            if (next < 0) break;
+            t = next;
+         }
+
+         auto onEdge = -1;
+         for (auto i = 0; i < 3; i++) {
+            if (Orient(V(t, Next(i)), V(t, Prev(i)), v) == 0) onEdge = i;
+         }
+
+         stack.clear();
+         if (onEdge < 0) {
+            SplitTriangle(t, v);
+         } else {
+            SplitEdge(t, onEdge, v);
+         }
+
+         while (!stack.empty()) {
+            auto e = stack.back();
+            stack.pop_back();
+            LegalizeCorner(e.a, e.b);
+         }
+
+         hint = VertexTriangles[v];
+         return true;
+      }
+
+      // Forces edge a-b into the triangulation, splitting it at any vertex it passes through.
+      // Returns false if it crosses an already constrained edge.
+      bool InsertConstraint(int a, int b) {
+         while (a != b) {
+            int t, i;
+            if (FindEdge(a, b, OUT t, OUT i)) {
+               MarkConstrained(t, i);
+               return true;
+            }
+
+            // The triangle around a whose wedge the segment leaves through.
+            auto start = -1, startCorner = -1, through = -1;
+            if (!ForEachAround(a, [&](int u, int k) {
+               auto p = V(u, Next(k)), q = V(u, Prev(k));
+               auto op = Orient(a, p, b), oq = Orient(a, b, q);
+               if (op == 0 && Dot(a, p, b) > 0) {
+                  through = p;
+                  return true;
+               }
+               if (oq == 0 && Dot(a, q, b) > 0) {
+                  through = q;
+                  return true;
+               }
+               if (op > 0 && oq > 0) {
+                  start = u;
+                  startCorner = k;
+                  return true;
+               }
+               return false;
+            })) {
+               return false;
+            }
+
+            if (through >= 0) {
+               FindEdge(a, through, OUT t, OUT i);
+               MarkConstrained(t, i);
+               a = through;
+               continue;
+            }
+
+            // Walk to b collecting the edges crossed, stopping early at a vertex on the segment.
+            crossings.clear();
+            auto right = V(start, Next(startCorner)), left = V(start, Prev(startCorner));
+            auto u = start, corner = startCorner;
+            auto end = -1;
+            for (auto steps = 0; end < 0; steps++) {
+               if (steps == kMaxStepsPerVertex || C(u, corner)) return false;
+               crossings.push_back({ right, left });
+
+               auto next = N(u, corner);
+               auto d = V(next, NeighborCorner(u, corner));
+               auto o = d == b ? 0 : Orient(a, b, d);
+               if (o == 0) {
+                  end = d;
+               } else if (o > 0) {
+                  corner = CornerOf(next, left);
+                  left = d;
+               } else {
+                  corner = CornerOf(next, right);
+                  right = d;
+               }
+               u = next;
+            }
+
+            if (!ForceEdge(a, end)) return false;
+            a = end;
+         }
+         return true;
+      }
+
+      // Depth of each triangle counted in contour edges crossed from the super triangle's corner;
+      // odd depth is land. An edge shared by several contours (a hole edge on its land contour's)
+      // counts once per contour, so parity stays right across it.
+      std::vector<int> ComputeDepths() const {
+         auto numTriangles = static_cast<int>(Vertices.size() / 3);
+         std::vector<int> depths(numTriangles, -1);
+         std::vector<std::vector<int>> buckets(1);
+         buckets[0].push_back(VertexTriangles[0]);
+         depths[buckets[0][0]] = 0;
+         for (auto depth = 0; depth < static_cast<int>(buckets.size()); depth++) {
+            while (!buckets[depth].empty()) {
+               auto t = buckets[depth].back();
+               buckets[depth].pop_back();
+               if (depths[t] != depth) continue;
+               for (auto i = 0; i < 3; i++) {
+                  auto n = N(t, i);
+                  if (n < 0) continue;
+                  auto d = depth + Constrained[3 * t + i];
+                  if (depths[n] >= 0 && depths[n] <= d) continue;
+                  depths[n] = d;
+                  if (d >= static_cast<int>(buckets.size())) buckets.resize(d + 1);
+                  buckets[d].push_back(n);
+               }
+            }
+         }
+         return depths;
+      }
+
+      FORCEINLINE int V(int t, int corner) const { return Vertices[3 * t + corner]; }
+      FORCEINLINE int N(int t, int corner) const { return Neighbors[3 * t + corner]; }
+      FORCEINLINE bool C(int t, int corner) const { return Constrained[3 * t + corner] != 0; }
+
+      // Corner of t's neighbor across the edge opposite corner i that is opposite that edge.
+      FORCEINLINE int NeighborCorner(int t, int i) const {
+         auto n = N(t, i);
+         return N(n, 0) == t ? 0 : N(n, 1) == t ? 1 : 2;
+      }
+
+   private:
+      std::vector<pair2i32> stack;
+      std::vector<pair2i32> crossings;
+      std::deque<pair2i32> queue;
+
+      FORCEINLINE int64_t Orient(int a, int b, int c) const {
+         return (Xs[b] - Xs[a]) * (Ys[c] - Ys[a]) - (Ys[b] - Ys[a]) * (Xs[c] - Xs[a]);
+      }
+
+      FORCEINLINE int64_t Dot(int a, int b, int c) const {
+         return (Xs[b] - Xs[a]) * (Xs[c] - Xs[a]) + (Ys[b] - Ys[a]) * (Ys[c] - Ys[a]);
+      }
+
+      // > 0 if d is strictly inside the circumcircle of counterclockwise a, b, c. Decided in
+      // doubles when the error bound allows, which is nearly always.
+      int InCircle(int a, int b, int c, int d) const {
+         auto adx = Xs[a] - Xs[d], ady = Ys[a] - Ys[d];
+         auto bdx = Xs[b] - Xs[d], bdy = Ys[b] - Ys[d];
+         auto cdx = Xs[c] - Xs[d], cdy = Ys[c] - Ys[d];
+
+         auto fadx = static_cast<double>(adx), fady = static_cast<double>(ady);
+         auto fbdx = static_cast<double>(bdx), fbdy = static_cast<double>(bdy);
+         auto fcdx = static_cast<double>(cdx), fcdy = static_cast<double>(cdy);
+         auto fbc = fbdx * fcdy - fcdx * fbdy, fca = fcdx * fady - fadx * fcdy, fab = fadx * fbdy - fbdx * fady;
+         auto falift = fadx * fadx + fady * fady;
+         auto fblift = fbdx * fbdx + fbdy * fbdy;
+         auto fclift = fcdx * fcdx + fcdy * fcdy;
+         auto fdet = falift * fbc + fblift * fca + fclift * fab;
+         auto permanent =
+            falift * (std::abs(fbdx * fcdy) + std::abs(fcdx * fbdy)) +
+            fblift * (std::abs(fcdx * fady) + std::abs(fadx * fcdy)) +
+            fclift * (std::abs(fadx * fbdy) + std::abs(fbdx * fady));
+         if (std::abs(fdet) > kInCircleErrorBound * permanent) {
+            return fdet > 0 ? 1 : -1;
+         }
+
+         auto alift = adx * adx + ady * ady;
+         auto blift = bdx * bdx + bdy * bdy;
+         auto clift = cdx * cdx + cdy * cdy;
+         auto det = Add(Add(
+            Multiply(alift, bdx * cdy - cdx * bdy),
+            Multiply(blift, cdx * ady - adx * cdy)),
+            Multiply(clift, adx * bdy - bdx * ady));
+         return Sign(det);
+      }
+
+      FORCEINLINE int CornerOf(int t, int v) const {
+         return V(t, 0) == v ? 0 : V(t, 1) == v ? 1 : 2;
+      }
+
+      int AddTriangle() {
+         auto t = static_cast<int>(Vertices.size() / 3);
+         Vertices.resize(Vertices.size() + 3);
+         Neighbors.resize(Neighbors.size() + 3);
+         Constrained.resize(Constrained.size() + 3);
+         return t;
+      }
+
+      void SetTriangle(int t, int v0, int v1, int v2, int n0, int n1, int n2, uint8_t c0, uint8_t c1, uint8_t c2) {
+         Vertices[3 * t + 0] = v0;
+         Vertices[3 * t + 1] = v1;
+         Vertices[3 * t + 2] = v2;
+         Neighbors[3 * t + 0] = n0;
+         Neighbors[3 * t + 1] = n1;
+         Neighbors[3 * t + 2] = n2;
+         Constrained[3 * t + 0] = c0;
+         Constrained[3 * t + 1] = c1;
+         Constrained[3 * t + 2] = c2;
+         VertexTriangles[v0] = VertexTriangles[v1] = VertexTriangles[v2] = t;
+      }
+
+      void ReplaceNeighbor(int t, int from, int to) {
+         if (t < 0) return;
+         for (auto i = 0; i < 3; i++) {
+            if (Neighbors[3 * t + i] == from) Neighbors[3 * t + i] = to;
+         }
+      }
+
+      // Calls visit(t, corner) for the triangles around v until it returns true; false if none did.
+      template <typename Visit>
+      bool ForEachAround(int v, const Visit& visit) const {
+         auto first = VertexTriangles[v];
+         auto t = first;
+         do {
+            auto k = CornerOf(t, v);
+            if (visit(t, k)) return true;
+            t = N(t, Next(k));
+         } while (t >= 0 && t != first);
+         if (t == first) return false;
+
+         // Hit the hull: sweep the other way from the start.
+         t = N(first, Prev(CornerOf(first, v)));
+         while (t >= 0) {
+            auto k = CornerOf(t, v);
+            if (visit(t, k)) return true;
+            t = N(t, Prev(k));
+         }
+         return false;
+      }
+
+      // Triangle t and corner i opposite edge a-b, if it exists.
+      bool FindEdge(int a, int b, OUT int& t, OUT int& i) const {
+         return ForEachAround(a, [&](int u, int k) {
+            if (V(u, Next(k)) == b) {
+               t = u;
+               i = Prev(k);
+               return true;
+            }
+            if (V(u, Prev(k)) == b) {
+               t = u;
+               i = Next(k);
+               return true;
+            }
+            return false;
+         });
+      }
+
+      void MarkConstrained(int t, int i) {
+         Constrained[3 * t + i]++;
+         auto n = N(t, i);
+         if (n >= 0) Constrained[3 * n + NeighborCorner(t, i)]++;
+      }
+
+      // a, b, c -> (a, b, v), (b, c, v), (c, a, v).
+      void SplitTriangle(int t, int v) {
+         auto a = V(t, 0), b = V(t, 1), c = V(t, 2);
+         auto na = N(t, 0), nb = N(t, 1), nc = N(t, 2);
+         auto ca = Constrained[3 * t + 0], cb = Constrained[3 * t + 1], cc = Constrained[3 * t + 2];
+         auto t1 = AddTriangle(), t2 = AddTriangle();
+         SetTriangle(t, a, b, v, t1, t2, nc, 0, 0, cc);
+         SetTriangle(t1, b, c, v, t2, t, na, 0, 0, ca);
+         SetTriangle(t2, c, a, v, t, t1, nb, 0, 0, cb);
+         ReplaceNeighbor(na, t, t1);
+         ReplaceNeighbor(nb, t, t2);
+         stack.push_back({ t, 2 });
+         stack.push_back({ t1, 2 });
+         stack.push_back({ t2, 2 });
+      }
+
+      // v on the edge opposite t's corner i: both triangles sharing it split in two.
+      void SplitEdge(int t, int i, int v) {
+         auto u = N(t, i);
+         auto j = NeighborCorner(t, i);
+         auto a = V(t, i), b = V(t, Next(i)), c = V(t, Prev(i));
+         auto d = V(u, j);
+         auto ntb = N(t, Next(i)), ntc = N(t, Prev(i));
+         auto nub = N(u, Prev(j)), nuc = N(u, Next(j));
+         auto ctb = Constrained[3 * t + Next(i)], ctc = Constrained[3 * t + Prev(i)];
+         auto cub = Constrained[3 * u + Prev(j)], cuc = Constrained[3 * u + Next(j)];
+         auto cbc = Constrained[3 * t + i];
+
+         auto t1 = AddTriangle(), u1 = AddTriangle();
+         SetTriangle(t, a, b, v, u1, t1, ntc, cbc, 0, ctc);
+         SetTriangle(t1, a, v, c, u, ntb, t, cbc, ctb, 0);
+         SetTriangle(u, d, c, v, t1, u1, nub, cbc, 0, cub);
+         SetTriangle(u1, d, v, b, t, nuc, u, cbc, cuc, 0);
+         ReplaceNeighbor(ntb, t, t1);
+         ReplaceNeighbor(nuc, u, u1);
+         stack.push_back({ t, 2 });
+         stack.push_back({ t1, 1 });
+         stack.push_back({ u, 2 });
+         stack.push_back({ u1, 1 });
+      }
+
+      // Replaces the edge opposite t's corner i (a) by the other diagonal of the quad it bounds
+      // with its neighbor (corner d): t becomes (a, b, d) and the neighbor (a, d, c).
+      void Flip(int t, int i) {
+         auto u = N(t, i);
+         auto j = NeighborCorner(t, i);
+         auto a = V(t, i), b = V(t, Next(i)), c = V(t, Prev(i));
+         auto d = V(u, j);
+         auto ntb = N(t, Next(i)), ntc = N(t, Prev(i));
+         auto nub = N(u, Prev(j)), nuc = N(u, Next(j));
+         auto ctb = Constrained[3 * t + Next(i)], ctc = Constrained[3 * t + Prev(i)];
+         auto cub = Constrained[3 * u + Prev(j)], cuc = Constrained[3 * u + Next(j)];
+
+         SetTriangle(t, a, b, d, nuc, u, ntc, cuc, 0, ctc);
+         SetTriangle(u, a, d, c, nub, ntb, t, cub, ctb, 0);
+         ReplaceNeighbor(nuc, u, t);
+         ReplaceNeighbor(ntb, t, u);
+      }
+
+      // Lawson step for a freshly inserted vertex at t's corner i.
+      void LegalizeCorner(int t, int i) {
+         auto u = N(t, i);
+         if (u < 0 || C(t, i)) return;
+         if (InCircle(V(t, 0), V(t, 1), V(t, 2), V(u, NeighborCorner(t, i))) <= 0) return;
+
+         Flip(t, i);
+         stack.push_back({ t, 0 });
+         stack.push_back({ u, 0 });
+      }
+
+      // Sloan's edge forcing: flips the crossed edges until a-b appears, then restores the
+      // Delaunay property around it.
+      bool ForceEdge(int a, int b) {
+         queue.assign(crossings.begin(), crossings.end());
+         stack.clear();
+         int64_t budget = static_cast<int64_t>(queue.size()) * static_cast<int64_t>(queue.size()) + kMaxStepsPerVertex;
+         while (!queue.empty()) {
+            if (--budget < 0) return false;
+
+            auto e = queue.front();
+            queue.pop_front();
+            int t, i;
+            FindEdge(e.a, e.b, OUT t, OUT i);
+            auto u = N(t, i);
+            auto x = V(t, i), y = V(u, NeighborCorner(t, i));
+            if (sign(Orient(x, y, e.a)) * sign(Orient(x, y, e.b)) >= 0) {
+               queue.push_back(e);
+               continue;
+            }
+
+            Flip(t, i);
+            for (auto k = 0; k < 3; k++) {
+               stack.push_back({ V(t, k), V(t, Next(k)) });
+               stack.push_back({ V(u, k), V(u, Next(k)) });
+            }
+            if (sign(Orient(a, b, x)) * sign(Orient(a, b, y)) < 0) {
+               queue.push_back({ x, y });
+            }
+         }
+
+         int t, i;
+         FindEdge(a, b, OUT t, OUT i);
+         MarkConstrained(t, i);
+
+         // Lawson flips over every edge the forcing touched.
+         budget = kMaxStepsPerVertex;
+         while (!stack.empty()) {
+            if (--budget < 0) return false;
+
+            auto e = stack.back();
+            stack.pop_back();
+            if (!FindEdge(e.a, e.b, OUT t, OUT i) || C(t, i)) continue;
+            auto u = N(t, i);
+            if (u < 0 || InCircle(V(t, 0), V(t, 1), V(t, 2), V(u, NeighborCorner(t, i))) <= 0) continue;
+
+            Flip(t, i);
+            for (auto k = 0; k < 3; k++) {
+               stack.push_back({ V(t, k), V(t, Next(k)) });
+               stack.push_back({ V(u, k), V(u, Next(k)) });
+            }
+         }
+         return true;
+      }
+   };
+
+   // The land contour and its holes, as points [begin, end) of the input.
+   struct ContourRange {
+      int Begin, End;
+   };
+
+   // Triangulates one island, appending island-local triangles to out. False on crossing contours.
+   bool TriangulateIsland(const point2i32* points, const std::vector<ContourRange>& contours, OUT std::vector<int32_t>& triangleVertices, OUT std::vector<int32_t>& triangleNeighbors, OUT std::vector<int32_t>& neighborSharedEdges) {
+      // Merge coincident points; each keeps the first input index among its copies.
+      std::vector<int> inputs;
+      for (auto& contour : contours) {
+         for (auto p = contour.Begin; p < contour.End; p++) inputs.push_back(p);
+      }
+
+      auto numInputs = static_cast<int>(inputs.size());
+      if (numInputs < 3) return true;
+
+      std::vector<int> order(numInputs);
+      for (auto k = 0; k < numInputs; k++) order[k] = k;
+      std::sort(order.begin(), order.end(), [&](int a, int b) {
+         auto& pa = points[inputs[a]];
+         auto& pb = points[inputs[b]];
+         return std::tie(pa.x, pa.y, a) < std::tie(pb.x, pb.y, b);
+      });
+
+      std::vector<int> inputVertices(numInputs);
+      std::vector<int> vertexPoints;
+      for (auto k = 0; k < numInputs; k++) {
+         auto& p = points[inputs[order[k]]];
+         if (k == 0 || p.x != points[inputs[order[k - 1]]].x || p.y != points[inputs[order[k - 1]]].y) {
+            vertexPoints.push_back(inputs[order[k]]);
+         }
+         inputVertices[order[k]] = kNumSuperVertices + static_cast<int>(vertexPoints.size()) - 1;
+      }
+
+      // Super triangle well clear of the bounds, then the points.
+      int64_t minX = INT64_MAX, minY = INT64_MAX, maxX = INT64_MIN, maxY = INT64_MIN;
+      for (auto p : vertexPoints) {
+         minX = std::min<int64_t>(minX, points[p].x);
+         minY = std::min<int64_t>(minY, points[p].y);
+         maxX = std::max<int64_t>(maxX, points[p].x);
+         maxY = std::max<int64_t>(maxY, points[p].y);
+      }
+      auto size = std::max<int64_t>({ maxX - minX, maxY - minY, 1 });
+
+      std::vector<int64_t> xs = { minX - 10 * size, maxX + 30 * size, minX - 10 * size };
+      std::vector<int64_t> ys = { minY - 10 * size, minY - 10 * size, maxY + 30 * size };
+      for (auto p : vertexPoints) {
+         xs.push_back(points[p].x);
+         ys.push_back(points[p].y);
+      }
+
+      auto numVertices = static_cast<int>(vertexPoints.size());
+      std::vector<std::pair<uint32_t, int>> insertionOrder(numVertices);
+      for (auto v = 0; v < numVertices; v++) {
+         auto p = vertexPoints[v];
+         auto hx = static_cast<uint32_t>((points[p].x - minX) * 65535 / size);
+         auto hy = static_cast<uint32_t>((points[p].y - minY) * 65535 / size);
+         insertionOrder[v] = { HilbertIndex(hx, hy), kNumSuperVertices + v };
+      }
+      std::sort(insertionOrder.begin(), insertionOrder.end());
+
+      CdtBuilder builder(std::move(xs), std::move(ys));
+      auto hint = 0;
+      for (auto& entry : insertionOrder) {
+         if (!builder.InsertVertex(entry.second, OUT hint)) return false;
+      }
+
+      // Contour edges, closing each contour back to its first point.
+      auto slot = 0;
+      for (auto& contour : contours) {
+         auto n = contour.End - contour.Begin;
+         for (auto k = 0; k < n; k++) {
+            auto a = inputVertices[slot + k];
+            auto b = inputVertices[slot + (k + 1 == n ? 0 : k + 1)];
+            if (!builder.InsertConstraint(a, b)) return false;
+         }
+         slot += n;
+      }
+
+      // Keep land, renumbered in construction order.
+      auto depths = builder.ComputeDepths();
+      auto numTriangles = static_cast<int>(depths.size());
+      std::vector<int> outputIndices(numTriangles, -1);
+      auto numOutput = 0;
+      for (auto t = 0; t < numTriangles; t++) {
+         auto isLand = (depths[t] & 1) != 0 &&
+                       builder.V(t, 0) >= kNumSuperVertices &&
+                       builder.V(t, 1) >= kNumSuperVertices &&
+                       builder.V(t, 2) >= kNumSuperVertices;
+         if (isLand) outputIndices[t] = numOutput++;
+      }
+
+      for (auto t = 0; t < numTriangles; t++) {
+         if (outputIndices[t] < 0) continue;
+         for (auto i = 0; i < 3; i++) {
+            triangleVertices.push_back(vertexPoints[builder.V(t, i) - kNumSuperVertices]);
+            auto n = builder.N(t, i);
+            if (n >= 0 && outputIndices[n] >= 0) {
+               triangleNeighbors.push_back(outputIndices[n]);
+               neighborSharedEdges.push_back(builder.NeighborCorner(t, i));
+            } else {
+               triangleNeighbors.push_back(-1);
+               neighborSharedEdges.push_back(-1);
+            }
+         }
+      }
+      return true;
+   }
+}
+
+void TriangulatePolygonTree(const point2i32* points, const int* contourOffsets, const int* contourParents, int numContours, OUT PolygonTreeTriangulation& result) {
+   // Land contours are at even depth; each gathers its direct children as holes. A closed
+   // contour's repeated first point is dropped, as managed ConvertToTriangulationPoints does.
+   std::vector<int> depths(numContours);
+   std::vector<std::vector<ContourRange>> islands(numContours);
+   for (auto i = 0; i < numContours; i++) {
+      depths[i] = 0;
+      for (auto p = contourParents[i]; p >= 0; p = contourParents[p]) depths[i]++;
+
+      ContourRange range{ contourOffsets[i], contourOffsets[i + 1] };
+      if (range.End - range.Begin > 1 &&
+          points[range.Begin].x == points[range.End - 1].x &&
+          points[range.Begin].y == points[range.End - 1].y) {
+         range.End--;
+      }
+
+      auto island = (depths[i] & 1) == 0 ? i : contourParents[i];
+      if (island == i) {
+         islands[i].insert(islands[i].begin(), range);
+      } else {
+         islands[island].push_back(range);
+      }
+   }
+
+   std::vector<std::vector<int32_t>> islandVertices(numContours), islandNeighbors(numContours), islandSharedEdges(numContours);
+   std::vector<uint8_t> failed(numContours, 0);
+   ParallelFor(numContours, 1, [&](int i) {
+      if ((depths[i] & 1) != 0) return;
+      failed[i] = !TriangulateIsland(points, islands[i], OUT islandVertices[i], OUT islandNeighbors[i], OUT islandSharedEdges[i]);
+   });
+
+   if (std::find(failed.begin(), failed.end(), 1) != failed.end()) {
+      throw std::runtime_error("polygon tree contours cross");
+   }
+
+   result.ContourTriangleOffsets.assign(numContours + 1, 0);
+   for (auto i = 0; i < numContours; i++) {
+      result.ContourTriangleOffsets[i + 1] = result.ContourTriangleOffsets[i] + static_cast<int>(islandVertices[i].size() / 3);
+   }
+
+   auto numTriangles = result.ContourTriangleOffsets[numContours];
+   result.TriangleVertices.clear();
+   result.TriangleNeighbors.clear();
+   result.NeighborSharedEdges.clear();
+   result.TriangleVertices.reserve(3 * numTriangles);
+   result.TriangleNeighbors.reserve(3 * numTriangles);
+   result.NeighborSharedEdges.reserve(3 * numTriangles);
+   for (auto i = 0; i < numContours; i++) {
+      result.TriangleVertices.insert(result.TriangleVertices.end(), islandVertices[i].begin(), islandVertices[i].end());
+      result.TriangleNeighbors.insert(result.TriangleNeighbors.end(), islandNeighbors[i].begin(), islandNeighbors[i].end());
+      result.NeighborSharedEdges.insert(result.NeighborSharedEdges.end(), islandSharedEdges[i].begin(), islandSharedEdges[i].end());
+   }
+}
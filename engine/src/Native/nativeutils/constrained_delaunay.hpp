@@ -0,0 +1,25 @@
+#pragma once
+
+#include "geometry.hpp"
+
+// Triangulations of a flattened polygon tree, packed back to back. Land contour i's island is
+// triangles [ContourTriangleOffsets[i], ContourTriangleOffsets[i + 1]), empty for holes. Triangles
+// use the TriangleMesh layout: corners counterclockwise as indices into the input points,
+// neighbor opposite each corner as an island-local triangle index (-1 if none), and the
+// neighbor's corner opposite the shared edge.
+typedef struct PolygonTreeTriangulation_s {
+   std::vector<int> ContourTriangleOffsets;
+   std::vector<int32_t> TriangleVertices;
+   std::vector<int32_t> TriangleNeighbors;
+   std::vector<int32_t> NeighborSharedEdges;
+} PolygonTreeTriangulation;
+
+// Managed Triangulator.TriangulateRoot without Poly2Tri: a constrained Delaunay triangulation of
+// each land contour and its holes, islands in parallel.
+//
+// Contour i is points [contourOffsets[i], contourOffsets[i + 1]), open or closed, and its parent
+// contour is contourParents[i] (-1 under the root hole). Depth alternates land / hole from land at
+// the top, as in a managed PolygonNode tree. Coincident points are merged (triangles refer to the
+// first) and points lying on a contour edge split it. Contours may touch at points or along edges
+// but not cross; crossing contours throw. Coordinates must fit in +-2^23 for the predicates to be exact.
+void TriangulatePolygonTree(const point2i32* points, const int* contourOffsets, const int* contourParents, int numContours, OUT PolygonTreeTriangulation& result);
@@ -0,0 +1,89 @@
+#include "pch.h"
+#include "dijkstras.hpp"
+#include "parallel.hpp"
+#include "radix_heap.hpp"
+#include <limits>
+
+namespace {
+   // Sources per batch task; each task reuses one heap across its sources.
+   constexpr int kBatchChunkSize = 8;
+
+   struct CsrGraph {
+      const int* Offsets;
+      const int* EdgeTargets;
+      const float* EdgeCosts;
+      int NumNodes;
+   };
+
+   void RunDijkstras(
+      const CsrGraph& g, const dijkstra_seed* seeds, int numSeeds, const int* terminals, int numTerminals,
+      float* costs, int32_t* predecessors, RadixHeap& heap
+   ) {
+      std::fill_n(costs, g.NumNodes, std::numeric_limits<float>::infinity());
+      std::fill_n(predecessors, g.NumNodes, -1);
+
+      heap.Clear();
+      for (auto i = 0; i < numSeeds; i++) {
+         const auto& seed = seeds[i];
+         if (seed.totalCost <= costs[seed.current]) {
+            costs[seed.current] = seed.totalCost;
+            heap.Push(KeyOf(seed.totalCost), seed.current, seed.prior);
+         }
+      }
+
+      auto terminalsToCompletion = terminals ? numTerminals : 0;
+      while (!heap.IsEmpty()) {
+         // no-op if node already settled
+         auto x = heap.Pop();
+         auto current = x.Node;
+         if (predecessors[current] != -1) continue;
+
+         auto totalCost = CostOf(x.Key);
+         predecessors[current] = x.Prior;
+         costs[current] = totalCost;
+         if (terminals && std::binary_search(terminals, terminals + numTerminals, current)) {
+            terminalsToCompletion--;
+            if (terminalsToCompletion == 0) return;
+         }
+
+         for (auto e = g.Offsets[current], end = g.Offsets[current + 1]; e < end; e++) {
+            auto next = g.EdgeTargets[e];
+            if (predecessors[next] != -1) continue;
+
+            auto nextTotalCost = totalCost + g.EdgeCosts[e];
+            if (costs[next] >= nextTotalCost) {
+               costs[next] = nextTotalCost;
+               heap.Push(KeyOf(nextTotalCost), next, current);
+            }
+         }
+      }
+   }
+}
+
+void Dijkstras(
+   const int* offsets, const int* edgeTargets, const float* edgeCosts, int numNodes,
+   const dijkstra_seed* seeds, int numSeeds, const int* terminals, int numTerminals,
+   float* costs, int32_t* predecessors
+) {
+   CsrGraph g{ offsets, edgeTargets, edgeCosts, numNodes };
+   RadixHeap heap;
+   RunDijkstras(g, seeds, numSeeds, terminals, numTerminals, costs, predecessors, heap);
+}
+
+void DijkstrasBatch(
+   const int* offsets, const int* edgeTargets, const float* edgeCosts, int numNodes,
+   const int* sources, int numSources,
+   float* costs, int32_t* predecessors
+) {
+   CsrGraph g{ offsets, edgeTargets, edgeCosts, numNodes };
+   auto numChunks = (numSources + kBatchChunkSize - 1) / kBatchChunkSize;
+   ParallelFor(numChunks, 1, [&](int chunk) {
+      RadixHeap heap;
+      auto end = std::min(numSources, (chunk + 1) * kBatchChunkSize);
+      for (auto s = chunk * kBatchChunkSize; s < end; s++) {
+         dijkstra_seed seed{ sources[s], sources[s], 0.0f };
+         auto row = static_cast<size_t>(s) * numNodes;
+         RunDijkstras(g, &seed, 1, nullptr, 0, costs + row, predecessors + row, heap);
+      }
+   });
+}
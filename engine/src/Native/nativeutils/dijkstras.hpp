@@ -0,0 +1,35 @@
+#pragma once
+
+// Mirrors managed DijkstrasIntermediate: current is reached from prior at totalCost.
+// A source is seeded as { s, s, 0 }.
+typedef struct dijkstra_seed_s {
+   int32_t prior;
+   int32_t current;
+   float totalCost;
+} dijkstra_seed;
+
+// Multi-source Dijkstra over a CSR graph (node i's edges are [offsets[i], offsets[i + 1]),
+// edge e runs to edgeTargets[e] at cost edgeCosts[e] >= 0), same semantics as managed
+// PolyNodeVisibilityGraph.Dijkstras. Writes per-node costs (+inf if unreachable) and
+// predecessors (the node before it on its shortest path; -1 if never settled). If terminals
+// (sorted ascending) are given, stops once all of them are settled; unsettled nodes then
+// hold a tentative cost.
+//
+// Seeds must pass IsValidDijkstraSeed: -1 marks an unsettled predecessor, so a seed with a
+// negative prior would never count as settled, and the radix heap only orders costs >= 0.
+FORCEINLINE bool IsValidDijkstraSeed(const dijkstra_seed& seed, int numNodes) {
+   return seed.current >= 0 && seed.current < numNodes && seed.prior >= 0 && seed.totalCost >= 0;
+}
+
+void Dijkstras(
+   const int* offsets, const int* edgeTargets, const float* edgeCosts, int numNodes,
+   const dijkstra_seed* seeds, int numSeeds, const int* terminals, int numTerminals,
+   float* costs, int32_t* predecessors);
+
+// One single-source Dijkstra per entry of sources, run in parallel. Row s of the
+// numSources x numNodes outputs holds the result for sources[s], so passing every node
+// yields the same all-pairs layout as FloydWarshallBlocked at O(V E log V) instead of O(V^3).
+void DijkstrasBatch(
+   const int* offsets, const int* edgeTargets, const float* edgeCosts, int numNodes,
+   const int* sources, int numSources,
+   float* costs, int32_t* predecessors);
@@ -1,6 +1,7 @@
 // dllmain.cpp : Defines the entry point for the DLL application.
 #include "pch.h"
 #include "dllmain.hpp"
+#include "geometry.hpp"
 #include <cassert>
 
 #if WINDOWS
@@ -21,24 +22,6 @@ BOOL APIENTRY DllMain( HMODULE hModule,
 }
 #endif
 
-struct point2i16 {
-   short x;
-   short y;
-};
-
-struct seg2i16 {
-   union {
-      struct {
-         short x1, y1, x2, y2;
-      };
-      struct {
-         point2i16 p1, p2;
-      };
-   };
-};
-
-static_assert(sizeof(seg2i16) == 8, "seg2i16 must be packed");
-
 std::vector<seg2i16> parse(const std::string& fileName) {
    std::vector<seg2i16> res;
 
@@ -57,14 +40,6 @@ std::vector<seg2i16> parse(const std::string& fileName) {
    return res;
 }
 
-template <typename T> int cmp(T v0, T v1) {
-   return (v1 < v0) - (v0 < v1);
-}
-
-template <typename T> int sign(T val) {
-   return cmp(val, 0);
-}
-
 int clk(short ax, short ay, short bx, short by) {
    // sign(ax * by - ay * bx);
    auto v0 = static_cast<int>(ax) * by;
@@ -72,7 +47,7 @@ int clk(short ax, short ay, short bx, short by) {
    return cmp(v0, v1);
 }
 
-int g_segs = 0;
+thread_local int g_segs = 0; // per thread, as queries may run on ParallelFor workers
 
 bool AnyIntersections(seg2i16 query, const std::vector<seg2i16>& segments, bool detectEndpointContainment) {
    short ax = query.x1;
@@ -395,34 +370,42 @@ FORCEINLINE bool AnyIntersectionsAvx2(seg2i16 query, const __m256i* segChunks, i
 static thread_local short* tlsChunkBuff = nullptr;
 static thread_local size_t tlsChunkBuffNumChunks = 0;
 
-std::shared_ptr<Avx2IntersectionPrequeryState> LoadPrequeryBarriersIntersectionState(const seg2i16* barriers, int numBarriers) {
-   auto numChunks = ((numBarriers + 3) / 4) * 2;
-   auto chunkBuffer = _aligned_malloc(numChunks * 32, 32);
+std::shared_ptr<Avx2IntersectionPrequeryState> AllocatePrequeryBarriersIntersectionState(int maxBarriers) {
+   // Whole chunk pairs (4 segments), at least one so the buffer is never empty.
+   auto maxChunks = std::max(2, ((maxBarriers + 3) / 4) * 2);
+   auto chunkBuffer = _aligned_malloc(maxChunks * 32, 32);
    assert(chunkBuffer);
 
-   // zero last two chunks (4 segments) as only 1 segment might be stored & the remaining 3
+   auto state = std::make_shared<Avx2IntersectionPrequeryState>();
+   state->NumChunks = 0;
+   state->ChunkBuffer = std::shared_ptr<char>((char*)chunkBuffer, &_aligned_free);
+   return state;
+}
+
+void SetPrequeryBarrierCount(Avx2IntersectionPrequeryState& state, int numBarriers) {
+   // zero the rest of the last chunk pair as only 1 segment might be stored & the remaining 3
    // should not detect an intersect.
-   memset(static_cast<char*>(chunkBuffer) + (numChunks - 2) * 32, 0, 64);
+   state.NumChunks = ((numBarriers + 3) / 4) * 2;
+   memset(state.ChunkBuffer.get() + numBarriers * 16, 0, (state.NumChunks * 2 - numBarriers) * 16);
+}
 
-   // Load 128 bits = half chunk = (y1, x1, y2, x2, x1 - x2, y2 - y1, 0, 0)
-   auto pCurrent = reinterpret_cast<short*>(chunkBuffer);
-   auto currentBarrier = barriers;
+std::shared_ptr<Avx2IntersectionPrequeryState> LoadPrequeryBarriersIntersectionState(const seg2i16* barriers, int numBarriers) {
+   auto state = AllocatePrequeryBarriersIntersectionState(numBarriers);
    for (auto i = 0; i < numBarriers; i++) {
-      const auto barrier = *currentBarrier;
-      *(pCurrent++) = barrier.y1;
-      *(pCurrent++) = barrier.x1;
-      *(pCurrent++) = barrier.y2;
-      *(pCurrent++) = barrier.x2;
-      *(pCurrent++) = barrier.x1 - barrier.x2;
-      *(pCurrent++) = barrier.y2 - barrier.y1;
-      *(pCurrent++) = 0;
-      *(pCurrent++) = 0;
-      currentBarrier++;
+      const auto& barrier = barriers[i];
+      StorePrequeryBarrier(*state, i, barrier.x1, barrier.y1, barrier.x2, barrier.y2);
    }
+   SetPrequeryBarrierCount(*state, numBarriers);
+   return state;
+}
 
-   auto state = std::make_shared<Avx2IntersectionPrequeryState>();
-   state->NumChunks = numChunks;
-   state->ChunkBuffer = std::shared_ptr<char>((char*)chunkBuffer, &_aligned_free);
+std::shared_ptr<Avx2IntersectionPrequeryState> LoadPrequeryBarriersIntersectionState(const seg2i32* barriers, int numBarriers) {
+   auto state = AllocatePrequeryBarriersIntersectionState(numBarriers);
+   for (auto i = 0; i < numBarriers; i++) {
+      const auto& barrier = barriers[i];
+      StorePrequeryBarrier(*state, i, static_cast<short>(barrier.x1), static_cast<short>(barrier.y1), static_cast<short>(barrier.x2), static_cast<short>(barrier.y2));
+   }
+   SetPrequeryBarrierCount(*state, numBarriers);
    return state;
 }
 
@@ -451,6 +434,10 @@ void QueryAnyIntersections(std::shared_ptr<Avx2IntersectionPrequeryState> preque
    }
 }
 
+bool AnyChunkIntersections(seg2i16 query, const char* chunks, int numChunks) {
+   return AnyIntersectionsAvx2(query, reinterpret_cast<const __m256i*>(chunks), numChunks);
+}
+
 
 int main() {
    auto barriers = parse("barriers.txt");
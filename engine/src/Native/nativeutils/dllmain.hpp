@@ -1,11 +1,36 @@
 #pragma once
 
 struct seg2i16;
+struct seg2i32;
 
 typedef struct Avx2IntersectionPrequeryState_s {
    int NumChunks;
    std::shared_ptr<char> ChunkBuffer;
 } Avx2IntersectionPrequeryState;
 
+// Room for up to maxBarriers barriers. Fill with StorePrequeryBarrier, then SetPrequeryBarrierCount.
+std::shared_ptr<Avx2IntersectionPrequeryState> AllocatePrequeryBarriersIntersectionState(int maxBarriers);
+void SetPrequeryBarrierCount(Avx2IntersectionPrequeryState& state, int numBarriers);
+
+// Barrier i's half chunk: (y1, x1, y2, x2, x1 - x2, y2 - y1, 0, 0).
+FORCEINLINE void StorePrequeryBarrier(Avx2IntersectionPrequeryState& state, int i, short x1, short y1, short x2, short y2) {
+   auto p = reinterpret_cast<short*>(state.ChunkBuffer.get()) + 8 * i;
+   p[0] = y1;
+   p[1] = x1;
+   p[2] = y2;
+   p[3] = x2;
+   p[4] = x1 - x2;
+   p[5] = y2 - y1;
+   p[6] = 0;
+   p[7] = 0;
+}
+
 std::shared_ptr<Avx2IntersectionPrequeryState> LoadPrequeryBarriersIntersectionState(const seg2i16* barriers, int numBarriers);
+
+// Coordinates are truncated to int16.
+std::shared_ptr<Avx2IntersectionPrequeryState> LoadPrequeryBarriersIntersectionState(const seg2i32* barriers, int numBarriers);
+
 void QueryAnyIntersections(std::shared_ptr<Avx2IntersectionPrequeryState> state, const seg2i16* queries, int numQueries, uint8_t* results);
+
+// Whether query intersects any of the numChunks chunks (an even count, 32-byte aligned) at chunks.
+bool AnyChunkIntersections(seg2i16 query, const char* chunks, int numChunks);
@@ -0,0 +1,148 @@
+#include "pch.h"
+#include "flocking.hpp"
+#include "parallel.hpp"
+
+namespace {
+   constexpr int kLanes = 8;
+
+   // Entities per task; neighbor counts vary, so keep chunks small enough to balance.
+   constexpr int kEntitiesPerTask = 64;
+
+   // Managed Frac01Lut resolution.
+   constexpr int kLutSizeMinus1 = 256;
+
+   // Managed isOverlappingWeightLut: separation weight k^2 (0.8 + 0.2 (1 - (d / D)^0.3)) for
+   // center distance d and radius sum D, sampled at floor(256 d / D).
+   const float* SeparationWeightLut() {
+      static const auto lut = []() {
+         std::vector<float> res(kLutSizeMinus1 + 1);
+         const double k = 700;
+         for (auto i = 0; i <= kLutSizeMinus1; i++) {
+            res[i] = static_cast<float>(k * k * (0.8 + 0.2 * (1.0 - std::pow(static_cast<double>(i) / kLutSizeMinus1, 0.3))));
+         }
+         return res;
+      }();
+      return lut.data();
+   }
+
+   // floor(sqrt(x)) per lane for 0 <= x < 2^31 (managed IntMath.Sqrt); the float estimate is
+   // off by at most one either way.
+   FORCEINLINE __m256i IntSqrtAvx2(__m256i x) {
+      const __m256i one = _mm256_set1_epi32(1);
+      auto s = _mm256_cvttps_epi32(_mm256_sqrt_ps(_mm256_cvtepi32_ps(x)));
+      auto tooBig = _mm256_cmpgt_epi32(_mm256_mullo_epi32(s, s), x);
+      s = _mm256_add_epi32(s, tooBig);
+      auto s1 = _mm256_add_epi32(s, one);
+      auto tooSmall = _mm256_cmpgt_epi32(_mm256_add_epi32(x, one), _mm256_mullo_epi32(s1, s1));
+      return _mm256_sub_epi32(s, tooSmall);
+   }
+
+   // floor(n / d) per lane for 0 <= n, 0 < d, both < 2^24, corrected from the float quotient.
+   FORCEINLINE __m256i IntDivAvx2(__m256i n, __m256i d) {
+      const __m256i one = _mm256_set1_epi32(1);
+      auto q = _mm256_cvttps_epi32(_mm256_div_ps(_mm256_cvtepi32_ps(n), _mm256_cvtepi32_ps(d)));
+      q = _mm256_add_epi32(q, _mm256_cmpgt_epi32(_mm256_mullo_epi32(q, d), n));
+      auto tooSmall = _mm256_cmpgt_epi32(_mm256_add_epi32(n, one), _mm256_mullo_epi32(_mm256_add_epi32(q, one), d));
+      return _mm256_sub_epi32(q, tooSmall);
+   }
+
+   FORCEINLINE float HorizontalSum(__m256 v) {
+      auto x = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+      x = _mm_add_ps(x, _mm_movehl_ps(x, x));
+      x = _mm_add_ss(x, _mm_movehdup_ps(x));
+      return _mm_cvtss_f32(x);
+   }
+
+   FORCEINLINE void Normalize(float& x, float& y) {
+      if (x == 0.0f && y == 0.0f) return;
+      auto invNorm = 1.0f / std::sqrt(x * x + y * y);
+      x *= invNorm;
+      y *= invNorm;
+   }
+}
+
+void ComputeFlockingForces(
+   int numEntities, const int32_t* xs, const int32_t* ys, const float* radii,
+   const float* seekXs, const float* seekYs, const float* directSeekXs, const float* directSeekYs,
+   const uint8_t* onGoalTriangle, const float* seekAlignWeights,
+   const int* neighborOffsets, const int* neighbors,
+   float* forceXs, float* forceYs
+) {
+   const auto lut = SeparationWeightLut();
+
+   // Managed CalculateMergedSeekContributions: what each entity contributes to its neighbors'
+   // alignment.
+   std::vector<float> steeringXs(numEntities), steeringYs(numEntities);
+   for (auto i = 0; i < numEntities; i++) {
+      auto direct = onGoalTriangle[i] != 0;
+      steeringXs[i] = direct ? directSeekXs[i] : seekXs[i] * 0.6f + directSeekXs[i] * 0.4f;
+      steeringYs[i] = direct ? directSeekYs[i] : seekYs[i] * 0.6f + directSeekYs[i] * 0.4f;
+   }
+
+   ParallelFor(numEntities, kEntitiesPerTask, [&](int i) {
+      const auto zero = _mm256_setzero_si256();
+      const auto laneIndices = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+      const auto ix = _mm256_set1_epi32(xs[i]);
+      const auto iy = _mm256_set1_epi32(ys[i]);
+      const auto iRadius = _mm256_set1_ps(radii[i]);
+      const auto self = _mm256_set1_epi32(i);
+
+      auto separationX = _mm256_setzero_ps(), separationY = _mm256_setzero_ps();
+      auto alignmentX = _mm256_setzero_ps(), alignmentY = _mm256_setzero_ps();
+
+      const auto begin = neighborOffsets[i], end = neighborOffsets[i + 1];
+      for (auto n = begin; n < end; n += kLanes) {
+         // Tail lanes gather entity i itself, which the self mask then drops.
+         auto inRange = _mm256_cmpgt_epi32(_mm256_set1_epi32(end - n), laneIndices);
+         auto js = _mm256_maskload_epi32(neighbors + n, inRange);
+         js = _mm256_blendv_epi8(self, js, inRange);
+         auto valid = _mm256_andnot_si256(_mm256_cmpeq_epi32(js, self), _mm256_set1_epi32(-1));
+
+         // Managed TryContribution, overlapping branch: aToB, |aToB|^2 < (int)(rA + rB)^2.
+         auto dx = _mm256_sub_epi32(_mm256_i32gather_epi32(xs, js, 4), ix);
+         auto dy = _mm256_sub_epi32(_mm256_i32gather_epi32(ys, js, 4), iy);
+         auto d2 = _mm256_add_epi32(_mm256_mullo_epi32(dx, dx), _mm256_mullo_epi32(dy, dy));
+         auto radiusSum = _mm256_cvttps_epi32(_mm256_add_ps(iRadius, _mm256_i32gather_ps(radii, js, 4)));
+         auto overlapping = _mm256_and_si256(valid, _mm256_cmpgt_epi32(_mm256_mullo_epi32(radiusSum, radiusSum), d2));
+
+         // Coincident centers push apart along (2, 1), whose integer norm is 2: managed visits a
+         // cell's entities from the highest index, so that one takes +(2, 1) and the other -(2, 1).
+         auto d = IntSqrtAvx2(d2);
+         auto coincident = _mm256_cmpeq_epi32(d2, zero);
+         auto lutIndex = IntDivAvx2(_mm256_slli_epi32(d, 8), _mm256_max_epi32(radiusSum, _mm256_set1_epi32(1)));
+         lutIndex = _mm256_and_si256(lutIndex, overlapping);
+         auto w = _mm256_i32gather_ps(lut, lutIndex, 4);
+
+         auto selfIsHigher = _mm256_cmpgt_epi32(self, js);
+         auto coincidentX = _mm256_blendv_epi8(_mm256_set1_epi32(-2), _mm256_set1_epi32(2), selfIsHigher);
+         auto coincidentY = _mm256_blendv_epi8(_mm256_set1_epi32(-1), _mm256_set1_epi32(1), selfIsHigher);
+         auto forceX = _mm256_blendv_epi8(_mm256_sub_epi32(zero, dx), coincidentX, coincident);
+         auto forceY = _mm256_blendv_epi8(_mm256_sub_epi32(zero, dy), coincidentY, coincident);
+         auto forceNorm = _mm256_blendv_epi8(d, _mm256_set1_epi32(2), coincident);
+         auto scale = _mm256_and_ps(_mm256_castsi256_ps(overlapping), _mm256_div_ps(w, _mm256_cvtepi32_ps(forceNorm)));
+         separationX = _mm256_fmadd_ps(scale, _mm256_cvtepi32_ps(forceX), separationX);
+         separationY = _mm256_fmadd_ps(scale, _mm256_cvtepi32_ps(forceY), separationY);
+
+         // Managed CalculateAlignmentContributions sums every neighbor's steering.
+         auto validMask = _mm256_castsi256_ps(valid);
+         alignmentX = _mm256_add_ps(alignmentX, _mm256_and_ps(validMask, _mm256_i32gather_ps(steeringXs.data(), js, 4)));
+         alignmentY = _mm256_add_ps(alignmentY, _mm256_and_ps(validMask, _mm256_i32gather_ps(steeringYs.data(), js, 4)));
+      }
+
+      auto ccsX = HorizontalSum(separationX), ccsY = HorizontalSum(separationY);
+      auto aliX = HorizontalSum(alignmentX), aliY = HorizontalSum(alignmentY);
+      Normalize(ccsX, ccsY);
+      Normalize(aliX, aliY);
+
+      // Managed AggregateForceContributions.
+      auto direct = onGoalTriangle[i] != 0;
+      auto seekX = direct ? directSeekXs[i] : seekXs[i] * 0.8f + directSeekXs[i] * 0.2f;
+      auto seekY = direct ? directSeekYs[i] : seekYs[i] * 0.8f + directSeekYs[i] * 0.2f;
+      auto wali = std::max(0.0f, seekX * aliX + seekY * aliY);
+      auto vx = (seekX * (1.0f - wali) + aliX * wali) * seekAlignWeights[i] + ccsX;
+      auto vy = (seekY * (1.0f - wali) + aliY * wali) * seekAlignWeights[i] + ccsY;
+      Normalize(vx, vy);
+      forceXs[i] = vx;
+      forceYs[i] = vy;
+   });
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "pch.h"
+
+// Managed FlockingSimulator's per-tick force passes fused into one: cohesion/separation,
+// alignment, seek merging and aggregation. Entities are SoA in one sector's local space:
+// positions, radii (already scaled to local units), the triangle-centroid seek of
+// CalculateTriangleCentroidOptimalContinuousPathForceContributions (seek), the direct seek of
+// CalculateTriangleCentroidNonoptimalDiscrete...Contribution (directSeek, used alone where
+// onGoalTriangle is set), and AggregateForceContributions' per-entity seekAlignWeights.
+//
+// Entity i's neighbors are neighbors [neighborOffsets[i], neighborOffsets[i + 1]), e.g. from
+// QuerySpatialHashNeighbors; i itself is skipped if listed. Overlapping neighbors push i away
+// and every neighbor's merged seek feeds i's alignment, so the list should cover the alignment
+// radius. Each entity gathers its own contributions, so pairs are weighed symmetrically rather
+// than the managed 1 / 0.9 split by enumeration order. Writes each entity's unit force
+// direction (zero if none), 8 neighbors at a time and in parallel over entities.
+void ComputeFlockingForces(
+   int numEntities, const int32_t* xs, const int32_t* ys, const float* radii,
+   const float* seekXs, const float* seekYs, const float* directSeekXs, const float* directSeekYs,
+   const uint8_t* onGoalTriangle, const float* seekAlignWeights,
+   const int* neighborOffsets, const int* neighbors,
+   float* forceXs, float* forceYs);
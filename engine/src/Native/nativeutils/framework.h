@@ -1,9 +1,11 @@
 #pragma once
 
 #define WIN32_LEAN_AND_MEAN             // Exclude rarely-used stuff from Windows headers
+#define NOMINMAX                        // Keep std::min / std::max usable
 // Windows Header Files
 #include <windows.h>
 
+#include <algorithm>
 #include <bitset>
 #include <chrono>
 #include <cmath>
@@ -11,6 +13,7 @@
 #include <fstream>
 #include <immintrin.h>
 #include <iostream>
+#include <memory>
 #include <mutex>
 #include <sstream>
 #include <string>
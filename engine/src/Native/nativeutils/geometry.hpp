@@ -0,0 +1,89 @@
+#pragma once
+
+#include "pch.h"
+
+struct point2i16 {
+   short x;
+   short y;
+};
+
+struct seg2i16 {
+   union {
+      struct {
+         short x1, y1, x2, y2;
+      };
+      struct {
+         point2i16 p1, p2;
+      };
+   };
+};
+
+static_assert(sizeof(seg2i16) == 8, "seg2i16 must be packed");
+
+// Narrows to the AVX2 intersection kernel's format; coordinates must fit in int16.
+FORCEINLINE seg2i16 ToSeg2i16(int32_t x1, int32_t y1, int32_t x2, int32_t y2) {
+   seg2i16 res;
+   res.x1 = static_cast<short>(x1);
+   res.y1 = static_cast<short>(y1);
+   res.x2 = static_cast<short>(x2);
+   res.y2 = static_cast<short>(y2);
+   return res;
+}
+
+// Matches managed IntVector2 / IntLineSegment2, so pinned arrays pass through as-is.
+struct point2i32 {
+   int32_t x;
+   int32_t y;
+};
+
+struct seg2i32 {
+   union {
+      struct {
+         int32_t x1, y1, x2, y2;
+      };
+      struct {
+         point2i32 p1, p2;
+      };
+   };
+};
+
+static_assert(sizeof(seg2i32) == 16, "seg2i32 must be packed");
+
+// Matches managed DoubleVector2 when cDouble is double.
+struct point2f64 {
+   double x;
+   double y;
+};
+
+struct seg2f64 {
+   union {
+      struct {
+         double x1, y1, x2, y2;
+      };
+      struct {
+         point2f64 p1, p2;
+      };
+   };
+};
+
+static_assert(sizeof(seg2f64) == 32, "seg2f64 must be packed");
+
+// Matches managed IntRect2: inclusive on every side, bottom >= top.
+struct rect2i32 {
+   int32_t left, top, right, bottom;
+};
+
+static_assert(sizeof(rect2i32) == 16, "rect2i32 must be packed");
+
+struct pair2i32 {
+   int32_t a;
+   int32_t b;
+};
+
+template <typename T> int cmp(T v0, T v1) {
+   return (v1 < v0) - (v0 < v1);
+}
+
+template <typename T> int sign(T val) {
+   return cmp(val, T(0));
+}
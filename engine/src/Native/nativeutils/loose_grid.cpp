@@ -0,0 +1,152 @@
+#include "pch.h"
+#include "loose_grid.hpp"
+#include "parallel.hpp"
+
+namespace {
+   constexpr int kQueriesPerTask = 64;
+
+   FORCEINLINE int64_t FloorDiv(int64_t x, int64_t divisor) {
+      return x >= 0 ? x / divisor : -((-x + divisor - 1) / divisor);
+   }
+
+   FORCEINLINE bool Intersects(const rect2i32& a, const rect2i32& b) {
+      return a.right >= b.left && a.left <= b.right && a.bottom >= b.top && a.top <= b.bottom;
+   }
+
+   FORCEINLINE std::vector<LooseGridEntry>& EntriesOf(LooseGrid& grid, int level, int cell) {
+      return level == static_cast<int>(grid.Levels.size()) ? grid.Overflow : grid.Levels[level].Cells[cell];
+   }
+
+   // The finest level whose cells are at least the rect's size and hold its top-left corner, or
+   // Levels.size() for the overflow list.
+   void Place(const LooseGrid& grid, const rect2i32& rect, OUT int& level, OUT int& cell) {
+      auto size = std::max(static_cast<int64_t>(rect.right) - rect.left, static_cast<int64_t>(rect.bottom) - rect.top) + 1;
+      auto x = static_cast<int64_t>(rect.left) - grid.OriginX;
+      auto y = static_cast<int64_t>(rect.top) - grid.OriginY;
+
+      for (level = 0; level < static_cast<int>(grid.Levels.size()); level++) {
+         const auto& l = grid.Levels[level];
+         if (size > l.CellSize) continue;
+
+         auto cx = FloorDiv(x, l.CellSize), cy = FloorDiv(y, l.CellSize);
+         if (cx < 0 || cx >= l.Width || cy < 0 || cy >= l.Height) continue;
+
+         cell = static_cast<int>(cy * l.Width + cx);
+         return;
+      }
+      cell = 0;
+   }
+
+   void Remove(LooseGrid& grid, LooseGridItem& item) {
+      auto& entries = EntriesOf(grid, item.Level, item.Cell);
+      auto moved = entries.back();
+      entries[item.Slot] = moved;
+      grid.Items[moved.Id].Slot = item.Slot;
+      entries.pop_back();
+      if (item.Level < static_cast<int>(grid.Levels.size())) grid.Levels[item.Level].NumItems--;
+      item.Level = -1;
+   }
+
+   // Calls f(id) for each item intersecting query. Items reach at most one cell right and down of
+   // the cell holding their top-left corner, so each level scans the query's cells grown by one
+   // cell up and left.
+   template <typename F>
+   FORCEINLINE void ForEachIntersectingItem(const LooseGrid& grid, const rect2i32& query, const F& f) {
+      auto scan = [&](const std::vector<LooseGridEntry>& entries) {
+         for (const auto& entry : entries) {
+            if (Intersects(entry.Rect, query)) f(entry.Id);
+         }
+      };
+
+      for (const auto& l : grid.Levels) {
+         if (l.NumItems == 0) continue;
+
+         auto cx0 = std::max<int64_t>(0, FloorDiv(static_cast<int64_t>(query.left) - grid.OriginX, l.CellSize) - 1);
+         auto cy0 = std::max<int64_t>(0, FloorDiv(static_cast<int64_t>(query.top) - grid.OriginY, l.CellSize) - 1);
+         auto cx1 = std::min<int64_t>(l.Width - 1, FloorDiv(static_cast<int64_t>(query.right) - grid.OriginX, l.CellSize));
+         auto cy1 = std::min<int64_t>(l.Height - 1, FloorDiv(static_cast<int64_t>(query.bottom) - grid.OriginY, l.CellSize));
+         for (auto cy = cy0; cy <= cy1; cy++) {
+            for (auto cx = cx0; cx <= cx1; cx++) {
+               scan(l.Cells[cy * l.Width + cx]);
+            }
+         }
+      }
+      scan(grid.Overflow);
+   }
+}
+
+std::shared_ptr<LooseGrid> LoadLooseGrid(int originX, int originY, int width, int height, int minCellSize) {
+   auto grid = std::make_shared<LooseGrid>();
+   grid->OriginX = originX;
+   grid->OriginY = originY;
+
+   auto cellSize = static_cast<int64_t>(std::max(1, minCellSize));
+   while (true) {
+      LooseGridLevel level;
+      level.CellSize = static_cast<int>(cellSize);
+      level.Width = static_cast<int>(std::max<int64_t>(1, (width + cellSize - 1) / cellSize));
+      level.Height = static_cast<int>(std::max<int64_t>(1, (height + cellSize - 1) / cellSize));
+      level.NumItems = 0;
+      level.Cells.resize(static_cast<size_t>(level.Width) * level.Height);
+      grid->Levels.push_back(std::move(level));
+
+      if (grid->Levels.back().Width == 1 && grid->Levels.back().Height == 1) break;
+      cellSize *= 2;
+   }
+   return grid;
+}
+
+void UpdateLooseGrid(LooseGrid& grid, const int32_t* ids, const rect2i32* rects, int numItems) {
+   for (auto i = 0; i < numItems; i++) {
+      auto id = ids[i];
+      if (id < 0) throw std::runtime_error("loose grid ids must be non-negative");
+      if (id >= static_cast<int>(grid.Items.size())) grid.Items.resize(static_cast<size_t>(id) + 1);
+
+      int level, cell;
+      Place(grid, rects[i], OUT level, OUT cell);
+
+      auto& item = grid.Items[id];
+      if (item.Level == level && item.Cell == cell) {
+         EntriesOf(grid, level, cell)[item.Slot].Rect = rects[i];
+         continue;
+      }
+
+      if (item.Level >= 0) Remove(grid, item);
+
+      auto& entries = EntriesOf(grid, level, cell);
+      item.Level = level;
+      item.Cell = cell;
+      item.Slot = static_cast<int>(entries.size());
+      entries.push_back({ id, rects[i] });
+      if (level < static_cast<int>(grid.Levels.size())) grid.Levels[level].NumItems++;
+   }
+}
+
+void RemoveLooseGridItems(LooseGrid& grid, const int32_t* ids, int numIds) {
+   for (auto i = 0; i < numIds; i++) {
+      auto id = ids[i];
+      if (id < 0 || id >= static_cast<int>(grid.Items.size())) continue;
+
+      auto& item = grid.Items[id];
+      if (item.Level >= 0) Remove(grid, item);
+   }
+}
+
+int QueryLooseGrid(const LooseGrid& grid, const rect2i32* queries, int numQueries, int* offsets, int32_t* ids, int idCapacity) {
+   offsets[0] = 0;
+   ParallelFor(numQueries, kQueriesPerTask, [&](int i) {
+      auto count = 0;
+      ForEachIntersectingItem(grid, queries[i], [&](int32_t) { count++; });
+      offsets[i + 1] = count;
+   });
+
+   for (auto i = 0; i < numQueries; i++) offsets[i + 1] += offsets[i];
+   auto numIds = offsets[numQueries];
+   if (numIds > idCapacity) return numIds;
+
+   ParallelFor(numQueries, kQueriesPerTask, [&](int i) {
+      auto out = ids + offsets[i];
+      ForEachIntersectingItem(grid, queries[i], [&](int32_t id) { *out++ = id; });
+   });
+   return numIds;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "geometry.hpp"
+
+// An item as stored in its cell: the rect rides along with the id so a cell scan reads one array.
+typedef struct LooseGridEntry_s {
+   int32_t Id;
+   rect2i32 Rect;
+} LooseGridEntry;
+
+// Cells of CellSize, row-major. An item lives in the cell holding its top-left corner, and is at
+// most CellSize wide and tall, so a cell's items all fit in twice its extent.
+typedef struct LooseGridLevel_s {
+   int CellSize;
+   int Width, Height;
+   int NumItems; // queries skip empty levels
+   std::vector<std::vector<LooseGridEntry>> Cells;
+} LooseGridLevel;
+
+// Where an id's entry is: Cells[Cell][Slot] of Levels[Level], Overflow[Slot] if Level is
+// Levels.size(), or nowhere if Level is -1.
+typedef struct LooseGridItem_s {
+   int Level = -1;
+   int Cell = 0;
+   int Slot = 0;
+} LooseGridItem;
+
+// Native QuadTree<T> for rects that move every frame: a stack of loose grids over the world bounds,
+// cell sizes doubling from minCellSize up to one cell covering everything. An item goes to the
+// finest level whose cells are at least its size, so a move is a rect rewrite in place, or an O(1)
+// swap-remove and append when it changes cell, and nothing is ever subdivided or allocated per node.
+typedef struct LooseGrid_s {
+   int OriginX, OriginY;
+   std::vector<LooseGridLevel> Levels;
+   std::vector<LooseGridEntry> Overflow; // items anchored outside the world or larger than it
+   std::vector<LooseGridItem> Items; // by id
+} LooseGrid;
+
+std::shared_ptr<LooseGrid> LoadLooseGrid(int originX, int originY, int width, int height, int minCellSize);
+
+// Inserts ids[i] at rects[i], or moves it there if already present. Ids index a dense table, so
+// keep them small and non-negative. Must not run concurrently with queries.
+void UpdateLooseGrid(LooseGrid& grid, const int32_t* ids, const rect2i32* rects, int numItems);
+
+// Removes ids that are present and ignores the rest. Must not run concurrently with queries.
+void RemoveLooseGridItems(LooseGrid& grid, const int32_t* ids, int numIds);
+
+// Ids of the items whose rects intersect each query (IntRect2.IntersectsWith), query i's at
+// [offsets[i], offsets[i + 1]), in no particular order. Every query is counted first, and ids are
+// only written if all of them fit in idCapacity; returns the total either way. Runs in parallel.
+int QueryLooseGrid(const LooseGrid& grid, const rect2i32* queries, int numQueries, int* offsets, int32_t* ids, int idCapacity);
@@ -0,0 +1,289 @@
+#include "pch.h"
+#include "overlay_search.hpp"
+#include "parallel.hpp"
+#include "radix_heap.hpp"
+#include <limits>
+
+// Search scratch, pooled per graph. An entry of Costs / Priors is only meaningful if its
+// ReachedGenerations matches the current generation, so starting a query is O(1) rather than
+// O(vertices). Terminals are indexed after the graph's vertices.
+struct SearchWorkspace {
+   uint32_t Generation = 0;
+   std::vector<uint32_t> ReachedGenerations, SettledGenerations;
+   std::vector<float> Costs;
+   std::vector<int32_t> Priors; // >= 0: the prior vertex; < 0: -1 - the seed reaching it
+
+   // Terminal links by crossover, as singly linked lists threaded through TerminalLinkNexts.
+   std::vector<uint32_t> TerminalLinkGenerations;
+   std::vector<int> TerminalLinkHeads, TerminalLinkNexts;
+
+   RadixHeap Heap;
+
+   void Begin(int numIndices) {
+      if (static_cast<int>(ReachedGenerations.size()) < numIndices) {
+         ReachedGenerations.resize(numIndices, 0);
+         SettledGenerations.resize(numIndices, 0);
+         Costs.resize(numIndices);
+         Priors.resize(numIndices);
+         TerminalLinkGenerations.resize(numIndices, 0);
+         TerminalLinkHeads.resize(numIndices);
+      }
+
+      // On wraparound, stale stamps could match again.
+      if (++Generation == 0) {
+         std::fill(ReachedGenerations.begin(), ReachedGenerations.end(), 0);
+         std::fill(SettledGenerations.begin(), SettledGenerations.end(), 0);
+         std::fill(TerminalLinkGenerations.begin(), TerminalLinkGenerations.end(), 0);
+         Generation = 1;
+      }
+      Heap.Clear();
+   }
+
+   FORCEINLINE bool IsSettled(int i) const { return SettledGenerations[i] == Generation; }
+
+   FORCEINLINE void Relax(int i, float cost, int32_t prior) {
+      if (ReachedGenerations[i] == Generation && Costs[i] <= cost) return;
+
+      ReachedGenerations[i] = Generation;
+      Costs[i] = cost;
+      Priors[i] = prior;
+      Heap.Push(KeyOf(cost), i, prior);
+   }
+};
+
+namespace {
+   // Takes an idle workspace from the graph for the scope, or makes one.
+   class BorrowedWorkspace {
+   public:
+      explicit BorrowedWorkspace(const OverlayGraph& graph) : graph(graph) {
+         std::lock_guard<std::mutex> lock(graph.WorkspacesSync);
+         if (graph.IdleWorkspaces.empty()) {
+            workspace = std::make_shared<SearchWorkspace>();
+         } else {
+            workspace = std::move(graph.IdleWorkspaces.back());
+            graph.IdleWorkspaces.pop_back();
+         }
+      }
+
+      ~BorrowedWorkspace() {
+         std::lock_guard<std::mutex> lock(graph.WorkspacesSync);
+         graph.IdleWorkspaces.push_back(std::move(workspace));
+      }
+
+      SearchWorkspace& operator*() const { return *workspace; }
+
+   private:
+      const OverlayGraph& graph;
+      std::shared_ptr<SearchWorkspace> workspace;
+   };
+
+   // Buckets items by key (counting sort): key k's items are order[offsets[k], offsets[k + 1]).
+   template <typename KeyOf>
+   void GroupBy(int numItems, int numKeys, const KeyOf& keyOf, std::vector<int>& offsets, std::vector<int>& order) {
+      offsets.assign(numKeys + 1, 0);
+      for (auto i = 0; i < numItems; i++) offsets[keyOf(i) + 1]++;
+      for (auto k = 0; k < numKeys; k++) offsets[k + 1] += offsets[k];
+
+      order.resize(numItems);
+      std::vector<int> cursors(offsets.begin(), offsets.end() - 1);
+      for (auto i = 0; i < numItems; i++) order[cursors[keyOf(i)]++] = i;
+   }
+
+   // One destination's reversed search: its queries' distinct sources are the terminals.
+   struct DestinationSearch {
+      std::vector<int> Sources; // local terminal j => source
+      std::vector<float> Costs;
+      std::vector<int> PathOffsets;
+      std::vector<dijkstra_seed> PathLinks; // terminal j's path, destination to source
+   };
+
+   void Transpose(const std::vector<int>& offsets, const std::vector<int>& edgeTargets, const std::vector<float>& edgeCosts, int numVertices, OverlayGraph& graph) {
+      graph.ReverseOffsets.assign(numVertices + 1, 0);
+      for (auto target : edgeTargets) graph.ReverseOffsets[target + 1]++;
+      for (auto v = 0; v < numVertices; v++) graph.ReverseOffsets[v + 1] += graph.ReverseOffsets[v];
+
+      graph.ReverseEdgeTargets.resize(edgeTargets.size());
+      graph.ReverseEdgeCosts.resize(edgeCosts.size());
+      std::vector<int> cursors(graph.ReverseOffsets.begin(), graph.ReverseOffsets.end() - 1);
+      for (auto v = 0; v < numVertices; v++) {
+         for (auto e = offsets[v]; e < offsets[v + 1]; e++) {
+            auto slot = cursors[edgeTargets[e]]++;
+            graph.ReverseEdgeTargets[slot] = v;
+            graph.ReverseEdgeCosts[slot] = edgeCosts[e];
+         }
+      }
+   }
+}
+
+std::shared_ptr<OverlayGraph> LoadOverlayGraph(const int* offsets, const int* edgeTargets, const float* edgeCosts, int numVertices) {
+   auto graph = std::make_shared<OverlayGraph>();
+   auto numEdges = offsets[numVertices];
+   graph->NumVertices = numVertices;
+   graph->Offsets.assign(offsets, offsets + numVertices + 1);
+   graph->EdgeTargets.assign(edgeTargets, edgeTargets + numEdges);
+   graph->EdgeCosts.assign(edgeCosts, edgeCosts + numEdges);
+   Transpose(graph->Offsets, graph->EdgeTargets, graph->EdgeCosts, numVertices, *graph);
+   return graph;
+}
+
+void UniformCostSearch(
+   const OverlayGraph& graph, bool followEdgesReversed,
+   const dijkstra_seed* seeds, int numSeeds,
+   const dijkstra_seed* terminalLinks, int numTerminalLinks, int numDestinations,
+   float* destinationCosts, int* pathOffsets, std::vector<dijkstra_seed>& pathLinks
+) {
+   const auto& offsets = followEdgesReversed ? graph.ReverseOffsets : graph.Offsets;
+   const auto& edgeTargets = followEdgesReversed ? graph.ReverseEdgeTargets : graph.EdgeTargets;
+   const auto& edgeCosts = followEdgesReversed ? graph.ReverseEdgeCosts : graph.EdgeCosts;
+
+   // Vertex or terminal (-1 - d) => workspace index and back.
+   const auto numVertices = graph.NumVertices;
+   auto indexOf = [numVertices](int32_t id) { return id >= 0 ? id : numVertices - 1 - id; };
+   auto idOf = [numVertices](int index) { return index < numVertices ? index : numVertices - 1 - index; };
+
+   BorrowedWorkspace borrowed(graph);
+   auto& ws = *borrowed;
+   ws.Begin(numVertices + numDestinations);
+
+   ws.TerminalLinkNexts.resize(numTerminalLinks);
+   for (auto i = 0; i < numTerminalLinks; i++) {
+      auto crossover = terminalLinks[i].prior;
+      ws.TerminalLinkNexts[i] = ws.TerminalLinkGenerations[crossover] == ws.Generation ? ws.TerminalLinkHeads[crossover] : -1;
+      ws.TerminalLinkGenerations[crossover] = ws.Generation;
+      ws.TerminalLinkHeads[crossover] = i;
+   }
+
+   for (auto i = 0; i < numSeeds; i++) {
+      ws.Relax(indexOf(seeds[i].current), seeds[i].totalCost, -1 - i);
+   }
+
+   auto destinationsRemaining = numDestinations;
+   while (!ws.Heap.IsEmpty() && destinationsRemaining > 0) {
+      // no-op if already settled
+      auto x = ws.Heap.Pop();
+      auto current = x.Node;
+      if (ws.IsSettled(current)) continue;
+
+      ws.SettledGenerations[current] = ws.Generation;
+      ws.Priors[current] = x.Prior;
+      auto totalCost = CostOf(x.Key);
+      ws.Costs[current] = totalCost;
+
+      if (current >= numVertices) {
+         destinationsRemaining--;
+         continue;
+      }
+
+      for (auto e = offsets[current], end = offsets[current + 1]; e < end; e++) {
+         auto next = edgeTargets[e];
+         if (!ws.IsSettled(next)) ws.Relax(next, totalCost + edgeCosts[e], current);
+      }
+
+      if (ws.TerminalLinkGenerations[current] == ws.Generation) {
+         for (auto i = ws.TerminalLinkHeads[current]; i != -1; i = ws.TerminalLinkNexts[i]) {
+            auto terminal = indexOf(terminalLinks[i].current);
+            if (!ws.IsSettled(terminal)) ws.Relax(terminal, totalCost + terminalLinks[i].totalCost, current);
+         }
+      }
+   }
+
+   // Backtrack each reached terminal to its seed.
+   pathLinks.clear();
+   for (auto d = 0; d < numDestinations; d++) {
+      pathOffsets[d] = static_cast<int>(pathLinks.size());
+
+      auto terminal = numVertices + d;
+      if (!ws.IsSettled(terminal)) {
+         destinationCosts[d] = std::numeric_limits<float>::infinity();
+         continue;
+      }
+      destinationCosts[d] = ws.Costs[terminal];
+
+      auto pathBegin = pathLinks.size();
+      for (auto i = terminal; ; i = ws.Priors[i]) {
+         auto prior = ws.Priors[i];
+         auto priorId = prior >= 0 ? idOf(prior) : seeds[-1 - prior].prior;
+         pathLinks.push_back({ priorId, idOf(i), ws.Costs[i] });
+         if (prior < 0) break;
+      }
+      std::reverse(pathLinks.begin() + pathBegin, pathLinks.end());
+   }
+   pathOffsets[numDestinations] = static_cast<int>(pathLinks.size());
+}
+
+void BatchPathQueries(
+   const OverlayGraph& graph,
+   const dijkstra_seed* sourceLinks, int numSourceLinks, int numSources,
+   const dijkstra_seed* destinationLinks, int numDestinationLinks, int numDestinations,
+   const pair2i32* queries, int numQueries,
+   float* costs, int* pathOffsets, std::vector<dijkstra_seed>& pathLinks
+) {
+   std::vector<int> sourceLinkOffsets, sourceLinkOrder, destinationLinkOffsets, destinationLinkOrder, queryOffsets, queryOrder;
+   GroupBy(numSourceLinks, numSources, [&](int i) { return -1 - sourceLinks[i].current; }, sourceLinkOffsets, sourceLinkOrder);
+   GroupBy(numDestinationLinks, numDestinations, [&](int i) { return -1 - destinationLinks[i].current; }, destinationLinkOffsets, destinationLinkOrder);
+   GroupBy(numQueries, numDestinations, [&](int q) { return queries[q].b; }, queryOffsets, queryOrder);
+
+   // Queries of destination d run from queryOffsets[d]; localOfQuery maps each to its terminal.
+   std::vector<DestinationSearch> searches(numDestinations);
+   std::vector<int> localOfQuery(numQueries);
+   ParallelFor(numDestinations, 1, [&](int d) {
+      auto queriesBegin = queryOffsets[d], queriesEnd = queryOffsets[d + 1];
+      if (queriesBegin == queriesEnd) return;
+
+      // Walking from the destination backwards: its links seed, sources' links terminate.
+      std::vector<dijkstra_seed> seeds;
+      for (auto i = destinationLinkOffsets[d]; i < destinationLinkOffsets[d + 1]; i++) {
+         const auto& link = destinationLinks[destinationLinkOrder[i]];
+         seeds.push_back({ link.current, link.prior, link.totalCost });
+      }
+
+      auto& search = searches[d];
+      std::sort(queryOrder.begin() + queriesBegin, queryOrder.begin() + queriesEnd, [&](int a, int b) {
+         return queries[a].a < queries[b].a;
+      });
+
+      std::vector<dijkstra_seed> terminalLinks;
+      for (auto i = queriesBegin; i < queriesEnd; i++) {
+         auto q = queryOrder[i];
+         auto source = queries[q].a;
+         if (search.Sources.empty() || search.Sources.back() != source) {
+            auto local = static_cast<int>(search.Sources.size());
+            search.Sources.push_back(source);
+            for (auto j = sourceLinkOffsets[source]; j < sourceLinkOffsets[source + 1]; j++) {
+               const auto& link = sourceLinks[sourceLinkOrder[j]];
+               terminalLinks.push_back({ link.prior, -1 - local, link.totalCost });
+            }
+         }
+         localOfQuery[q] = static_cast<int>(search.Sources.size()) - 1;
+      }
+
+      auto numLocal = static_cast<int>(search.Sources.size());
+      search.Costs.resize(numLocal);
+      search.PathOffsets.resize(numLocal + 1);
+      ::UniformCostSearch(
+         graph, true, seeds.data(), static_cast<int>(seeds.size()),
+         terminalLinks.data(), static_cast<int>(terminalLinks.size()), numLocal,
+         search.Costs.data(), search.PathOffsets.data(), search.PathLinks);
+   });
+
+   // Flip each reversed path: a link's forward cost is the total less its cost to the destination.
+   pathLinks.clear();
+   for (auto q = 0; q < numQueries; q++) {
+      pathOffsets[q] = static_cast<int>(pathLinks.size());
+
+      const auto& search = searches[queries[q].b];
+      auto local = localOfQuery[q];
+      auto total = search.Costs[local];
+      costs[q] = total;
+
+      auto begin = search.PathOffsets[local], end = search.PathOffsets[local + 1];
+      for (auto i = end - 1; i >= begin; i--) {
+         const auto& link = search.PathLinks[i];
+         auto prior = i == end - 1 ? kSourcePointId : link.current;
+         auto current = i == begin ? -1 - queries[q].b : link.prior;
+         auto totalCost = i == begin ? total : total - search.PathLinks[i - 1].totalCost;
+         pathLinks.push_back({ prior, current, totalCost });
+      }
+   }
+   pathOffsets[numQueries] = static_cast<int>(pathLinks.size());
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "dijkstras.hpp"
+#include "geometry.hpp"
+
+struct SearchWorkspace;
+
+// The terrain overlay network flattened for searching. Vertex v is one crossover point of one
+// overlay node; edges are both optimal links between a node's crossovers and the edges joining
+// crossovers of neighboring nodes, with world-space costs. Kept in both directions so searches
+// can follow edges reversed.
+typedef struct OverlayGraph_s {
+   int NumVertices;
+   std::vector<int> Offsets, EdgeTargets;
+   std::vector<float> EdgeCosts;
+   std::vector<int> ReverseOffsets, ReverseEdgeTargets;
+   std::vector<float> ReverseEdgeCosts;
+
+   // Idle search scratch, sized for this graph. Searches take one and put it back, so workers
+   // of every batch reuse the same few instead of growing one per short-lived thread.
+   mutable std::mutex WorkspacesSync;
+   mutable std::vector<std::shared_ptr<SearchWorkspace>> IdleWorkspaces;
+} OverlayGraph;
+
+// Copies a CSR graph (vertex i's edges are [offsets[i], offsets[i + 1])) and its transpose.
+std::shared_ptr<OverlayGraph> LoadOverlayGraph(const int* offsets, const int* edgeTargets, const float* edgeCosts, int numVertices);
+
+FORCEINLINE bool IsOverlayVertex(const OverlayGraph& graph, int32_t id) {
+   return id >= 0 && id < graph.NumVertices;
+}
+
+// Terminal -1 - d of one of numTerminals destinations (or, in batches, sources).
+FORCEINLINE bool IsOverlayTerminal(int32_t id, int numTerminals) {
+   return id < 0 && -1 - id < numTerminals;
+}
+
+// Managed PathfinderCalculator.UniformCostSearch over a loaded graph. Destination d is the
+// terminal -1 - d (the managed destination cpi), reached through terminal links
+// { crossover, -1 - d, cost }. Seeds { prior, current, cost } start the search at a crossover
+// or, for a destination sharing the source's node, directly at its terminal; seed priors are
+// passed through untouched.
+//
+// Stops once every destination is reached. Writes each destination's cost (+inf if
+// unreachable) and appends its path to pathLinks as { prior, current, totalCost } records from
+// its seed to its terminal; destination d's path is [pathOffsets[d], pathOffsets[d + 1]).
+// Scratch state is borrowed from the graph and reset by bumping a generation, so a query only
+// touches the vertices it reaches.
+void UniformCostSearch(
+   const OverlayGraph& graph, bool followEdgesReversed,
+   const dijkstra_seed* seeds, int numSeeds,
+   const dijkstra_seed* terminalLinks, int numTerminalLinks, int numDestinations,
+   float* destinationCosts, int* pathOffsets, std::vector<dijkstra_seed>& pathLinks);
+
+// Managed SOURCE_POINT_CPI: the prior of a batch path's first link.
+constexpr int32_t kSourcePointId = INT32_MIN;
+
+// Answers queries (source a, destination b) by grouping them by destination and running one
+// reversed UniformCostSearch per distinct destination, in parallel. Source s's links are
+// { crossover, -1 - s, cost } for walking from s to the crossover; destination d's links are
+// { crossover, -1 - d, cost } for walking from the crossover to d. Writes each query's cost
+// (+inf if unreachable) and its path from kSourcePointId to -1 - d, in the same format as
+// UniformCostSearch, to [pathOffsets[q], pathOffsets[q + 1]). Same-node shortcuts between a
+// source and destination are the caller's to check.
+void BatchPathQueries(
+   const OverlayGraph& graph,
+   const dijkstra_seed* sourceLinks, int numSourceLinks, int numSources,
+   const dijkstra_seed* destinationLinks, int numDestinationLinks, int numDestinations,
+   const pair2i32* queries, int numQueries,
+   float* costs, int* pathOffsets, std::vector<dijkstra_seed>& pathLinks);
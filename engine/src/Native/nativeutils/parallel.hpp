@@ -0,0 +1,31 @@
+#pragma once
+
+#include <atomic>
+#include <thread>
+
+// Calls body(i) for every i in [0, count). Indices are handed out chunkSize at a time to
+// up to hardware_concurrency threads (the caller's included). Runs inline if there's only
+// one chunk. body must be safe to call concurrently for distinct i.
+template <typename Body>
+void ParallelFor(int count, int chunkSize, const Body& body) {
+   auto numChunks = (count + chunkSize - 1) / chunkSize;
+   auto numThreads = std::min(numChunks, static_cast<int>(std::max(1u, std::thread::hardware_concurrency())));
+   if (numThreads <= 1) {
+      for (auto i = 0; i < count; i++) body(i);
+      return;
+   }
+
+   std::atomic<int> nextChunk{ 0 };
+   auto worker = [&]() {
+      for (auto chunk = nextChunk++; chunk < numChunks; chunk = nextChunk++) {
+         auto end = std::min(count, (chunk + 1) * chunkSize);
+         for (auto i = chunk * chunkSize; i < end; i++) body(i);
+      }
+   };
+
+   std::vector<std::thread> threads;
+   threads.reserve(numThreads - 1);
+   for (auto t = 1; t < numThreads; t++) threads.emplace_back(worker);
+   worker();
+   for (auto& thread : threads) thread.join();
+}
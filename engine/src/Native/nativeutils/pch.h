@@ -19,6 +19,8 @@
 enum class ApiResult : int {
    Success = 0,
    ErrorUnknownHandle = -100,
+   ErrorInsufficientBuffer = -101, // output didn't fit; the required count is still reported
+   ErrorInvalidArgument = -102, // an index or count doesn't match the handle's object
    ErrorUnknown = -999
 };
 
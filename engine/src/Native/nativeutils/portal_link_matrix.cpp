@@ -0,0 +1,71 @@
+#include "pch.h"
+#include "portal_link_matrix.hpp"
+
+namespace {
+   FORCEINLINE int NumPoints(const PortalLinkMatrix& matrix, int portal) {
+      return matrix.PortalPointOffsets[portal + 1] - matrix.PortalPointOffsets[portal];
+   }
+}
+
+void PlanPortalLinkMatrix(const int* portalPointOffsets, int numPortals, OUT PortalLinkMatrix& matrix) {
+   matrix.NumPortals = numPortals;
+   matrix.PortalPointOffsets.assign(portalPointOffsets, portalPointOffsets + numPortals + 1);
+
+   matrix.PairWordOffsets.assign(1, 0);
+   for (auto a = 0; a < numPortals; a++) {
+      for (auto b = a + 1; b < numPortals; b++) {
+         auto numLinks = static_cast<size_t>(NumPoints(matrix, a)) * NumPoints(matrix, b);
+         matrix.PairWordOffsets.push_back(matrix.PairWordOffsets.back() + (numLinks + 63) / 64);
+      }
+   }
+   matrix.VisibleBits.assign(matrix.PairWordOffsets.back(), 0);
+}
+
+void PackPortalPairLinks(PortalLinkMatrix& matrix, int a, int b, const uint8_t* linkOccluded) {
+   auto pair = PortalPairIndex(matrix.NumPortals, a, b);
+   auto words = matrix.VisibleBits.data() + matrix.PairWordOffsets[pair];
+   std::fill(words, matrix.VisibleBits.data() + matrix.PairWordOffsets[pair + 1], 0);
+
+   auto numLinks = static_cast<size_t>(NumPoints(matrix, a)) * NumPoints(matrix, b);
+   for (size_t l = 0; l < numLinks; l++) {
+      if (!linkOccluded[l]) words[l / 64] |= 1ull << (l % 64);
+   }
+}
+
+std::shared_ptr<PortalLinkMatrix> LoadPortalLinkMatrix(const int* portalPointOffsets, int numPortals, const uint64_t* visibleBits) {
+   auto matrix = std::make_shared<PortalLinkMatrix>();
+   PlanPortalLinkMatrix(portalPointOffsets, numPortals, OUT *matrix);
+   std::copy_n(visibleBits, matrix->VisibleBits.size(), matrix->VisibleBits.begin());
+   return matrix;
+}
+
+int CountVisibleLinks(const PortalLinkMatrix& matrix, int a, int b) {
+   if (a == b) return 0;
+   if (a > b) std::swap(a, b);
+
+   auto pair = PortalPairIndex(matrix.NumPortals, a, b);
+   auto count = 0;
+   for (auto w = matrix.PairWordOffsets[pair]; w < matrix.PairWordOffsets[pair + 1]; w++) {
+      count += static_cast<int>(_mm_popcnt_u64(matrix.VisibleBits[w]));
+   }
+   return count;
+}
+
+void QueryVisibleLinks(const PortalLinkMatrix& matrix, int a, int b, std::vector<pair2i32>& links) {
+   if (a == b) return;
+
+   auto swapped = a > b;
+   if (swapped) std::swap(a, b);
+
+   auto pair = PortalPairIndex(matrix.NumPortals, a, b);
+   auto numColumns = NumPoints(matrix, b);
+   auto begin = matrix.PairWordOffsets[pair];
+   for (auto w = begin; w < matrix.PairWordOffsets[pair + 1]; w++) {
+      // Clear the lowest set bit until the word runs out.
+      for (auto word = matrix.VisibleBits[w]; word; word &= word - 1) {
+         auto l = static_cast<int>((w - begin) * 64 + _tzcnt_u64(word));
+         auto i = l / numColumns, j = l % numColumns;
+         links.push_back(swapped ? pair2i32{ j, i } : pair2i32{ i, j });
+      }
+   }
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "geometry.hpp"
+
+// Managed SectorCompilationOutput.PortalPointLinkStates as one bit per link, set if the link
+// is visible. Pair (a, b), a < b, holds a's points by b's points row-major, starting at word
+// PairWordOffsets[pair] so pairs can be scanned and counted a word at a time.
+typedef struct PortalLinkMatrix_s {
+   int NumPortals;
+   std::vector<int> PortalPointOffsets;
+   std::vector<size_t> PairWordOffsets; // numPairs + 1 entries, pairs in (a, b) lexicographic order
+   std::vector<uint64_t> VisibleBits;
+} PortalLinkMatrix;
+
+// Lays out the matrix for the given portals with every link occluded. Portal i's points are
+// [portalPointOffsets[i], portalPointOffsets[i + 1]).
+void PlanPortalLinkMatrix(const int* portalPointOffsets, int numPortals, OUT PortalLinkMatrix& matrix);
+
+// Sets the bits of pair (a, b), a < b, from one byte per link, nonzero if occluded, as
+// QueryAnyIntersections writes them. Pairs own whole words, so different pairs can be packed
+// concurrently.
+void PackPortalPairLinks(PortalLinkMatrix& matrix, int a, int b, const uint8_t* linkOccluded);
+
+// A matrix over already packed bits, e.g. a CompileSector blob's link section copied back in.
+std::shared_ptr<PortalLinkMatrix> LoadPortalLinkMatrix(const int* portalPointOffsets, int numPortals, const uint64_t* visibleBits);
+
+// Position of pair (a, b), a < b, in the lexicographic pair order.
+FORCEINLINE int PortalPairIndex(int numPortals, int a, int b) {
+   return a * (2 * numPortals - a - 1) / 2 + (b - a - 1);
+}
+
+// Whether the link-th link (row-major) of pair (a, b), a < b, is visible.
+FORCEINLINE bool IsLinkVisible(const PortalLinkMatrix& matrix, int a, int b, size_t link) {
+   auto words = matrix.VisibleBits.data() + matrix.PairWordOffsets[PortalPairIndex(matrix.NumPortals, a, b)];
+   return (words[link / 64] >> (link % 64)) & 1;
+}
+
+FORCEINLINE bool IsPortalIndex(const PortalLinkMatrix& matrix, int portal) {
+   return portal >= 0 && portal < matrix.NumPortals;
+}
+
+// Number of visible links between portals a and b (either order); a == b counts none.
+int CountVisibleLinks(const PortalLinkMatrix& matrix, int a, int b);
+
+// Appends each visible link between portals a and b as { i, j }: a's i-th point sees b's j-th
+// point. Links are ordered by the lower-numbered portal's point, then the other's.
+void QueryVisibleLinks(const PortalLinkMatrix& matrix, int a, int b, std::vector<pair2i32>& links);
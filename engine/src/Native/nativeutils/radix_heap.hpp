@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstring>
+
+// Non-negative floats order the same as their bit patterns, which makes them radix heap keys.
+FORCEINLINE uint32_t KeyOf(float cost) {
+   auto normalized = cost + 0.0f; // -0 => +0
+   uint32_t key;
+   std::memcpy(&key, &normalized, sizeof(key));
+   return key;
+}
+
+FORCEINLINE float CostOf(uint32_t key) {
+   float cost;
+   std::memcpy(&cost, &key, sizeof(cost));
+   return cost;
+}
+
+// Monotone priority queue: pushed keys must be >= the last popped key, which Dijkstra
+// guarantees with non-negative edges. Entries live in bucket i if they first differ from
+// the last popped key at bit i - 1, so a pop only rescans the lowest non-empty bucket.
+// Buckets keep their capacity across Clear() so reruns don't allocate.
+class RadixHeap {
+public:
+   struct Entry {
+      uint32_t Key;
+      int32_t Node;
+      int32_t Prior;
+   };
+
+private:
+   std::vector<Entry> buckets[33];
+   uint32_t last = 0;
+   int size = 0;
+
+   FORCEINLINE static int BucketOf(uint32_t key, uint32_t last) {
+      return key == last ? 0 : 32 - static_cast<int>(_lzcnt_u32(key ^ last));
+   }
+
+public:
+   bool IsEmpty() const { return size == 0; }
+
+   void Clear() {
+      for (auto& bucket : buckets) bucket.clear();
+      last = 0;
+      size = 0;
+   }
+
+   FORCEINLINE void Push(uint32_t key, int32_t node, int32_t prior) {
+      buckets[BucketOf(key, last)].push_back({ key, node, prior });
+      size++;
+   }
+
+   Entry Pop() {
+      if (buckets[0].empty()) {
+         auto b = 1;
+         while (buckets[b].empty()) b++;
+
+         auto& bucket = buckets[b];
+         auto newLast = bucket[0].Key;
+         for (const auto& e : bucket) newLast = std::min(newLast, e.Key);
+
+         // Every entry lands in a strictly lower bucket.
+         last = newLast;
+         for (const auto& e : bucket) buckets[BucketOf(e.Key, last)].push_back(e);
+         bucket.clear();
+      }
+
+      auto e = buckets[0].back();
+      buckets[0].pop_back();
+      size--;
+      return e;
+   }
+};
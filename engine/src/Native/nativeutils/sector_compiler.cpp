@@ -0,0 +1,107 @@
+#include "pch.h"
+#include "sector_compiler.hpp"
+#include "dllmain.hpp"
+#include "parallel.hpp"
+
+#include <future>
+
+namespace {
+   constexpr int kBlobAlignment = 16;
+
+   FORCEINLINE int AlignBlobOffset(int offset) {
+      return (offset + kBlobAlignment - 1) & ~(kBlobAlignment - 1);
+   }
+
+   // Portal pairs a < b in link matrix order.
+   std::vector<pair2i32> PlanPortalPairs(int numPortals) {
+      std::vector<pair2i32> pairs;
+      for (auto a = 0; a < numPortals; a++) {
+         for (auto b = a + 1; b < numPortals; b++) pairs.push_back({ a, b });
+      }
+      return pairs;
+   }
+
+   // Null if there are no barriers, in which case nothing is occluded.
+   std::shared_ptr<Avx2IntersectionPrequeryState> LoadBarriers(const std::vector<seg2i32>& barriers) {
+      if (barriers.empty()) return nullptr;
+      return ::LoadPrequeryBarriersIntersectionState(barriers.data(), static_cast<int>(barriers.size()));
+   }
+
+   // The query kernel writes a byte per link; that only lives as long as one pair's queries
+   // before it's packed into the matrix.
+   void QueryPortalPairLinks(const point2i32* portalPoints, const int* portalPointOffsets, pair2i32 pair, const std::shared_ptr<Avx2IntersectionPrequeryState>& prequeryState, PortalLinkMatrix& links) {
+      auto [a, b] = pair;
+      std::vector<seg2i16> queries;
+      queries.reserve(static_cast<size_t>(portalPointOffsets[a + 1] - portalPointOffsets[a]) * (portalPointOffsets[b + 1] - portalPointOffsets[b]));
+      for (auto i = portalPointOffsets[a]; i < portalPointOffsets[a + 1]; i++) {
+         for (auto j = portalPointOffsets[b]; j < portalPointOffsets[b + 1]; j++) {
+            queries.push_back(ToSeg2i16(portalPoints[i].x, portalPoints[i].y, portalPoints[j].x, portalPoints[j].y));
+         }
+      }
+
+      std::vector<uint8_t> occluded(queries.size(), 0);
+      if (prequeryState && !queries.empty()) {
+         ::QueryAnyIntersections(prequeryState, queries.data(), static_cast<int>(queries.size()), occluded.data());
+      }
+      PackPortalPairLinks(links, a, b, occluded.data());
+   }
+
+   void ComputeLinks(const point2i32* portalPoints, const int* portalPointOffsets, int numPortals, const std::vector<seg2i32>& barriers, OUT PortalLinkMatrix& links) {
+      PlanPortalLinkMatrix(portalPointOffsets, numPortals, OUT links);
+      auto pairs = PlanPortalPairs(numPortals);
+
+      auto prequeryState = LoadBarriers(barriers);
+      ParallelFor(static_cast<int>(pairs.size()), 1, [&](int pair) {
+         QueryPortalPairLinks(portalPoints, portalPointOffsets, pairs[pair], prequeryState, links);
+      });
+   }
+}
+
+void CompileSector(
+   const point2i32* points, const int* contourOffsets, const int* contourParents, int numContours,
+   const point2i32* portalPoints, const int* portalPointOffsets, int numPortals, int exaggerationFactor,
+   OUT SectorCompilation& result
+) {
+   // Triangulation only needs the land, so it overlaps the barrier -> link state chain.
+   auto triangulation = std::async(std::launch::async, [&]() {
+      ::TriangulatePolygonTree(points, contourOffsets, contourParents, numContours, OUT result.Triangulation);
+   });
+
+   CalculateContourBarriers(points, contourOffsets, numContours, exaggerationFactor, OUT result.Barriers);
+   ComputeLinks(portalPoints, portalPointOffsets, numPortals, result.Barriers, OUT result.Links);
+
+   triangulation.get();
+}
+
+int PackSectorCompilation(const SectorCompilation& compilation, uint8_t* blob, int blobCapacity) {
+   const auto& triangulation = compilation.Triangulation;
+
+   sector_compilation_header header;
+   header.numBarriers = static_cast<int32_t>(compilation.Barriers.size());
+   header.numLinkWords = static_cast<int32_t>(compilation.Links.VisibleBits.size());
+   header.numContours = static_cast<int32_t>(triangulation.ContourTriangleOffsets.size()) - 1;
+   header.numTriangles = triangulation.ContourTriangleOffsets.back();
+
+   auto size = AlignBlobOffset(sizeof(sector_compilation_header));
+   auto reserve = [&](int bytes) {
+      auto offset = size;
+      size = AlignBlobOffset(size + bytes);
+      return offset;
+   };
+   header.barriersOffset = reserve(header.numBarriers * sizeof(seg2i32));
+   header.linkVisibleBitsOffset = reserve(header.numLinkWords * sizeof(uint64_t));
+   header.contourTriangleOffsetsOffset = reserve((header.numContours + 1) * sizeof(int32_t));
+   header.triangleVerticesOffset = reserve(3 * header.numTriangles * sizeof(int32_t));
+   header.triangleNeighborsOffset = reserve(3 * header.numTriangles * sizeof(int32_t));
+   header.neighborSharedEdgesOffset = reserve(3 * header.numTriangles * sizeof(int32_t));
+   if (size > blobCapacity) return size;
+
+   std::memcpy(blob, &header, sizeof(header));
+   std::copy(compilation.Barriers.begin(), compilation.Barriers.end(), reinterpret_cast<seg2i32*>(blob + header.barriersOffset));
+   std::copy(compilation.Links.VisibleBits.begin(), compilation.Links.VisibleBits.end(), reinterpret_cast<uint64_t*>(blob + header.linkVisibleBitsOffset));
+   std::copy(triangulation.ContourTriangleOffsets.begin(), triangulation.ContourTriangleOffsets.end(), reinterpret_cast<int32_t*>(blob + header.contourTriangleOffsetsOffset));
+   std::copy(triangulation.TriangleVertices.begin(), triangulation.TriangleVertices.end(), reinterpret_cast<int32_t*>(blob + header.triangleVerticesOffset));
+   std::copy(triangulation.TriangleNeighbors.begin(), triangulation.TriangleNeighbors.end(), reinterpret_cast<int32_t*>(blob + header.triangleNeighborsOffset));
+   std::copy(triangulation.NeighborSharedEdges.begin(), triangulation.NeighborSharedEdges.end(), reinterpret_cast<int32_t*>(blob + header.neighborSharedEdgesOffset));
+   return size;
+}
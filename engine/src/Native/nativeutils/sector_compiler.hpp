@@ -0,0 +1,44 @@
+#pragma once
+
+#include "barrier_calculator.hpp"
+#include "constrained_delaunay.hpp"
+#include "portal_link_matrix.hpp"
+
+// Everything SectorCompiler.Compile derives from a sector's punched land. Stages allocate their
+// own storage on the heap rather than from a per-compile arena: results outlive the compile
+// until they're packed, and the triangulation and barrier stages are the shared
+// constrained_delaunay / barrier_calculator entry points, whose buffers are std::vectors sized
+// up front or grown geometrically.
+typedef struct SectorCompilation_s {
+   std::vector<seg2i32> Barriers;
+   PortalLinkMatrix Links;
+   PolygonTreeTriangulation Triangulation;
+} SectorCompilation;
+
+// Barriers, then portal point link states against them, packed a bit per link as each portal
+// pair's queries finish, alongside the triangulation,
+// which runs concurrently. Portal i's points are [portalPointOffsets[i], portalPointOffsets[i + 1]).
+// Coordinates must fit in int16 for the link state queries.
+void CompileSector(
+   const point2i32* points, const int* contourOffsets, const int* contourParents, int numContours,
+   const point2i32* portalPoints, const int* portalPointOffsets, int numPortals, int exaggerationFactor,
+   OUT SectorCompilation& result);
+
+// Header of PackSectorCompilation's blob. Offsets are in bytes from the start of the blob and
+// 16-byte aligned.
+typedef struct sector_compilation_header_s {
+   int32_t numBarriers;
+   int32_t barriersOffset; // seg2i32[numBarriers]
+   int32_t numLinkWords;
+   int32_t linkVisibleBitsOffset; // uint64_t[numLinkWords], PortalLinkMatrix::VisibleBits
+   int32_t numContours;
+   int32_t contourTriangleOffsetsOffset; // int32_t[numContours + 1]
+   int32_t numTriangles;
+   int32_t triangleVerticesOffset; // int32_t[3 * numTriangles], as are the next two
+   int32_t triangleNeighborsOffset;
+   int32_t neighborSharedEdgesOffset;
+} sector_compilation_header;
+
+// Writes the compilation into one contiguous blob if it fits in blobCapacity bytes. Returns the
+// blob's size either way.
+int PackSectorCompilation(const SectorCompilation& compilation, uint8_t* blob, int blobCapacity);
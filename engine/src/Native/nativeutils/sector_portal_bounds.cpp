@@ -0,0 +1,177 @@
+#include "pch.h"
+#include "sector_portal_bounds.hpp"
+#include "dijkstras.hpp"
+#include "dllmain.hpp"
+#include "parallel.hpp"
+#include <limits>
+
+namespace {
+   constexpr float kInfinity = std::numeric_limits<float>::infinity();
+
+   // Portal points per task when finding waypoint routes.
+   constexpr int kPointsPerTask = 8;
+
+   // Bounds are sums of rounded floats; don't let rounding drop the optimal path's sectors.
+   constexpr float kCorridorSlack = 1.0f + 1e-5f;
+
+   FORCEINLINE float Distance(point2i32 a, point2i32 b) {
+      auto dx = static_cast<float>(b.x - a.x);
+      auto dy = static_cast<float>(b.y - a.y);
+      return std::sqrt(dx * dx + dy * dy);
+   }
+}
+
+void ComputeSectorPortalDistanceBounds(
+   const point2i32* portalPoints, const int* portalPointOffsets, int numPortals, const PortalLinkMatrix& links,
+   const point2i32* waypoints, int numWaypoints, const float* waypointCosts,
+   const seg2i32* barriers, int numBarriers,
+   distance_bounds* bounds
+) {
+   const auto numPoints = portalPointOffsets[numPortals];
+   const auto w = numWaypoints;
+
+   // Cost from each portal point straight to each waypoint it sees (+inf if it can't), then
+   // through the LUT to each waypoint: routes[p * w + v] = min over u of toWaypoints[p * w + u] + lut[u][v].
+   std::vector<float> toWaypoints(static_cast<size_t>(numPoints) * w);
+   std::vector<float> routes(static_cast<size_t>(numPoints) * w, kInfinity);
+
+   std::shared_ptr<Avx2IntersectionPrequeryState> prequeryState;
+   if (numBarriers > 0) {
+      std::vector<seg2i16> barriers16(numBarriers);
+      for (auto i = 0; i < numBarriers; i++) {
+         const auto& b = barriers[i];
+         barriers16[i] = ToSeg2i16(b.x1, b.y1, b.x2, b.y2);
+      }
+      prequeryState = ::LoadPrequeryBarriersIntersectionState(barriers16.data(), numBarriers);
+   }
+
+   ParallelFor(numPoints, kPointsPerTask, [&](int p) {
+      const auto pp = portalPoints[p];
+      auto pToWaypoints = toWaypoints.data() + static_cast<size_t>(p) * w;
+      auto pRoutes = routes.data() + static_cast<size_t>(p) * w;
+
+      std::vector<uint8_t> occluded(w, 0);
+      if (prequeryState && w > 0) {
+         std::vector<seg2i16> queries(w);
+         for (auto u = 0; u < w; u++) queries[u] = ToSeg2i16(pp.x, pp.y, waypoints[u].x, waypoints[u].y);
+         ::QueryAnyIntersections(prequeryState, queries.data(), w, occluded.data());
+      }
+
+      for (auto u = 0; u < w; u++) {
+         pToWaypoints[u] = occluded[u] ? kInfinity : Distance(pp, waypoints[u]);
+      }
+
+      for (auto u = 0; u < w; u++) {
+         auto entry = pToWaypoints[u];
+         if (entry == kInfinity) continue;
+
+         const auto lutRow = waypointCosts + static_cast<size_t>(u) * w;
+         for (auto v = 0; v < w; v++) pRoutes[v] = std::min(pRoutes[v], entry + lutRow[v]);
+      }
+   });
+
+   std::vector<std::pair<int, int>> portalPairs;
+   for (auto a = 0; a < numPortals; a++) {
+      bounds[a * numPortals + a] = { 0.0f, 0.0f };
+      for (auto b = a + 1; b < numPortals; b++) portalPairs.push_back({ a, b });
+   }
+
+   ParallelFor(static_cast<int>(portalPairs.size()), 1, [&](int k) {
+      auto [a, b] = portalPairs[k];
+      size_t link = 0;
+
+      distance_bounds res = { kInfinity, 0.0f };
+      for (auto p = portalPointOffsets[a]; p < portalPointOffsets[a + 1]; p++) {
+         const auto pRoutes = routes.data() + static_cast<size_t>(p) * w;
+         for (auto q = portalPointOffsets[b]; q < portalPointOffsets[b + 1]; q++, link++) {
+            auto cost = IsLinkVisible(links, a, b, link) ? Distance(portalPoints[p], portalPoints[q]) : kInfinity;
+
+            const auto qToWaypoints = toWaypoints.data() + static_cast<size_t>(q) * w;
+            for (auto v = 0; v < w; v++) cost = std::min(cost, pRoutes[v] + qToWaypoints[v]);
+
+            res.lower = std::min(res.lower, cost);
+            res.upper = std::max(res.upper, cost);
+         }
+      }
+
+      bounds[a * numPortals + b] = res;
+      bounds[b * numPortals + a] = res;
+   });
+}
+
+void FindSectorCorridor(
+   int numPortals, const int* sectorPortalOffsets, const int* sectorPortals, int numSectors, const distance_bounds* sectorBounds,
+   const int* sourcePortals, const distance_bounds* sourceLinks, int numSourceLinks,
+   const int* destinationPortals, const distance_bounds* destinationLinks, int numDestinationLinks,
+   uint8_t* portalInCorridor, uint8_t* sectorInCorridor, OUT float& upperBound
+) {
+   // Portal graph: every ordered pair of a sector's portals, remembering the sector.
+   std::vector<int> offsets(numPortals + 1, 0), edgeTargets, edgeSectors;
+   std::vector<float> lowerCosts, upperCosts;
+   for (auto s = 0; s < numSectors; s++) {
+      auto begin = sectorPortalOffsets[s], k = sectorPortalOffsets[s + 1] - begin;
+      for (auto i = 0; i < k; i++) offsets[sectorPortals[begin + i] + 1] += k - 1;
+   }
+   for (auto v = 0; v < numPortals; v++) offsets[v + 1] += offsets[v];
+
+   edgeTargets.resize(offsets[numPortals]);
+   edgeSectors.resize(offsets[numPortals]);
+   lowerCosts.resize(offsets[numPortals]);
+   upperCosts.resize(offsets[numPortals]);
+
+   std::vector<int> cursors(offsets.begin(), offsets.end() - 1);
+   for (auto s = 0, matrixOffset = 0; s < numSectors; s++) {
+      auto begin = sectorPortalOffsets[s], k = sectorPortalOffsets[s + 1] - begin;
+      for (auto i = 0; i < k; i++) {
+         for (auto j = 0; j < k; j++) {
+            if (i == j) continue;
+
+            auto e = cursors[sectorPortals[begin + i]]++;
+            const auto& b = sectorBounds[matrixOffset + i * k + j];
+            edgeTargets[e] = sectorPortals[begin + j];
+            edgeSectors[e] = s;
+            lowerCosts[e] = b.lower;
+            upperCosts[e] = b.upper;
+         }
+      }
+      matrixOffset += k * k;
+   }
+
+   // Bounds matrices are symmetric, so searching from the destination needs no transpose.
+   auto search = [&](const std::vector<float>& edgeCosts, const int* portals, const distance_bounds* links, int numLinks, bool upper, std::vector<float>& costs) {
+      std::vector<dijkstra_seed> seeds(numLinks);
+      for (auto i = 0; i < numLinks; i++) {
+         seeds[i] = { portals[i], portals[i], upper ? links[i].upper : links[i].lower };
+      }
+
+      std::vector<int32_t> predecessors(numPortals);
+      costs.resize(numPortals);
+      ::Dijkstras(offsets.data(), edgeTargets.data(), edgeCosts.data(), numPortals, seeds.data(), numLinks, nullptr, 0, costs.data(), predecessors.data());
+   };
+
+   std::vector<float> upperToDestination, lowerToDestination, lowerFromSource;
+   search(upperCosts, destinationPortals, destinationLinks, numDestinationLinks, true, upperToDestination);
+   search(lowerCosts, destinationPortals, destinationLinks, numDestinationLinks, false, lowerToDestination);
+   search(lowerCosts, sourcePortals, sourceLinks, numSourceLinks, false, lowerFromSource);
+
+   upperBound = kInfinity;
+   for (auto i = 0; i < numSourceLinks; i++) {
+      upperBound = std::min(upperBound, sourceLinks[i].upper + upperToDestination[sourcePortals[i]]);
+   }
+
+   auto admissible = [&](float lower) {
+      return lower != kInfinity && lower <= upperBound * kCorridorSlack;
+   };
+
+   std::fill_n(sectorInCorridor, numSectors, 0);
+   for (auto v = 0; v < numPortals; v++) {
+      portalInCorridor[v] = admissible(lowerFromSource[v] + lowerToDestination[v]);
+      if (!portalInCorridor[v]) continue;
+
+      for (auto e = offsets[v]; e < offsets[v + 1]; e++) {
+         if (admissible(lowerFromSource[v] + lowerCosts[e] + lowerToDestination[edgeTargets[e]])) {
+            sectorInCorridor[edgeSectors[e]] = 1;
+         }
+      }
+   }
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "geometry.hpp"
+#include "portal_link_matrix.hpp"
+
+// Lower and upper bounds on the optimal path cost between two portals' crossover points.
+typedef struct distance_bounds_s {
+   float lower;
+   float upper;
+} distance_bounds;
+
+// First preprocessing pass of TODO.txt, for one sector: for each pair of portals (a, b), the
+// min and max over their crossover points p, q of the optimal in-sector path cost from p to q.
+// That is |p - q| if the link isn't occluded, else the best route through the waypoint LUT,
+// entering and leaving at waypoints visible from p and q.
+//
+// Portal i's points are [portalPointOffsets[i], portalPointOffsets[i + 1]), and links holds
+// their link states as CompileSector packed them. waypointCosts is the numWaypoints^2 LUT from
+// FloydWarshallBlocked.
+// Writes the symmetric numPortals^2 matrix bounds (zero on the diagonal; +inf if some pair of
+// points can't reach each other). Coordinates must fit in int16.
+void ComputeSectorPortalDistanceBounds(
+   const point2i32* portalPoints, const int* portalPointOffsets, int numPortals, const PortalLinkMatrix& links,
+   const point2i32* waypoints, int numWaypoints, const float* waypointCosts,
+   const seg2i32* barriers, int numBarriers,
+   distance_bounds* bounds);
+
+// The bounded sector search of TODO.txt over portals shared between sectors. Sector s joins
+// portals sectorPortals [sectorPortalOffsets[s], sectorPortalOffsets[s + 1]) with the k^2
+// bounds matrix of ComputeSectorPortalDistanceBounds, matrices packed back to back.
+// sourceLinks / destinationLinks bound the cost between the source / destination and their
+// sectors' portals.
+//
+// Runs Dijkstra from the destination on upper bounds for the best guaranteed cost, then keeps
+// each portal and sector some path could cross within it according to lower bounds; a fine
+// search restricted to those sectors still finds the optimal path. If no path is guaranteed
+// the bound is +inf and the corridor is everything the lower bounds can connect.
+void FindSectorCorridor(
+   int numPortals, const int* sectorPortalOffsets, const int* sectorPortals, int numSectors, const distance_bounds* sectorBounds,
+   const int* sourcePortals, const distance_bounds* sourceLinks, int numSourceLinks,
+   const int* destinationPortals, const distance_bounds* destinationLinks, int numDestinationLinks,
+   uint8_t* portalInCorridor, uint8_t* sectorInCorridor, OUT float& upperBound);
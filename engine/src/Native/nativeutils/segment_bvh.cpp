@@ -0,0 +1,229 @@
+#include "pch.h"
+#include "segment_bvh.hpp"
+#include "parallel.hpp"
+
+namespace {
+   // Managed BvhILS2 splits until fewer than 16 segments remain.
+   constexpr int kMaxLeafSegments = 16;
+   constexpr int kSegmentsPerChunk = 2;
+   constexpr int kSegmentsPerChunkPair = 4;
+
+   constexpr int kQueriesPerTask = 64;
+
+   class SegmentBvhBuilder {
+      const seg2i16* segments;
+      SegmentBvh& bvh;
+      std::vector<int> order; // segment indices, partitioned in place
+      std::vector<int32_t> doubledMidXs, doubledMidYs;
+      std::vector<pair2i32> leafRanges; // into order
+      int numLeafSlots = 0;
+
+      // Splits order[begin, end) into numParts ranges at medians of the wider midpoint axis,
+      // halving recursively as BvhILS2.Build does.
+      void Split(int begin, int end, int numParts, OUT std::vector<pair2i32>& ranges) {
+         if (numParts == 1) {
+            ranges.push_back({ begin, end });
+            return;
+         }
+
+         auto minX = std::numeric_limits<int32_t>::max(), minY = minX;
+         auto maxX = std::numeric_limits<int32_t>::min(), maxY = maxX;
+         for (auto i = begin; i < end; i++) {
+            minX = std::min(minX, doubledMidXs[order[i]]);
+            maxX = std::max(maxX, doubledMidXs[order[i]]);
+            minY = std::min(minY, doubledMidYs[order[i]]);
+            maxY = std::max(maxY, doubledMidYs[order[i]]);
+         }
+         const auto& keys = maxX - minX >= maxY - minY ? doubledMidXs : doubledMidYs;
+
+         auto leftParts = numParts / 2;
+         auto mid = begin + static_cast<int>(static_cast<int64_t>(end - begin) * leftParts / numParts);
+         std::nth_element(order.begin() + begin, order.begin() + mid, order.begin() + end, [&](int a, int b) {
+            return keys[a] < keys[b];
+         });
+
+         Split(begin, mid, leftParts, OUT ranges);
+         Split(mid, end, numParts - leftParts, OUT ranges);
+      }
+
+      int AddLeaf(int begin, int end) {
+         SegmentBvhLeaf leaf;
+         leaf.FirstChunk = numLeafSlots / kSegmentsPerChunk;
+         auto paddedCount = (end - begin + kSegmentsPerChunkPair - 1) / kSegmentsPerChunkPair * kSegmentsPerChunkPair;
+         leaf.NumChunks = paddedCount / kSegmentsPerChunk;
+         numLeafSlots += paddedCount;
+
+         bvh.Leaves.push_back(leaf);
+         leafRanges.push_back({ begin, end });
+         return static_cast<int>(bvh.Leaves.size()) - 1;
+      }
+
+      int BuildNode(int begin, int end, int parent, int slotInParent) {
+         auto nodeIndex = static_cast<int>(bvh.Nodes.size());
+         bvh.Nodes.emplace_back();
+         {
+            auto& node = bvh.Nodes[nodeIndex];
+            for (auto slot = 0; slot < kSegmentBvhWidth; slot++) {
+               node.MinXs[slot] = node.MinYs[slot] = std::numeric_limits<int32_t>::max();
+               node.MaxXs[slot] = node.MaxYs[slot] = std::numeric_limits<int32_t>::min();
+               node.Children[slot] = 0;
+            }
+            node.Parent = parent;
+            node.SlotInParent = slotInParent;
+         }
+
+         auto count = end - begin;
+         if (count == 0) return nodeIndex;
+
+         auto numParts = std::min(kSegmentBvhWidth, (count + kMaxLeafSegments - 1) / kMaxLeafSegments);
+         std::vector<pair2i32> ranges;
+         Split(begin, end, numParts, OUT ranges);
+
+         for (auto slot = 0; slot < numParts; slot++) {
+            auto [rangeBegin, rangeEnd] = ranges[slot];
+            auto child = rangeEnd - rangeBegin <= kMaxLeafSegments
+               ? ~AddLeaf(rangeBegin, rangeEnd)
+               : BuildNode(rangeBegin, rangeEnd, nodeIndex, slot);
+
+            // Children may have grown Nodes, so index afresh.
+            auto& node = bvh.Nodes[nodeIndex];
+            node.Children[slot] = child;
+            for (auto i = rangeBegin; i < rangeEnd; i++) {
+               const auto& s = segments[order[i]];
+               node.MinXs[slot] = std::min<int32_t>({ node.MinXs[slot], s.x1, s.x2 });
+               node.MinYs[slot] = std::min<int32_t>({ node.MinYs[slot], s.y1, s.y2 });
+               node.MaxXs[slot] = std::max<int32_t>({ node.MaxXs[slot], s.x1, s.x2 });
+               node.MaxYs[slot] = std::max<int32_t>({ node.MaxYs[slot], s.y1, s.y2 });
+            }
+         }
+         return nodeIndex;
+      }
+
+   public:
+      SegmentBvhBuilder(const seg2i16* segments, int numSegments, SegmentBvh& bvh) : segments(segments), bvh(bvh), order(numSegments), doubledMidXs(numSegments), doubledMidYs(numSegments) {
+         for (auto i = 0; i < numSegments; i++) {
+            order[i] = i;
+            doubledMidXs[i] = segments[i].x1 + segments[i].x2;
+            doubledMidYs[i] = segments[i].y1 + segments[i].y2;
+         }
+      }
+
+      void Build() {
+         BuildNode(0, static_cast<int>(order.size()), -1, 0);
+
+         // Leaves back to back, each padded with zero segments to a chunk pair, which never hit.
+         bvh.Chunks = ::AllocatePrequeryBarriersIntersectionState(numLeafSlots);
+         for (size_t leaf = 0; leaf < leafRanges.size(); leaf++) {
+            auto slot = bvh.Leaves[leaf].FirstChunk * kSegmentsPerChunk;
+            auto endSlot = slot + bvh.Leaves[leaf].NumChunks * kSegmentsPerChunk;
+            for (auto i = leafRanges[leaf].a; i < leafRanges[leaf].b; i++) {
+               const auto& s = segments[order[i]];
+               StorePrequeryBarrier(*bvh.Chunks, slot++, s.x1, s.y1, s.x2, s.y2);
+            }
+            while (slot < endSlot) StorePrequeryBarrier(*bvh.Chunks, slot++, 0, 0, 0, 0);
+         }
+         SetPrequeryBarrierCount(*bvh.Chunks, numLeafSlots);
+      }
+   };
+
+   typedef struct NodeQueryRegisters_s {
+      __m256i MinX, MinY, MaxX, MaxY;
+      __m256i X1, Y1, Dx, Dy;
+   } NodeQueryRegisters;
+
+   FORCEINLINE NodeQueryRegisters LoadNodeQueryRegisters(seg2i16 query) {
+      NodeQueryRegisters q;
+      q.MinX = _mm256_set1_epi32(std::min(query.x1, query.x2));
+      q.MinY = _mm256_set1_epi32(std::min(query.y1, query.y2));
+      q.MaxX = _mm256_set1_epi32(std::max(query.x1, query.x2));
+      q.MaxY = _mm256_set1_epi32(std::max(query.y1, query.y2));
+      q.X1 = _mm256_set1_epi32(query.x1);
+      q.Y1 = _mm256_set1_epi32(query.y1);
+      q.Dx = _mm256_set1_epi32(query.x2 - query.x1);
+      q.Dy = _mm256_set1_epi32(query.y2 - query.y1);
+      return q;
+   }
+
+   // Lanes of each child's corner strictly above / below the query's line, by the sign of
+   // (x - x1) * dy - (y - y1) * dx. Products of int16 deltas can need 33 bits, so even and odd
+   // lanes are widened to int64 separately and their compares blended back together.
+   FORCEINLINE void CornerSides(const NodeQueryRegisters& q, __m256i x, __m256i y, OUT __m256i& above, OUT __m256i& below) {
+      auto rx = _mm256_sub_epi32(x, q.X1);
+      auto ry = _mm256_sub_epi32(y, q.Y1);
+      auto even = _mm256_sub_epi64(_mm256_mul_epi32(rx, q.Dy), _mm256_mul_epi32(ry, q.Dx));
+      auto odd = _mm256_sub_epi64(
+         _mm256_mul_epi32(_mm256_srli_epi64(rx, 32), q.Dy),
+         _mm256_mul_epi32(_mm256_srli_epi64(ry, 32), q.Dx));
+
+      auto zeros = _mm256_setzero_si256();
+      above = _mm256_blend_epi32(_mm256_cmpgt_epi64(even, zeros), _mm256_cmpgt_epi64(odd, zeros), 0xAA);
+      below = _mm256_blend_epi32(_mm256_cmpgt_epi64(zeros, even), _mm256_cmpgt_epi64(zeros, odd), 0xAA);
+   }
+
+   // Bit per child whose bounds may hold part of the query: bounds overlap the query's, and the
+   // query's line doesn't leave all four corners strictly on one side (IntRect2.ContainsOrIntersects).
+   FORCEINLINE int TestChildren(const SegmentBvhNode& node, const NodeQueryRegisters& q) {
+      auto minX = _mm256_load_si256(reinterpret_cast<const __m256i*>(node.MinXs));
+      auto minY = _mm256_load_si256(reinterpret_cast<const __m256i*>(node.MinYs));
+      auto maxX = _mm256_load_si256(reinterpret_cast<const __m256i*>(node.MaxXs));
+      auto maxY = _mm256_load_si256(reinterpret_cast<const __m256i*>(node.MaxYs));
+
+      auto miss = _mm256_or_si256(
+         _mm256_or_si256(_mm256_cmpgt_epi32(minX, q.MaxX), _mm256_cmpgt_epi32(q.MinX, maxX)),
+         _mm256_or_si256(_mm256_cmpgt_epi32(minY, q.MaxY), _mm256_cmpgt_epi32(q.MinY, maxY)));
+
+      __m256i tlAbove, tlBelow, trAbove, trBelow, blAbove, blBelow, brAbove, brBelow;
+      CornerSides(q, minX, minY, OUT tlAbove, OUT tlBelow);
+      CornerSides(q, maxX, minY, OUT trAbove, OUT trBelow);
+      CornerSides(q, minX, maxY, OUT blAbove, OUT blBelow);
+      CornerSides(q, maxX, maxY, OUT brAbove, OUT brBelow);
+      auto allAbove = _mm256_and_si256(_mm256_and_si256(tlAbove, trAbove), _mm256_and_si256(blAbove, brAbove));
+      auto allBelow = _mm256_and_si256(_mm256_and_si256(tlBelow, trBelow), _mm256_and_si256(blBelow, brBelow));
+
+      miss = _mm256_or_si256(miss, _mm256_or_si256(allAbove, allBelow));
+      return ~_mm256_movemask_ps(_mm256_castsi256_ps(miss)) & 0xFF;
+   }
+
+   bool AnyIntersections(const SegmentBvh& bvh, seg2i16 query) {
+      auto q = LoadNodeQueryRegisters(query);
+      auto chunks = bvh.Chunks->ChunkBuffer.get();
+
+      // Visit the hit children of node after slot `after`; when there are none, pop back to the
+      // parent and resume after this node's slot there.
+      auto node = 0;
+      auto after = -1;
+      while (true) {
+         const auto& n = bvh.Nodes[node];
+         auto mask = TestChildren(n, q) & (0xFF << (after + 1)) & 0xFF;
+         if (mask == 0) {
+            if (n.Parent < 0) return false;
+            after = n.SlotInParent;
+            node = n.Parent;
+            continue;
+         }
+
+         auto slot = static_cast<int>(_tzcnt_u32(mask));
+         auto child = n.Children[slot];
+         if (child >= 0) {
+            node = child;
+            after = -1;
+         } else {
+            const auto& leaf = bvh.Leaves[~child];
+            if (::AnyChunkIntersections(query, chunks + leaf.FirstChunk * 32, leaf.NumChunks)) return true;
+            after = slot;
+         }
+      }
+   }
+}
+
+std::shared_ptr<SegmentBvh> LoadSegmentBvh(const seg2i16* segments, int numSegments) {
+   auto bvh = std::make_shared<SegmentBvh>();
+   SegmentBvhBuilder(segments, numSegments, *bvh).Build();
+   return bvh;
+}
+
+void QuerySegmentBvhAnyIntersections(const SegmentBvh& bvh, const seg2i16* queries, int numQueries, uint8_t* results) {
+   ParallelFor(numQueries, kQueriesPerTask, [&](int i) {
+      results[i] = AnyIntersections(bvh, queries[i]) ? 1 : 0;
+   });
+}
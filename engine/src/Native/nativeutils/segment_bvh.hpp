@@ -0,0 +1,39 @@
+#pragma once
+
+#include "geometry.hpp"
+#include "dllmain.hpp"
+
+constexpr int kSegmentBvhWidth = 8;
+
+// An 8-wide node: child bounds SoA, one __m256i per field, so one pass of AVX2 compares tests all
+// eight against a query. Unused slots have empty bounds (min > max) and never hit.
+typedef struct alignas(32) SegmentBvhNode_s {
+   int32_t MinXs[kSegmentBvhWidth];
+   int32_t MinYs[kSegmentBvhWidth];
+   int32_t MaxXs[kSegmentBvhWidth];
+   int32_t MaxYs[kSegmentBvhWidth];
+   int32_t Children[kSegmentBvhWidth]; // >= 0: node index, < 0: ~leaf index
+   int32_t Parent; // -1 at the root
+   int32_t SlotInParent;
+} SegmentBvhNode;
+
+// A leaf's segments, as chunks of SegmentBvh::Chunks starting at a chunk pair.
+typedef struct SegmentBvhLeaf_s {
+   int FirstChunk;
+   int NumChunks;
+} SegmentBvhLeaf;
+
+// Managed BvhILS2, flattened and widened: nodes in depth-first order (root at 0), leaves of up
+// to 16 segments packed in AnyIntersectionsAvx2's chunk layout so leaf tests run that kernel.
+typedef struct SegmentBvh_s {
+   std::vector<SegmentBvhNode> Nodes;
+   std::vector<SegmentBvhLeaf> Leaves;
+   std::shared_ptr<Avx2IntersectionPrequeryState> Chunks;
+} SegmentBvh;
+
+std::shared_ptr<SegmentBvh> LoadSegmentBvh(const seg2i16* segments, int numSegments);
+
+// results[i] = 1 if queries[i] intersects any segment, as QueryAnyIntersections over all of them.
+// Traversal is stackless: each node is retested on the way back up and resumes after the child
+// it came from. Node tests are exact over the whole int16 range. Runs in parallel.
+void QuerySegmentBvhAnyIntersections(const SegmentBvh& bvh, const seg2i16* queries, int numQueries, uint8_t* results);
@@ -0,0 +1,225 @@
+#include "pch.h"
+#include "segment_intersections.hpp"
+#include <numeric>
+
+namespace {
+   // Below this, sorting costs more than testing every pair.
+   constexpr int kSweepMinSegments = 64;
+
+   // Doubles represent cross products exactly while |coordinate| < 2^25
+   // (differences < 2^26, products < 2^52).
+   constexpr int32_t kExactDoubleCoordinateLimit = 1 << 25;
+
+   FORCEINLINE int Clk(int64_t ax, int64_t ay, int64_t bx, int64_t by) {
+      return cmp(ax * by, ay * bx);
+   }
+
+   FORCEINLINE bool SegmentContains(int64_t p1x, int64_t p1y, int64_t p2x, int64_t p2y, int64_t qx, int64_t qy) {
+      auto p1p2x = p2x - p1x;
+      auto p1p2y = p2y - p1y;
+      auto p1qx = qx - p1x;
+      auto p1qy = qy - p1y;
+      if (Clk(p1p2x, p1p2y, p1qx, p1qy) != 0) return false;
+
+      auto a = p1p2x * p1qx + p1p2y * p1qy;
+      auto b = p1p2x * p1p2x + p1p2y * p1p2y;
+      return a >= 0 && a <= b;
+   }
+
+   FORCEINLINE int LowestSetBit(int mask) {
+      auto lane = 0;
+      while (!(mask & (1 << lane))) lane++;
+      return lane;
+   }
+
+   bool CoordinatesFitInDouble(const seg2i32* segments, int numSegments) {
+      for (auto i = 0; i < numSegments; i++) {
+         const auto& s = segments[i];
+         if (std::abs(s.x1) >= kExactDoubleCoordinateLimit || std::abs(s.y1) >= kExactDoubleCoordinateLimit ||
+             std::abs(s.x2) >= kExactDoubleCoordinateLimit || std::abs(s.y2) >= kExactDoubleCoordinateLimit) {
+            return false;
+         }
+      }
+      return true;
+   }
+
+   // Returns a 4-bit mask of lanes where o1 != o2 && o3 != o4, and in touchingMask the lanes
+   // where some orientation is zero (only those can flip under endpoint containment).
+   FORCEINLINE int ProperIntersectionMaskAvx2(
+      __m256d ax, __m256d ay, __m256d bx, __m256d by,
+      __m256d cx, __m256d cy, __m256d dx, __m256d dy,
+      OUT int& touchingMask
+   ) {
+      const __m256d zero = _mm256_setzero_pd();
+
+      __m256d bax = _mm256_sub_pd(bx, ax), bay = _mm256_sub_pd(by, ay);
+      __m256d bcx = _mm256_sub_pd(bx, cx), bcy = _mm256_sub_pd(by, cy);
+      __m256d bdx = _mm256_sub_pd(bx, dx), bdy = _mm256_sub_pd(by, dy);
+      __m256d dcx = _mm256_sub_pd(dx, cx), dcy = _mm256_sub_pd(dy, cy);
+      __m256d dax = _mm256_sub_pd(dx, ax), day = _mm256_sub_pd(dy, ay);
+      __m256d dbx = _mm256_sub_pd(dx, bx), dby = _mm256_sub_pd(dy, by);
+
+      __m256d c1 = _mm256_sub_pd(_mm256_mul_pd(bax, bcy), _mm256_mul_pd(bay, bcx));
+      __m256d c2 = _mm256_sub_pd(_mm256_mul_pd(bax, bdy), _mm256_mul_pd(bay, bdx));
+      __m256d c3 = _mm256_sub_pd(_mm256_mul_pd(dcx, day), _mm256_mul_pd(dcy, dax));
+      __m256d c4 = _mm256_sub_pd(_mm256_mul_pd(dcx, dby), _mm256_mul_pd(dcy, dbx));
+
+      // sign(c) differs iff (c > 0) or (c < 0) differs.
+      __m256d o12 = _mm256_or_pd(
+         _mm256_xor_pd(_mm256_cmp_pd(c1, zero, _CMP_GT_OQ), _mm256_cmp_pd(c2, zero, _CMP_GT_OQ)),
+         _mm256_xor_pd(_mm256_cmp_pd(c1, zero, _CMP_LT_OQ), _mm256_cmp_pd(c2, zero, _CMP_LT_OQ)));
+      __m256d o34 = _mm256_or_pd(
+         _mm256_xor_pd(_mm256_cmp_pd(c3, zero, _CMP_GT_OQ), _mm256_cmp_pd(c4, zero, _CMP_GT_OQ)),
+         _mm256_xor_pd(_mm256_cmp_pd(c3, zero, _CMP_LT_OQ), _mm256_cmp_pd(c4, zero, _CMP_LT_OQ)));
+
+      __m256d anyZero = _mm256_or_pd(
+         _mm256_or_pd(_mm256_cmp_pd(c1, zero, _CMP_EQ_OQ), _mm256_cmp_pd(c2, zero, _CMP_EQ_OQ)),
+         _mm256_or_pd(_mm256_cmp_pd(c3, zero, _CMP_EQ_OQ), _mm256_cmp_pd(c4, zero, _CMP_EQ_OQ)));
+
+      touchingMask = _mm256_movemask_pd(anyZero);
+      return _mm256_movemask_pd(_mm256_and_pd(o12, o34));
+   }
+}
+
+bool SegmentsIntersect(const seg2i32& s, const seg2i32& t, bool detectEndpointContainment) {
+   int64_t ax = s.x1, ay = s.y1, bx = s.x2, by = s.y2;
+   int64_t cx = t.x1, cy = t.y1, dx = t.x2, dy = t.y2;
+
+   auto bax = bx - ax;
+   auto bay = by - ay;
+   auto o1 = Clk(bax, bay, bx - cx, by - cy);
+   auto o2 = Clk(bax, bay, bx - dx, by - dy);
+   if (o1 == o2 && !detectEndpointContainment) return false;
+
+   auto dcx = dx - cx;
+   auto dcy = dy - cy;
+   auto o3 = Clk(dcx, dcy, dx - ax, dy - ay);
+   auto o4 = Clk(dcx, dcy, dx - bx, dy - by);
+   if (o1 != o2 && o3 != o4) return true;
+
+   if (detectEndpointContainment) {
+      if (o1 == 0 && SegmentContains(ax, ay, bx, by, cx, cy)) return true;
+      if (o2 == 0 && SegmentContains(ax, ay, bx, by, dx, dy)) return true;
+      if (o3 == 0 && SegmentContains(cx, cy, dx, dy, ax, ay)) return true;
+      if (o4 == 0 && SegmentContains(cx, cy, dx, dy, bx, by)) return true;
+   }
+   return false;
+}
+
+void FindAllIntersectingPairsBruteForce(const seg2i32* segments, int numSegments, bool detectEndpointContainment, std::vector<pair2i32>& results) {
+   if (!CoordinatesFitInDouble(segments, numSegments)) {
+      for (auto i = 0; i < numSegments; i++) {
+         for (auto j = i + 1; j < numSegments; j++) {
+            if (SegmentsIntersect(segments[i], segments[j], detectEndpointContainment)) {
+               results.push_back({ i, j });
+            }
+         }
+      }
+      return;
+   }
+
+   // SoA copy so four candidates load with one instruction per coordinate.
+   auto numPadded = (numSegments + 3) & ~3;
+   std::vector<double> soa(static_cast<size_t>(numPadded) * 4, 0.0);
+   auto xs1 = soa.data(), ys1 = xs1 + numPadded, xs2 = ys1 + numPadded, ys2 = xs2 + numPadded;
+   for (auto i = 0; i < numSegments; i++) {
+      xs1[i] = segments[i].x1;
+      ys1[i] = segments[i].y1;
+      xs2[i] = segments[i].x2;
+      ys2[i] = segments[i].y2;
+   }
+
+   for (auto i = 0; i < numSegments; i++) {
+      const auto ax = _mm256_set1_pd(xs1[i]), ay = _mm256_set1_pd(ys1[i]);
+      const auto bx = _mm256_set1_pd(xs2[i]), by = _mm256_set1_pd(ys2[i]);
+
+      // Scalar until j is 4-aligned, then four lanes at a time; padding lanes are masked off.
+      auto j = i + 1;
+      for (; j < numSegments && (j & 3); j++) {
+         if (SegmentsIntersect(segments[i], segments[j], detectEndpointContainment)) {
+            results.push_back({ i, j });
+         }
+      }
+
+      for (; j < numSegments; j += 4) {
+         int touchingMask;
+         auto hitMask = ProperIntersectionMaskAvx2(
+            ax, ay, bx, by,
+            _mm256_loadu_pd(xs1 + j), _mm256_loadu_pd(ys1 + j), _mm256_loadu_pd(xs2 + j), _mm256_loadu_pd(ys2 + j),
+            OUT touchingMask);
+
+         auto validMask = numSegments - j >= 4 ? 0b1111 : (1 << (numSegments - j)) - 1;
+         hitMask &= validMask;
+         touchingMask &= validMask & ~hitMask;
+         if (!detectEndpointContainment) touchingMask = 0;
+
+         for (auto lanes = hitMask | touchingMask; lanes; lanes &= lanes - 1) {
+            auto lane = LowestSetBit(lanes);
+
+            if ((hitMask & (1 << lane)) || SegmentsIntersect(segments[i], segments[j + lane], true)) {
+               results.push_back({ i, j + lane });
+            }
+         }
+      }
+   }
+}
+
+void FindAllIntersectingPairsSweep(const seg2i32* segments, int numSegments, bool detectEndpointContainment, std::vector<pair2i32>& results) {
+   std::vector<int> order(numSegments);
+   std::iota(order.begin(), order.end(), 0);
+
+   std::vector<int32_t> xmins(numSegments);
+   for (auto i = 0; i < numSegments; i++) {
+      xmins[i] = std::min(segments[i].x1, segments[i].x2);
+   }
+   std::sort(order.begin(), order.end(), [&](int a, int b) { return xmins[a] < xmins[b]; });
+
+   // Bounds in sweep order, padded by 8 so the y-filter can always load a full register.
+   auto numPadded = numSegments + 8;
+   std::vector<int32_t> sortedXMin(numPadded, INT32_MAX), sortedXMax(numPadded, INT32_MIN);
+   std::vector<int32_t> sortedYMin(numPadded, INT32_MAX), sortedYMax(numPadded, INT32_MIN);
+   for (auto k = 0; k < numSegments; k++) {
+      const auto& s = segments[order[k]];
+      sortedXMin[k] = std::min(s.x1, s.x2);
+      sortedXMax[k] = std::max(s.x1, s.x2);
+      sortedYMin[k] = std::min(s.y1, s.y2);
+      sortedYMax[k] = std::max(s.y1, s.y2);
+   }
+
+   auto emit = [&](int ka, int kb) {
+      auto a = order[ka], b = order[kb];
+      if (SegmentsIntersect(segments[a], segments[b], detectEndpointContainment)) {
+         results.push_back(a < b ? pair2i32{ a, b } : pair2i32{ b, a });
+      }
+   };
+
+   for (auto k = 0; k < numSegments; k++) {
+      const auto xmax = sortedXMax[k];
+      const auto ymin = _mm256_set1_epi32(sortedYMin[k]);
+      const auto ymax = _mm256_set1_epi32(sortedYMax[k]);
+
+      // Candidates are the contiguous run after k whose xmin <= xmax (closed extents).
+      auto end = static_cast<int>(std::upper_bound(sortedXMin.begin() + k + 1, sortedXMin.begin() + numSegments, xmax) - sortedXMin.begin());
+
+      for (auto c = k + 1; c < end; c += 8) {
+         // overlap iff !(cand.ymin > ymax || cand.ymax < ymin)
+         auto candYMin = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(sortedYMin.data() + c));
+         auto candYMax = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(sortedYMax.data() + c));
+         auto disjoint = _mm256_or_si256(_mm256_cmpgt_epi32(candYMin, ymax), _mm256_cmpgt_epi32(ymin, candYMax));
+         auto overlapMask = ~_mm256_movemask_ps(_mm256_castsi256_ps(disjoint)) & 0xFF;
+         if (end - c < 8) overlapMask &= (1 << (end - c)) - 1;
+
+         for (; overlapMask; overlapMask &= overlapMask - 1) {
+            emit(k, c + LowestSetBit(overlapMask));
+         }
+      }
+   }
+}
+
+void FindAllIntersectingPairs(const seg2i32* segments, int numSegments, bool detectEndpointContainment, std::vector<pair2i32>& results) {
+   if (numSegments < kSweepMinSegments) {
+      FindAllIntersectingPairsBruteForce(segments, numSegments, detectEndpointContainment, results);
+   } else {
+      FindAllIntersectingPairsSweep(segments, numSegments, detectEndpointContainment, results);
+   }
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "geometry.hpp"
+
+// Same predicate as managed IntLineSegment2.Intersects(ax, ..., detectEndpointContainment).
+bool SegmentsIntersect(const seg2i32& s, const seg2i32& t, bool detectEndpointContainment);
+
+// All-pairs reference: tests every (i, j) with i < j, four j at a time with AVX2.
+void FindAllIntersectingPairsBruteForce(const seg2i32* segments, int numSegments, bool detectEndpointContainment, std::vector<pair2i32>& results);
+
+// Sort-and-sweep over x: only pairs whose x-extents overlap are considered, those are
+// filtered by y-extent eight at a time, and survivors get the exact test.
+void FindAllIntersectingPairsSweep(const seg2i32* segments, int numSegments, bool detectEndpointContainment, std::vector<pair2i32>& results);
+
+// Picks brute force for tiny inputs, sweep otherwise. Pairs are emitted with a < b.
+// Zero-length segments are not supported (managed IntLineSegment2 rejects them too).
+void FindAllIntersectingPairs(const seg2i32* segments, int numSegments, bool detectEndpointContainment, std::vector<pair2i32>& results);
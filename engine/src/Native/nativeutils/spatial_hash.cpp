@@ -0,0 +1,124 @@
+#include "pch.h"
+#include "spatial_hash.hpp"
+#include "parallel.hpp"
+
+namespace {
+   // Entities per task when querying neighborhoods.
+   constexpr int kEntitiesPerTask = 64;
+
+   FORCEINLINE int DivRoundUp(int x, int divisor) {
+      return (x + divisor - 1) / divisor;
+   }
+
+   // Managed EntityGridRangeCalculator: the row at offset dy spans cells [dx, dx + width).
+   // Returns false past the last row.
+   FORCEINLINE bool TryGetRange(NeighborhoodShape shape, int r, int row, OUT int& dy, OUT int& dx, OUT int& width) {
+      constexpr int precision = 100;
+
+      if (shape == NeighborhoodShape::Circle) {
+         if (row > 2 * r) return false;
+         dy = row - r;
+      } else {
+         if (row > r) return false;
+         dy = row;
+      }
+
+      auto xRange = DivRoundUp(static_cast<int>(std::sqrt(static_cast<double>(precision * precision * (r * r - dy * dy)))), precision);
+      if (shape == NeighborhoodShape::Circle) {
+         dx = -xRange;
+         width = xRange * 2 + 1;
+      } else {
+         dx = (dy == 0 && shape == NeighborhoodShape::QuarterCircleBRExcludeCenter) ? 1 : 0;
+         width = xRange + 1 - dx;
+      }
+      return true;
+   }
+
+   // Calls f(slotBegin, slotEnd) for each row of entity i's neighborhood that falls in the grid.
+   template <typename F>
+   FORCEINLINE void ForEachNeighborSpan(const SpatialHash& hash, NeighborhoodShape shape, int entity, int queryRadius, const F& f) {
+      auto cell = hash.EntityCells[entity];
+      auto cx = cell % hash.Width, cy = cell / hash.Width;
+      auto r = DivRoundUp(queryRadius, hash.CellSize);
+
+      int dy, dx, width;
+      for (auto row = 0; TryGetRange(shape, r, row, dy, dx, width); row++) {
+         auto y = cy + dy;
+         if (y < 0 || y >= hash.Height) continue;
+
+         auto x0 = std::max(0, cx + dx), x1 = std::min(hash.Width, cx + dx + width);
+         if (x0 >= x1) continue;
+
+         f(hash.CellOffsets[y * hash.Width + x0], hash.CellOffsets[y * hash.Width + x1]);
+      }
+   }
+}
+
+std::shared_ptr<SpatialHash> LoadSpatialHash(int originX, int originY, int width, int height, int cellSize) {
+   auto hash = std::make_shared<SpatialHash>();
+   hash->OriginX = originX;
+   hash->OriginY = originY;
+   hash->Width = width;
+   hash->Height = height;
+   hash->CellSize = cellSize;
+   hash->CellOffsets.assign(static_cast<size_t>(width) * height + 1, 0);
+   return hash;
+}
+
+void UpdateSpatialHash(SpatialHash& hash, const point2i32* positions, const int32_t* radii, int numEntities) {
+   hash.Xs.resize(numEntities);
+   hash.Ys.resize(numEntities);
+   hash.Radii.resize(numEntities);
+   hash.EntityIndices.resize(numEntities);
+   hash.EntityCells.resize(numEntities);
+
+   // Counting sort: histogram into CellOffsets[c + 1], prefix sum, then scatter in entity order
+   // so each cell stays sorted by entity index.
+   auto& offsets = hash.CellOffsets;
+   std::fill(offsets.begin(), offsets.end(), 0);
+   for (auto i = 0; i < numEntities; i++) {
+      auto x = std::clamp((positions[i].x - hash.OriginX) / hash.CellSize, 0, hash.Width - 1);
+      auto y = std::clamp((positions[i].y - hash.OriginY) / hash.CellSize, 0, hash.Height - 1);
+      auto cell = y * hash.Width + x;
+      hash.EntityCells[i] = cell;
+      offsets[cell + 1]++;
+   }
+
+   for (size_t c = 1; c < offsets.size(); c++) offsets[c] += offsets[c - 1];
+
+   for (auto i = 0; i < numEntities; i++) {
+      auto slot = offsets[hash.EntityCells[i]]++;
+      hash.Xs[slot] = positions[i].x;
+      hash.Ys[slot] = positions[i].y;
+      hash.Radii[slot] = radii[i];
+      hash.EntityIndices[slot] = i;
+   }
+
+   // The scatter bumped each cell's begin to its end; shift back.
+   for (auto c = offsets.size() - 1; c > 0; c--) offsets[c] = offsets[c - 1];
+   offsets[0] = 0;
+}
+
+void QuerySpatialHashNeighbors(
+   const SpatialHash& hash, NeighborhoodShape shape, const int32_t* queryRadii,
+   std::vector<int>& offsets, std::vector<int>& neighbors
+) {
+   const auto numEntities = static_cast<int>(hash.EntityIndices.size());
+   offsets.assign(numEntities + 1, 0);
+
+   ParallelFor(numEntities, kEntitiesPerTask, [&](int i) {
+      auto count = 0;
+      ForEachNeighborSpan(hash, shape, i, queryRadii[i], [&](int begin, int end) { count += end - begin; });
+      offsets[i + 1] = count;
+   });
+
+   for (auto i = 0; i < numEntities; i++) offsets[i + 1] += offsets[i];
+   neighbors.resize(offsets[numEntities]);
+
+   ParallelFor(numEntities, kEntitiesPerTask, [&](int i) {
+      auto out = neighbors.data() + offsets[i];
+      ForEachNeighborSpan(hash, shape, i, queryRadii[i], [&](int begin, int end) {
+         out = std::copy(hash.EntityIndices.data() + begin, hash.EntityIndices.data() + end, out);
+      });
+   });
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "geometry.hpp"
+
+// Native EntityGrid: a uniform grid over a sector's local bounds whose entities are kept SoA,
+// sorted by row-major cell with a counting sort on every update. A row of cells is then one
+// contiguous run of slots, so a neighbor query touches one span per row of its range instead
+// of one linked chain per cell.
+typedef struct SpatialHash_s {
+   int OriginX, OriginY;
+   int Width, Height;
+   int CellSize;
+
+   std::vector<int> CellOffsets; // Width * Height + 1; cell c holds slots [CellOffsets[c], CellOffsets[c + 1])
+   std::vector<int32_t> Xs, Ys, Radii;
+   std::vector<int> EntityIndices; // slot -> caller's entity index
+   std::vector<int> EntityCells; // caller's entity index -> cell
+} SpatialHash;
+
+// Managed EntityGridView's neighborhoods, as cell ranges around the query's cell.
+enum class NeighborhoodShape : int {
+   Circle = 0,
+   QuarterCircleBR = 1,
+   QuarterCircleBRExcludeCenter = 2,
+};
+
+std::shared_ptr<SpatialHash> LoadSpatialHash(int originX, int originY, int width, int height, int cellSize);
+
+// Replaces the hash's entities (local positions; positions outside the grid clamp to its edge
+// cells). Buffers are reused between updates. Must not run concurrently with queries.
+void UpdateSpatialHash(SpatialHash& hash, const point2i32* positions, const int32_t* radii, int numEntities);
+
+// For every entity, the entities in the cells of its neighborhood (managed EntityGridView.InCircle
+// and friends, with agentRadius queryRadii[i]), the entity itself included if its own cell is.
+// Entity i's neighbors are [offsets[i], offsets[i + 1]), by cell then entity index. Runs in
+// parallel, counting before filling so each entity writes its own span.
+void QuerySpatialHashNeighbors(
+   const SpatialHash& hash, NeighborhoodShape shape, const int32_t* queryRadii,
+   std::vector<int>& offsets, std::vector<int>& neighbors);
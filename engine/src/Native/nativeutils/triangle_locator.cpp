@@ -0,0 +1,166 @@
+#include "pch.h"
+#include "triangle_locator.hpp"
+#include "parallel.hpp"
+
+namespace {
+   // Managed TryIntersect's kAcceptableNearness. Nearness sums how far each barycentric
+   // coordinate is below zero, so accepted points have every coordinate >= -0.1: the triangle
+   // scaled by 1 + 3 * 0.1 about its centroid. Padded a hair against rounding.
+   constexpr double kAcceptableNearness = 0.1;
+   constexpr double kNearnessRegionScale = (1.0 + 3.0 * kAcceptableNearness) * (1.0 + 1E-6);
+
+   constexpr int kPointsPerTask = 256;
+
+   FORCEINLINE int CellCoordinate(double v, double origin, double cellSize, int numCells) {
+      auto c = static_cast<int>(std::floor((v - origin) / cellSize));
+      return std::max(0, std::min(numCells - 1, c));
+   }
+
+   // Managed GeometryOperations.IsPointInTriangleWithNearness, same operation order so results
+   // match bit for bit.
+   FORCEINLINE bool IsPointInTriangleWithNearness(const TriangleMesh& mesh, int triangle, double px, double py, OUT double& nearness) {
+      auto a = TriangleCorner(mesh, triangle, 0);
+      auto b = TriangleCorner(mesh, triangle, 1);
+      auto c = TriangleCorner(mesh, triangle, 2);
+
+      auto v0x = c.x - a.x;
+      auto v0y = c.y - a.y;
+      auto v1x = b.x - a.x;
+      auto v1y = b.y - a.y;
+      auto v2x = px - a.x;
+      auto v2y = py - a.y;
+
+      auto dot00 = v0x * v0x + v0y * v0y;
+      auto dot01 = v0x * v1x + v0y * v1y;
+      auto dot02 = v0x * v2x + v0y * v2y;
+      auto dot11 = v1x * v1x + v1y * v1y;
+      auto dot12 = v1x * v2x + v1y * v2y;
+
+      auto invDenom = 1.0 / (dot00 * dot11 - dot01 * dot01);
+      auto u = (dot11 * dot02 - dot01 * dot12) * invDenom;
+      auto v = (dot00 * dot12 - dot01 * dot02) * invDenom;
+      auto uPlusV = u + v;
+
+      nearness = 0.0;
+      if (u >= 0 && v >= 0 && uPlusV <= 1.0) {
+         return true;
+      }
+
+      if (u < 0) nearness -= u;
+      if (v < 0) nearness -= v;
+      if (uPlusV > 1) nearness += uPlusV - 1;
+      return false;
+   }
+}
+
+void BuildTriangleLocatorGrid(TriangleMesh& mesh) {
+   auto numTriangles = mesh.NumTriangles;
+   if (numTriangles == 0) {
+      mesh.BoundsLeft = mesh.BoundsTop = mesh.BoundsRight = mesh.BoundsBottom = 0;
+      mesh.CellSize = 1;
+      mesh.GridWidth = mesh.GridHeight = 0;
+      mesh.CellOffsets.assign(1, 0);
+      mesh.CellTriangles.clear();
+      return;
+   }
+
+   // Triangulator's island bounds: the union of each triangle's padded int bounds.
+   constexpr auto kInf = std::numeric_limits<double>::infinity();
+   auto left = kInf, top = kInf, right = -kInf, bottom = -kInf;
+   for (auto t = 0; t < numTriangles; t++) {
+      for (auto corner = 0; corner < 3; corner++) {
+         auto p = TriangleCorner(mesh, t, corner);
+         left = std::min(left, std::floor(p.x) - 1);
+         top = std::min(top, std::floor(p.y) - 1);
+         right = std::max(right, std::ceil(p.x) + 1);
+         bottom = std::max(bottom, std::ceil(p.y) + 1);
+      }
+   }
+
+   auto width = right - left, height = bottom - top;
+   auto cellSize = std::sqrt(width * height / numTriangles);
+   auto gridWidth = std::max(1, static_cast<int>(std::ceil(width / cellSize)));
+   auto gridHeight = std::max(1, static_cast<int>(std::ceil(height / cellSize)));
+
+   mesh.BoundsLeft = left;
+   mesh.BoundsTop = top;
+   mesh.BoundsRight = right;
+   mesh.BoundsBottom = bottom;
+   mesh.CellSize = cellSize;
+   mesh.GridWidth = gridWidth;
+   mesh.GridHeight = gridHeight;
+
+   // Cell range of each triangle's nearness region, then a counting sort into the cells.
+   // Triangles are visited in index order, so each cell's list comes out ascending.
+   std::vector<int32_t> cellRanges(4 * numTriangles);
+   for (auto t = 0; t < numTriangles; t++) {
+      auto cx = mesh.CentroidXs[t], cy = mesh.CentroidYs[t];
+      auto minX = kInf, minY = kInf, maxX = -kInf, maxY = -kInf;
+      for (auto corner = 0; corner < 3; corner++) {
+         auto p = TriangleCorner(mesh, t, corner);
+         auto x = cx + (p.x - cx) * kNearnessRegionScale;
+         auto y = cy + (p.y - cy) * kNearnessRegionScale;
+         minX = std::min(minX, x);
+         minY = std::min(minY, y);
+         maxX = std::max(maxX, x);
+         maxY = std::max(maxY, y);
+      }
+
+      cellRanges[4 * t + 0] = CellCoordinate(minX, left, cellSize, gridWidth);
+      cellRanges[4 * t + 1] = CellCoordinate(minY, top, cellSize, gridHeight);
+      cellRanges[4 * t + 2] = CellCoordinate(maxX, left, cellSize, gridWidth);
+      cellRanges[4 * t + 3] = CellCoordinate(maxY, top, cellSize, gridHeight);
+   }
+
+   auto numCells = gridWidth * gridHeight;
+   mesh.CellOffsets.assign(numCells + 1, 0);
+   for (auto t = 0; t < numTriangles; t++) {
+      for (auto y = cellRanges[4 * t + 1]; y <= cellRanges[4 * t + 3]; y++) {
+         for (auto x = cellRanges[4 * t + 0]; x <= cellRanges[4 * t + 2]; x++) {
+            mesh.CellOffsets[y * gridWidth + x + 1]++;
+         }
+      }
+   }
+
+   for (auto i = 0; i < numCells; i++) {
+      mesh.CellOffsets[i + 1] += mesh.CellOffsets[i];
+   }
+
+   std::vector<int32_t> cursors(mesh.CellOffsets.begin(), mesh.CellOffsets.end() - 1);
+   mesh.CellTriangles.resize(mesh.CellOffsets[numCells]);
+   for (auto t = 0; t < numTriangles; t++) {
+      for (auto y = cellRanges[4 * t + 1]; y <= cellRanges[4 * t + 3]; y++) {
+         for (auto x = cellRanges[4 * t + 0]; x <= cellRanges[4 * t + 2]; x++) {
+            mesh.CellTriangles[cursors[y * gridWidth + x]++] = t;
+         }
+      }
+   }
+}
+
+void LocateTriangles(const TriangleMesh& mesh, const point2f64* points, int numPoints, int32_t* triangles) {
+   ParallelFor(numPoints, kPointsPerTask, [&](int i) {
+      auto px = points[i].x, py = points[i].y;
+      triangles[i] = -1;
+      if (mesh.GridWidth == 0 ||
+          px < mesh.BoundsLeft || py < mesh.BoundsTop ||
+          px > mesh.BoundsRight || py > mesh.BoundsBottom) {
+         return;
+      }
+
+      auto cell = CellCoordinate(py, mesh.BoundsTop, mesh.CellSize, mesh.GridHeight) * mesh.GridWidth +
+                  CellCoordinate(px, mesh.BoundsLeft, mesh.CellSize, mesh.GridWidth);
+
+      auto bestNearness = std::numeric_limits<double>::max();
+      for (auto j = mesh.CellOffsets[cell]; j < mesh.CellOffsets[cell + 1]; j++) {
+         auto t = mesh.CellTriangles[j];
+         double nearness;
+         if (IsPointInTriangleWithNearness(mesh, t, px, py, OUT nearness)) {
+            triangles[i] = t;
+            return;
+         } else if (nearness < bestNearness && nearness <= kAcceptableNearness) {
+            triangles[i] = t;
+            bestNearness = nearness;
+         }
+      }
+   });
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "triangle_mesh.hpp"
+
+// Fills the mesh's point-location grid: bounds as managed TriangulationIsland.IntBounds, cells
+// sized for about one triangle each, and every triangle listed in the cells overlapping the
+// region where TryIntersect could pick it (the triangle scaled about its centroid to cover
+// barycentric nearness up to 0.1). Called by LoadTriangleMesh.
+void BuildTriangleLocatorGrid(TriangleMesh& mesh);
+
+// Managed TriangulationIsland.TryIntersect for many points at once, testing only the
+// candidates of each point's cell: the lowest-index triangle containing the point, else the
+// nearest within a barycentric nearness of 0.1, else -1 (also for points outside the bounds).
+// Points run in parallel.
+void LocateTriangles(const TriangleMesh& mesh, const point2f64* points, int numPoints, int32_t* triangles);
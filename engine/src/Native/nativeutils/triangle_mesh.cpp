@@ -0,0 +1,33 @@
+#include "pch.h"
+#include "triangle_mesh.hpp"
+#include "triangle_locator.hpp"
+
+std::shared_ptr<TriangleMesh> LoadTriangleMesh(
+   const point2f64* vertices, int numVertices,
+   const int32_t* triangleVertices, const int32_t* triangleNeighbors, const int32_t* neighborSharedEdges, int numTriangles
+) {
+   auto mesh = std::make_shared<TriangleMesh>();
+   mesh->NumTriangles = numTriangles;
+   mesh->VertexXs.resize(numVertices);
+   mesh->VertexYs.resize(numVertices);
+   for (auto i = 0; i < numVertices; i++) {
+      mesh->VertexXs[i] = vertices[i].x;
+      mesh->VertexYs[i] = vertices[i].y;
+   }
+
+   mesh->TriangleVertices.assign(triangleVertices, triangleVertices + 3 * numTriangles);
+   mesh->TriangleNeighbors.assign(triangleNeighbors, triangleNeighbors + 3 * numTriangles);
+   mesh->NeighborSharedEdges.assign(neighborSharedEdges, neighborSharedEdges + 3 * numTriangles);
+
+   // Same as Triangulator: (p0 + p1 + p2) / 3.
+   mesh->CentroidXs.resize(numTriangles);
+   mesh->CentroidYs.resize(numTriangles);
+   for (auto t = 0; t < numTriangles; t++) {
+      auto a = TriangleCorner(*mesh, t, 0), b = TriangleCorner(*mesh, t, 1), c = TriangleCorner(*mesh, t, 2);
+      mesh->CentroidXs[t] = (a.x + b.x + c.x) / 3.0;
+      mesh->CentroidYs[t] = (a.y + b.y + c.y) / 3.0;
+   }
+
+   BuildTriangleLocatorGrid(*mesh);
+   return mesh;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "geometry.hpp"
+
+// A managed TriangulationIsland flattened. Vertices are SoA and shared between triangles;
+// triangle t's corners are TriangleVertices [3t, 3t + 3) in Triangle3.Points order, and
+// TriangleNeighbors / NeighborSharedEdges hold its NeighborOppositePointIndices /
+// NeighborVertexIndexSharingEdgeOppositePointIndices (-1 where there's no neighbor).
+typedef struct TriangleMesh_s {
+   int NumTriangles;
+   std::vector<double> VertexXs, VertexYs;
+   std::vector<int32_t> TriangleVertices;
+   std::vector<int32_t> TriangleNeighbors;
+   std::vector<int32_t> NeighborSharedEdges;
+   std::vector<double> CentroidXs, CentroidYs;
+
+   // Point-location grid over the island's padded int bounds (triangle_locator.hpp). Cell
+   // (x, y) lists triangles [CellOffsets[i], CellOffsets[i + 1]) of CellTriangles, ascending,
+   // where i = y * GridWidth + x.
+   double BoundsLeft, BoundsTop, BoundsRight, BoundsBottom;
+   double CellSize;
+   int GridWidth, GridHeight;
+   std::vector<int32_t> CellOffsets, CellTriangles;
+} TriangleMesh;
+
+std::shared_ptr<TriangleMesh> LoadTriangleMesh(
+   const point2f64* vertices, int numVertices,
+   const int32_t* triangleVertices, const int32_t* triangleNeighbors, const int32_t* neighborSharedEdges, int numTriangles);
+
+FORCEINLINE point2f64 TriangleCorner(const TriangleMesh& mesh, int triangle, int corner) {
+   auto v = mesh.TriangleVertices[3 * triangle + corner];
+   return { mesh.VertexXs[v], mesh.VertexYs[v] };
+}
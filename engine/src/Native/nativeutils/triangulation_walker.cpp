@@ -0,0 +1,308 @@
+#include "pch.h"
+#include "triangulation_walker.hpp"
+#include "parallel.hpp"
+#include <limits>
+
+namespace {
+   // Walks per task; walk lengths vary, so keep chunks small.
+   constexpr int kWalksPerTask = 16;
+
+   // Managed InternalTerrainCompilationConstants.TriangleEdgeBufferRadius.
+   constexpr double kTriangleEdgeBufferRadius = 5.0 / 1000.0;
+
+   // Managed walks have no step limit; bail out of degenerate cycles instead of hanging a worker.
+   constexpr int kMaxFindOutEdgeIterations = 1000;
+
+   enum Clockness { CounterClockWise = -1, Neither = 0, ClockWise = 1 };
+
+   FORCEINLINE point2f64 operator+(point2f64 a, point2f64 b) { return { a.x + b.x, a.y + b.y }; }
+   FORCEINLINE point2f64 operator-(point2f64 a, point2f64 b) { return { a.x - b.x, a.y - b.y }; }
+   FORCEINLINE point2f64 operator*(point2f64 a, double s) { return { a.x * s, a.y * s }; }
+   FORCEINLINE point2f64 operator/(point2f64 a, double s) { return { a.x / s, a.y / s }; }
+   FORCEINLINE bool operator==(point2f64 a, point2f64 b) { return a.x == b.x && a.y == b.y; }
+
+   FORCEINLINE double Dot(point2f64 a, point2f64 b) { return a.x * b.x + a.y * b.y; }
+   FORCEINLINE double Cross(point2f64 a, point2f64 b) { return a.x * b.y - a.y * b.x; }
+   FORCEINLINE double Norm(point2f64 a) { return std::sqrt(Dot(a, a)); }
+
+   // Managed GeometryOperations.Clockness(ba, bc) and Clockness(a, b, c).
+   FORCEINLINE int ClocknessOf(point2f64 ba, point2f64 bc) { return sign(Cross(ba, bc)); }
+   FORCEINLINE int ClocknessOf(point2f64 a, point2f64 b, point2f64 c) { return ClocknessOf(b - a, b - c); }
+
+   // Managed TryFindNonoverlappingLineSegmentIntersectionT; tForLine is 0 on failure.
+   FORCEINLINE bool TryFindLineSegmentIntersectionT(point2f64 p, point2f64 r, point2f64 q1, point2f64 q2, OUT double& tForLine) {
+      tForLine = 0.0;
+      auto s = q2 - q1;
+      auto rxs = Cross(r, s);
+      if (rxs == 0.0) return false;
+
+      auto qmp = q1 - p;
+      auto t = Cross(qmp, s) / rxs;
+      auto u = Cross(qmp, r) / rxs;
+      if (u < 0.0 || u > 1.0) return false;
+
+      tForLine = t;
+      return true;
+   }
+
+   // Managed TryFindNonoverlappingRaySegmentIntersectionT.
+   FORCEINLINE bool TryFindRaySegmentIntersectionT(point2f64 p, point2f64 dir, const seg2f64& segment, OUT double& tForRay) {
+      auto s = segment.p2 - segment.p1;
+      auto rxs = Cross(dir, s);
+      if (rxs == 0.0) return false;
+
+      auto qmp = segment.p1 - p;
+      auto t = Cross(qmp, s) / rxs;
+      if (t < 0.0) return false;
+
+      auto u = Cross(qmp, dir) / rxs;
+      if (u < 0.0 || u > 1.0) return false;
+
+      tForRay = t;
+      return true;
+   }
+
+   // Managed GeometryOperations.TryIntersectRayWithContainedOriginForVertexIndexOpposingEdge.
+   bool TryIntersectRayWithContainedOrigin(const TriangleMesh& mesh, int triangle, point2f64 origin, point2f64 direction, int skippedEdge, OUT int& indexOpposingEdge) {
+      auto skippedEdgeFirstIndex = skippedEdge == -1 ? -1 : (skippedEdge + 1) % 3;
+      for (auto i = 0; i < 3; i++) {
+         if (i == skippedEdgeFirstIndex) continue;
+
+         auto va = TriangleCorner(mesh, triangle, i) - origin;
+         auto vb = TriangleCorner(mesh, triangle, (i + 1) % 3) - origin;
+         if (ClocknessOf(va, direction) != CounterClockWise && ClocknessOf(direction, vb) != CounterClockWise) {
+            indexOpposingEdge = (i + 2) % 3;
+            return true;
+         }
+      }
+      indexOpposingEdge = -1;
+      return false;
+   }
+
+   // Managed TriangulationWalker2D.PullToCentroid.
+   void PullToCentroid(const TriangleMesh& mesh, int triangle, point2f64& p) {
+      point2f64 centroid = { mesh.CentroidXs[triangle], mesh.CentroidYs[triangle] };
+      auto offsetToCentroid = centroid - p;
+      auto offsetNorm = Norm(offsetToCentroid);
+      if (offsetNorm < kTriangleEdgeBufferRadius) {
+         p = centroid;
+      } else {
+         p = p + offsetToCentroid / offsetNorm * kTriangleEdgeBufferRadius;
+      }
+   }
+
+   // Managed TriangulationWalker2D.FindOutEdgeIndex.
+   int FindOutEdgeIndex(const TriangleMesh& mesh, int triangle, point2f64& p, point2f64 direction, int skippedEdge) {
+      int outEdgeOpposingVertexIndex;
+      point2f64 offset = { 0.0, 0.0 };
+      for (auto it = 0; !TryIntersectRayWithContainedOrigin(mesh, triangle, p + offset, direction, skippedEdge, outEdgeOpposingVertexIndex); ) {
+         offset = offset - direction * kTriangleEdgeBufferRadius;
+         it++;
+         if (it % 5 == 4) PullToCentroid(mesh, triangle, p);
+         if (it == kMaxFindOutEdgeIterations) return -1;
+      }
+      return outEdgeOpposingVertexIndex;
+   }
+
+   // Managed TriangulationWalker2D.FindExitTriangle: wraps around a corner in wrapDirection until
+   // the direction points into a triangle (ok) or a boundary edge is hit (not ok).
+   bool FindExitTriangle(const TriangleMesh& mesh, int initialTriangleIndex, int initialCornerIndex, int initialEdgeToExit, point2f64 direction, int wrapDirection, OUT int& triangleIndex, OUT int& cornerIndex) {
+      auto currentTriangleIndex = initialTriangleIndex;
+      auto currentCornerIndex = initialCornerIndex;
+      auto corner = TriangleCorner(mesh, currentTriangleIndex, currentCornerIndex);
+      auto edgeToExit = initialEdgeToExit;
+
+      // A corner's fan can't hold more triangles than the mesh.
+      for (auto step = 0; step <= mesh.NumTriangles; step++) {
+         auto neighborIndex = mesh.TriangleNeighbors[3 * currentTriangleIndex + edgeToExit];
+         auto neighborInEdge = mesh.NeighborSharedEdges[3 * currentTriangleIndex + edgeToExit];
+         if (neighborIndex == -1) break;
+
+         auto currentTriangleCornerOffset = currentCornerIndex - edgeToExit;
+         auto neighborCornerIndex = (neighborInEdge - currentTriangleCornerOffset + 3) % 3;
+         auto neighborOutEdge = (neighborInEdge + currentTriangleCornerOffset + 3) % 3;
+
+         // Flipped on purpose: edge index i is the edge opposing point i.
+         auto neighborInEdgePoint = TriangleCorner(mesh, neighborIndex, neighborOutEdge);
+         auto neighborOutEdgePoint = TriangleCorner(mesh, neighborIndex, neighborInEdge);
+
+         auto directionCrossOutEdgeRay = ClocknessOf(direction, neighborOutEdgePoint - corner);
+         auto directionCrossInEdgeRay = ClocknessOf(direction, neighborInEdgePoint - corner);
+         if (directionCrossOutEdgeRay != wrapDirection || directionCrossInEdgeRay != -wrapDirection) {
+            currentTriangleIndex = neighborIndex;
+            currentCornerIndex = neighborCornerIndex;
+            edgeToExit = neighborOutEdge;
+         } else {
+            triangleIndex = neighborIndex;
+            cornerIndex = neighborCornerIndex;
+            return true;
+         }
+      }
+
+      triangleIndex = currentTriangleIndex;
+      cornerIndex = currentCornerIndex;
+      return false;
+   }
+
+   // One managed TriangulationWalker2D.WalkTriangulation / Execute.
+   class Walker {
+      const TriangleMesh& mesh;
+      const seg2f64* haltSegments;
+      const int32_t* haltClockness;
+      int numHaltSegments;
+
+      point2f64 p, direction;
+      int currentTriangleIndex;
+      double distanceRemaining;
+      int outEdgeOpposingVertexIndex;
+      int haltingSegment = -1;
+
+   public:
+      Walker(const TriangleMesh& mesh, const seg2f64* haltSegments, const int32_t* haltClockness, int numHaltSegments)
+         : mesh(mesh), haltSegments(haltSegments), haltClockness(haltClockness), numHaltSegments(numHaltSegments) {}
+
+      walk_result Walk(int triangle, point2f64 position, point2f64 displacement) {
+         auto initialDistance = Norm(displacement);
+         p = position;
+         currentTriangleIndex = triangle;
+         distanceRemaining = initialDistance;
+         haltingSegment = -1;
+
+         if (initialDistance > 0.0) {
+            direction = displacement / initialDistance;
+            outEdgeOpposingVertexIndex = FindOutEdgeIndex(mesh, currentTriangleIndex, p, direction, -1);
+            if (outEdgeOpposingVertexIndex != -1) Execute();
+         }
+
+         return { p, currentTriangleIndex, haltingSegment, initialDistance - distanceRemaining };
+      }
+
+   private:
+      void Execute() {
+         auto nextIterationShouldMovePAlongDirectionToEdge = true;
+
+         // Each step crosses a triangle or follows a boundary edge; managed has no limit, but a
+         // walk that long is cycling on degenerate geometry.
+         const auto maxSteps = 16 * mesh.NumTriangles + 64;
+         for (auto step = 0; step < maxSteps; step++) {
+            auto e0 = TriangleCorner(mesh, currentTriangleIndex, (outEdgeOpposingVertexIndex + 1) % 3);
+            auto e1 = TriangleCorner(mesh, currentTriangleIndex, (outEdgeOpposingVertexIndex + 2) % 3);
+            auto e01 = e1 - e0;
+
+            auto distanceToEdge = 0.0;
+            if (nextIterationShouldMovePAlongDirectionToEdge) {
+               double tForRay;
+               TryFindLineSegmentIntersectionT(p, direction, e0, e1, tForRay);
+               distanceToEdge = tForRay;
+
+               auto pAtEdge = p + direction * distanceToEdge;
+               if (distanceToEdge >= distanceRemaining) {
+                  auto pCompletion = p + direction * distanceRemaining;
+                  if (HaltCheck(pCompletion, distanceRemaining)) return;
+                  p = pCompletion;
+                  distanceRemaining = 0;
+                  return;
+               }
+
+               if (HaltCheck(pAtEdge, distanceToEdge)) return;
+               p = pAtEdge;
+               distanceRemaining -= distanceToEdge;
+            }
+
+            auto neighborTriangleIndex = mesh.TriangleNeighbors[3 * currentTriangleIndex + outEdgeOpposingVertexIndex];
+            if (neighborTriangleIndex != -1) {
+               auto sharedEdgeIndexInNeighborTriangle = mesh.NeighborSharedEdges[3 * currentTriangleIndex + outEdgeOpposingVertexIndex];
+               currentTriangleIndex = neighborTriangleIndex;
+               outEdgeOpposingVertexIndex = FindOutEdgeIndex(mesh, neighborTriangleIndex, p, direction, sharedEdgeIndexInNeighborTriangle);
+               if (outEdgeOpposingVertexIndex == -1) return;
+               nextIterationShouldMovePAlongDirectionToEdge = true;
+               continue;
+            }
+
+            // Follow the boundary edge toward the vertex we're heading for.
+            auto walkToEdgeVertex1 = Dot(direction, e01) > 0.0;
+            auto corner = walkToEdgeVertex1 ? e1 : e0;
+            auto pToCorner = corner - p;
+            auto pToCornerMag = Norm(pToCorner);
+            auto pToCornerDirection = pToCorner / pToCornerMag;
+
+            if (pToCornerMag >= distanceRemaining) {
+               auto pTowardCorner = p + pToCornerDirection * distanceRemaining;
+               if (HaltCheck(pTowardCorner, distanceRemaining)) return;
+               p = pTowardCorner;
+               distanceRemaining = 0;
+               return;
+            }
+
+            // Managed passes distanceToEdge here too.
+            if (HaltCheck(corner, distanceToEdge)) return;
+            p = corner;
+            distanceRemaining -= pToCornerMag;
+
+            // Round the corner to find the next triangle.
+            auto cornerIndex = walkToEdgeVertex1 ? (outEdgeOpposingVertexIndex + 2) % 3 : (outEdgeOpposingVertexIndex + 1) % 3;
+            auto edgeToExit = walkToEdgeVertex1 ? (outEdgeOpposingVertexIndex + 1) % 3 : (outEdgeOpposingVertexIndex + 2) % 3;
+            auto wrapDirection = walkToEdgeVertex1 ? CounterClockWise : ClockWise;
+
+            int wrapEndTi, wrapEndCi;
+            if (FindExitTriangle(mesh, currentTriangleIndex, cornerIndex, edgeToExit, direction, wrapDirection, wrapEndTi, wrapEndCi)) {
+               currentTriangleIndex = wrapEndTi;
+               outEdgeOpposingVertexIndex = wrapEndCi;
+               nextIterationShouldMovePAlongDirectionToEdge = true;
+               continue;
+            }
+
+            // Couldn't exit past the corner: slide along the next boundary edge, or snag.
+            auto otherVertOfFollowedEdge = (wrapEndCi - wrapDirection + 3) % 3;
+            auto vertToSlideToward = TriangleCorner(mesh, wrapEndTi, otherVertOfFollowedEdge);
+            if (Dot(vertToSlideToward - corner, direction) > 0) {
+               currentTriangleIndex = wrapEndTi;
+               outEdgeOpposingVertexIndex = (wrapEndCi + wrapDirection + 3) % 3;
+               nextIterationShouldMovePAlongDirectionToEdge = false;
+            } else {
+               return;
+            }
+         }
+      }
+
+      // Managed TriangulationWalker2D.HaltCheck: stops at the nearest halt segment crossed on the
+      // way to next, if within distanceToEdge.
+      bool HaltCheck(point2f64 next, double distanceToEdge) {
+         if (numHaltSegments == 0 || p == next) return false;
+
+         auto toNext = next - p;
+         auto dir = toNext / Norm(toNext);
+
+         auto nearest = -1;
+         auto nearestDistance = std::numeric_limits<double>::infinity();
+         for (auto s = 0; s < numHaltSegments; s++) {
+            const auto& seg = haltSegments[s];
+            auto clock = -ClocknessOf(seg.p1, seg.p2, p);
+            double tForRay;
+            if (clock == haltClockness[s] && TryFindRaySegmentIntersectionT(p, dir, seg, tForRay) && nearestDistance > tForRay) {
+               nearest = s;
+               nearestDistance = tForRay;
+            }
+         }
+
+         if (nearest != -1 && nearestDistance <= distanceToEdge) {
+            p = p + dir * nearestDistance;
+            distanceRemaining -= nearestDistance;
+            haltingSegment = nearest;
+            return true;
+         }
+         return false;
+      }
+   };
+}
+
+void WalkTriangleMesh(
+   const TriangleMesh& mesh, const seg2f64* haltSegments, const int32_t* haltClockness, int numHaltSegments,
+   const int32_t* triangles, const point2f64* positions, const point2f64* displacements, int numWalks,
+   walk_result* results
+) {
+   ParallelFor(numWalks, kWalksPerTask, [&](int i) {
+      Walker walker(mesh, haltSegments, haltClockness, numHaltSegments);
+      results[i] = walker.Walk(triangles[i], positions[i], displacements[i]);
+   });
+}
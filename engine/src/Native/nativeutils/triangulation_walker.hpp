@@ -0,0 +1,20 @@
+#pragma once
+
+#include "triangle_mesh.hpp"
+
+// Result of one managed TriangulationWalker2D.WalkTriangulation.
+typedef struct walk_result_s {
+   point2f64 position;
+   int32_t triangle;
+   int32_t haltSegment; // index of the halt segment that stopped the walk, -1 if none
+   double distanceConsumed;
+} walk_result;
+
+// Walks walker i from positions[i] in triangles[i] along displacements[i] for its full length,
+// as TriangulationWalker2D does: crossing into neighbors, sliding along boundary edges and
+// wrapping corners, stopping at a snag or when a halt segment is crossed. Halt segment s stops
+// walkers on its haltClockness[s] side (managed OutboundEdgeSegments). Walks run in parallel.
+void WalkTriangleMesh(
+   const TriangleMesh& mesh, const seg2f64* haltSegments, const int32_t* haltClockness, int numHaltSegments,
+   const int32_t* triangles, const point2f64* positions, const point2f64* displacements, int numWalks,
+   walk_result* results);
@@ -0,0 +1,149 @@
+#include "pch.h"
+#include "visibility_graph.hpp"
+#include "dllmain.hpp"
+#include "parallel.hpp"
+
+#include <numeric>
+
+namespace {
+   // Rows of the link triangle per task; row i has numWaypoints - i - 1 candidates.
+   constexpr int kRowsPerTask = 4;
+
+   // Start of row i of the packed upper triangle: entries (i, j) for j in (i, n).
+   FORCEINLINE size_t TriangleRowOffset(int n, int i) {
+      return static_cast<size_t>(i) * (2 * static_cast<size_t>(n) - i - 1) / 2;
+   }
+
+   // Direction from an origin reduced to lowest terms, packed as a sort key.
+   FORCEINLINE uint64_t DirectionKey(int64_t dx, int64_t dy) {
+      auto g = std::gcd(dx, dy);
+      return (static_cast<uint64_t>(static_cast<uint32_t>(dx / g)) << 32) | static_cast<uint32_t>(dy / g);
+   }
+
+   FORCEINLINE bool SegmentContains(const seg2i32& s, point2i32 q) {
+      int64_t bax = s.x2 - s.x1, bay = s.y2 - s.y1;
+      int64_t qax = q.x - s.x1, qay = q.y - s.y1;
+      if (bax * qay - bay * qax != 0) return false;
+      auto dot = bax * qax + bay * qay;
+      return dot >= 0 && dot <= bax * bax + bay * bay;
+   }
+}
+
+void BuildVisibilityGraph(
+   const point2i32* waypoints, int numWaypoints, const seg2i32* barriers, int numBarriers,
+   int* offsets, int* edgeTargets, float* edgeCosts, int edgeCapacity, OUT int& numEdges
+) {
+   // Link (i, j), i < j, is occluded[TriangleRowOffset(n, i) + j - i - 1].
+   const auto n = numWaypoints;
+   const auto numTasks = (n + kRowsPerTask - 1) / kRowsPerTask;
+   std::vector<uint8_t> occluded(TriangleRowOffset(n, n), 0);
+
+   // A barrier-free sector sees everything (and the chunk loader needs at least one barrier).
+   if (numBarriers > 0) {
+      std::vector<seg2i16> barriers16(numBarriers);
+      for (auto i = 0; i < numBarriers; i++) {
+         const auto& b = barriers[i];
+         barriers16[i] = ToSeg2i16(b.x1, b.y1, b.x2, b.y2);
+      }
+      auto prequeryState = ::LoadPrequeryBarriersIntersectionState(barriers16.data(), numBarriers);
+
+      ParallelFor(numTasks, 1, [&](int task) {
+         std::vector<seg2i16> queries;
+         for (auto i = task * kRowsPerTask; i < std::min(n, (task + 1) * kRowsPerTask); i++) {
+            auto numCandidates = n - i - 1;
+            if (numCandidates <= 0) continue;
+
+            queries.resize(numCandidates);
+            const auto a = waypoints[i];
+            for (auto j = i + 1; j < n; j++) {
+               const auto b = waypoints[j];
+               queries[j - i - 1] = ToSeg2i16(a.x, a.y, b.x, b.y);
+            }
+            ::QueryAnyIntersections(prequeryState, queries.data(), numCandidates, occluded.data() + TriangleRowOffset(n, i));
+         }
+      });
+   }
+
+   // The kernel only sees crossings. Endpoint contact is the rest of managed Intersects: a
+   // waypoint on a barrier blocks all its links, and a barrier endpoint on link (i, j) lies in
+   // j's direction from i no farther than j.
+   if (numBarriers > 0) {
+      std::vector<point2i32> endpoints;
+      endpoints.reserve(2 * numBarriers);
+      for (auto k = 0; k < numBarriers; k++) {
+         endpoints.push_back(barriers[k].p1);
+         endpoints.push_back(barriers[k].p2);
+      }
+      std::sort(endpoints.begin(), endpoints.end(), [](point2i32 a, point2i32 b) { return std::tie(a.x, a.y) < std::tie(b.x, b.y); });
+      endpoints.erase(std::unique(endpoints.begin(), endpoints.end(), [](point2i32 a, point2i32 b) { return a.x == b.x && a.y == b.y; }), endpoints.end());
+
+      std::vector<uint8_t> onBarrier(n, 0);
+      ParallelFor(n, kRowsPerTask, [&](int i) {
+         for (auto k = 0; k < numBarriers && !onBarrier[i]; k++) {
+            onBarrier[i] = SegmentContains(barriers[k], waypoints[i]);
+         }
+      });
+
+      ParallelFor(numTasks, 1, [&](int task) {
+         // (direction, squared distance) of every barrier endpoint from the current waypoint,
+         // sorted so each direction's nearest endpoint comes first. Reused across the task's rows.
+         std::vector<std::pair<uint64_t, int64_t>> nearestEndpoints;
+         nearestEndpoints.reserve(endpoints.size());
+         for (auto i = task * kRowsPerTask; i < std::min(n, (task + 1) * kRowsPerTask); i++) {
+            // row[j - i - 1] is link (i, j)
+            auto row = occluded.data() + TriangleRowOffset(n, i);
+            if (onBarrier[i]) {
+               std::fill(row, row + n - i - 1, 1);
+               continue;
+            }
+
+            const auto a = waypoints[i];
+            nearestEndpoints.clear();
+            for (const auto& e : endpoints) {
+               int64_t dx = e.x - a.x, dy = e.y - a.y;
+               auto distance = dx * dx + dy * dy;
+               if (distance == 0) continue;
+               nearestEndpoints.emplace_back(DirectionKey(dx, dy), distance);
+            }
+            std::sort(nearestEndpoints.begin(), nearestEndpoints.end());
+            nearestEndpoints.erase(std::unique(nearestEndpoints.begin(), nearestEndpoints.end(), [](const auto& x, const auto& y) { return x.first == y.first; }), nearestEndpoints.end());
+
+            for (auto j = i + 1; j < n; j++) {
+               auto& linkOccluded = row[j - i - 1];
+               if (linkOccluded) continue;
+               if (onBarrier[j]) {
+                  linkOccluded = 1;
+                  continue;
+               }
+
+               int64_t dx = waypoints[j].x - a.x, dy = waypoints[j].y - a.y;
+               if (dx == 0 && dy == 0) continue;
+               auto key = DirectionKey(dx, dy);
+               auto it = std::lower_bound(nearestEndpoints.begin(), nearestEndpoints.end(), std::make_pair(key, INT64_MIN));
+               if (it != nearestEndpoints.end() && it->first == key && it->second <= dx * dx + dy * dy) linkOccluded = 1;
+            }
+         }
+      });
+   }
+
+   auto isLinked = [&](int i, int j) {
+      return i < j ? !occluded[TriangleRowOffset(n, i) + j - i - 1] : !occluded[TriangleRowOffset(n, j) + i - j - 1];
+   };
+
+   numEdges = 0;
+   for (auto i = 0; i < n; i++) {
+      offsets[i] = numEdges;
+      for (auto j = 0; j < n; j++) {
+         if (i == j || !isLinked(i, j)) continue;
+
+         if (numEdges < edgeCapacity) {
+            auto dx = static_cast<float>(waypoints[j].x - waypoints[i].x);
+            auto dy = static_cast<float>(waypoints[j].y - waypoints[i].y);
+            edgeTargets[numEdges] = j;
+            edgeCosts[numEdges] = std::sqrt(dx * dx + dy * dy);
+         }
+         numEdges++;
+      }
+   }
+   offsets[n] = numEdges;
+}
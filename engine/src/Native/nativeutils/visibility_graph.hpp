@@ -0,0 +1,16 @@
+#pragma once
+
+#include "geometry.hpp"
+
+// Same construction as managed PolyNodeVisibilityGraph.Construct's barrier route: waypoints
+// i and j are linked iff segment (i, j) intersects no barrier, at cost |i - j|. As with
+// bvh.Intersects, touching counts: a waypoint on a barrier links to nothing, and a link through
+// a barrier endpoint (including one collinear with a barrier) is blocked. Crossings are tested
+// with the AVX2 any-intersection kernel, so coordinates must fit in int16.
+//
+// Output is CSR (offsets has numWaypoints + 1 entries) with each node's neighbors ascending,
+// matching the managed edge order. Every link is stored in both directions, so numEdges is
+// twice the link count; if it exceeds edgeCapacity only offsets are valid.
+void BuildVisibilityGraph(
+   const point2i32* waypoints, int numWaypoints, const seg2i32* barriers, int numBarriers,
+   int* offsets, int* edgeTargets, float* edgeCosts, int edgeCapacity, OUT int& numEdges);
@@ -0,0 +1,232 @@
+#include "pch.h"
+#include "visibility_polygon_queries.hpp"
+#include "parallel.hpp"
+#include <limits>
+
+namespace {
+   constexpr int kLanes = 4;
+
+   // PseudoAngle() four lanes at a time, bit-identical to the scalar version: each quadrant's
+   // formula is a quadrant base plus |one coordinate| / (|dx| + |dy|).
+   FORCEINLINE __m256d PseudoAngleAvx2(__m256d dx, __m256d dy) {
+      const __m256d zero = _mm256_setzero_pd();
+      const __m256d signMask = _mm256_set1_pd(-0.0);
+
+      auto ax = _mm256_andnot_pd(signMask, dx);
+      auto ay = _mm256_andnot_pd(signMask, dy);
+      auto dxNegative = _mm256_cmp_pd(dx, zero, _CMP_LT_OQ);
+      auto dyNegative = _mm256_cmp_pd(dy, zero, _CMP_LT_OQ);
+
+      // Quadrants 1 and 3 measure |dy|, 2 and 4 measure |dx|; bases are 0, 1, 2, 3.
+      auto oddQuadrant = _mm256_xor_pd(dxNegative, dyNegative);
+      auto numerator = _mm256_blendv_pd(ay, ax, oddQuadrant);
+      auto base = _mm256_add_pd(
+         _mm256_and_pd(dyNegative, _mm256_set1_pd(2.0)),
+         _mm256_and_pd(oddQuadrant, _mm256_set1_pd(1.0)));
+      return _mm256_add_pd(base, _mm256_div_pd(numerator, _mm256_add_pd(ax, ay)));
+   }
+
+   // 4x64-bit lane mask => 4x32-bit lane mask.
+   FORCEINLINE __m128i NarrowMask(__m256d mask) {
+      auto narrowed = _mm256_permutevar8x32_epi32(_mm256_castpd_si256(mask), _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6));
+      return _mm256_castsi256_si128(narrowed);
+   }
+
+   // Per lane, the last range of the lane's polygon starting at or before theta (or strictly
+   // before, for kCmp = _CMP_LT_OQ). Lanes with no such range or a NaN theta stay on their first.
+   template <int kCmp = _CMP_LE_OQ>
+   FORCEINLINE __m128i FindRangeIndicesAvx2(const VisibilityPolygonQueryState& state, int originIndex, __m256d theta) {
+      auto base = _mm_loadu_si128(reinterpret_cast<const __m128i*>(state.RangeBegins.data() + originIndex));
+      auto len = _mm_loadu_si128(reinterpret_cast<const __m128i*>(state.RangeCounts.data() + originIndex));
+      const auto thetaStarts = state.RangeThetaStarts.data();
+
+      for (auto step = 0; step < state.SearchSteps; step++) {
+         auto half = _mm_srli_epi32(len, 1);
+         auto mid = _mm_add_epi32(base, half);
+         auto midTheta = _mm256_i32gather_pd(thetaStarts, mid, 8);
+         auto goRight = NarrowMask(_mm256_cmp_pd(midTheta, theta, kCmp));
+         base = _mm_add_epi32(base, _mm_and_si128(half, goRight));
+         len = _mm_sub_epi32(len, half);
+      }
+      return base;
+   }
+
+   // Managed GeometryOperations.Clockness(a, b, c) on doubles.
+   FORCEINLINE int Clockness(double ax, double ay, double bx, double by, double cx, double cy) {
+      return sign((bx - ax) * (by - cy) - (by - ay) * (bx - cx));
+   }
+
+   // Managed OverlappingIntSegmentOriginDistanceComparator.Compare with a the query segment and b
+   // range r's barrier: <= 0 if a is at least as near to the origin where their ranges overlap.
+   // a must face the origin; b always does.
+   FORCEINLINE int CompareOriginDistance(double px, double py, const seg2f64& a, const VisibilityPolygonQueryState& state, int r) {
+      auto bx1 = state.RangeX1s[r], by1 = state.RangeY1s[r], bx2 = state.RangeX2s[r], by2 = state.RangeY2s[r];
+      if (Clockness(px, py, a.x1, a.y1, bx1, by1) != -1) {
+         auto res = Clockness(bx1, by1, bx2, by2, a.x1, a.y1);
+         return res != 0 ? res : Clockness(bx1, by1, bx2, by2, a.x2, a.y2);
+      } else {
+         auto res = -Clockness(a.x1, a.y1, a.x2, a.y2, bx1, by1);
+         return res != 0 ? res : -Clockness(a.x1, a.y1, a.x2, a.y2, bx2, by2);
+      }
+   }
+
+   // Whether any range in [first, last] of origin i's polygon sees past the segment.
+   FORCEINLINE bool AnyRangeSeesSegment(const VisibilityPolygonQueryState& state, int i, const seg2f64& facing, int first, int last) {
+      for (auto r = first; r <= last; r++) {
+         // Nothing in sight, so nothing hides the segment.
+         if (std::isnan(state.RangeX1s[r])) return true;
+         if (CompareOriginDistance(state.OriginXs[i], state.OriginYs[i], facing, state, r) <= 0) return true;
+      }
+      return false;
+   }
+
+   void MarkSegmentSeeingOrigins(const VisibilityPolygonQueryState& state, const seg2f64& segment, uint32_t* bits) {
+      const __m256d zero = _mm256_setzero_pd();
+      const auto x1 = _mm256_set1_pd(segment.x1), y1 = _mm256_set1_pd(segment.y1);
+      const auto x2 = _mm256_set1_pd(segment.x2), y2 = _mm256_set1_pd(segment.y2);
+      const seg2f64 flipped = { { { segment.x2, segment.y2, segment.x1, segment.y1 } } };
+
+      for (auto i = 0; i < state.NumOriginsPadded; i += kLanes) {
+         auto ox = _mm256_loadu_pd(state.OriginXs.data() + i);
+         auto oy = _mm256_loadu_pd(state.OriginYs.data() + i);
+         auto dx1 = _mm256_sub_pd(x1, ox), dy1 = _mm256_sub_pd(y1, oy);
+         auto dx2 = _mm256_sub_pd(x2, ox), dy2 = _mm256_sub_pd(y2, oy);
+
+         // The segment spans counterclockwise from p1 to p2 if cross > 0, else from p2 to p1.
+         auto cross = _mm256_sub_pd(_mm256_mul_pd(dx1, dy2), _mm256_mul_pd(dy1, dx2));
+         auto ccw = _mm256_cmp_pd(cross, zero, _CMP_GT_OQ);
+         auto theta1 = PseudoAngleAvx2(dx1, dy1);
+         auto theta2 = PseudoAngleAvx2(dx2, dy2);
+         auto thetaStart = _mm256_blendv_pd(theta2, theta1, ccw);
+         auto thetaEnd = _mm256_blendv_pd(theta1, theta2, ccw);
+
+         alignas(16) int32_t firsts[kLanes], lasts[kLanes];
+         alignas(32) double starts[kLanes], ends[kLanes], crosses[kLanes];
+         _mm_store_si128(reinterpret_cast<__m128i*>(firsts), FindRangeIndicesAvx2(state, i, thetaStart));
+         _mm_store_si128(reinterpret_cast<__m128i*>(lasts), FindRangeIndicesAvx2<_CMP_LT_OQ>(state, i, thetaEnd));
+         _mm256_store_pd(starts, thetaStart);
+         _mm256_store_pd(ends, thetaEnd);
+         _mm256_store_pd(crosses, cross);
+
+         auto numLanes = std::min(kLanes, state.NumOrigins - i);
+         for (auto lane = 0; lane < numLanes; lane++) {
+            auto origin = i + lane;
+            auto seen = crosses[lane] == 0; // collinear with (or on) the segment
+            if (!seen) {
+               const auto& facing = crosses[lane] > 0 ? segment : flipped;
+               if (starts[lane] <= ends[lane]) {
+                  seen = AnyRangeSeesSegment(state, origin, facing, firsts[lane], std::max(firsts[lane], lasts[lane]));
+               } else {
+                  // Wraps through theta = 0.
+                  auto polygonBegin = state.RangeBegins[origin];
+                  auto polygonLast = polygonBegin + state.RangeCounts[origin] - 1;
+                  seen = AnyRangeSeesSegment(state, origin, facing, firsts[lane], polygonLast) ||
+                         AnyRangeSeesSegment(state, origin, facing, polygonBegin, lasts[lane]);
+               }
+            }
+
+            if (seen) bits[origin >> 5] |= 1u << (origin & 31);
+         }
+      }
+   }
+}
+
+std::shared_ptr<VisibilityPolygonQueryState> LoadVisibilityPolygonQueryState(const point2i32* origins, int numOrigins, const seg2i32* barriers, int numBarriers) {
+   VisibilityPolygonSet polygons;
+   ::BuildVisibilityPolygons(origins, numOrigins, barriers, numBarriers, OUT polygons);
+   const auto numRanges = static_cast<int>(polygons.Ids.size());
+
+   const auto nan = std::numeric_limits<double>::quiet_NaN();
+   auto state = std::make_shared<VisibilityPolygonQueryState>();
+   state->NumOrigins = numOrigins;
+   state->NumOriginsPadded = (numOrigins + kLanes - 1) & ~(kLanes - 1);
+   state->OriginXs.assign(state->NumOriginsPadded, nan);
+   state->OriginYs.assign(state->NumOriginsPadded, nan);
+   state->RangeBegins.assign(state->NumOriginsPadded, numRanges);
+   state->RangeCounts.assign(state->NumOriginsPadded, 1);
+
+   auto maxRangeCount = 1;
+   for (auto i = 0; i < numOrigins; i++) {
+      state->OriginXs[i] = origins[i].x;
+      state->OriginYs[i] = origins[i].y;
+      state->RangeBegins[i] = polygons.Offsets[i];
+      state->RangeCounts[i] = polygons.Offsets[i + 1] - polygons.Offsets[i];
+      maxRangeCount = std::max(maxRangeCount, state->RangeCounts[i]);
+   }
+
+   state->SearchSteps = 0;
+   while ((1 << state->SearchSteps) < maxRangeCount) state->SearchSteps++;
+
+   state->RangeThetaStarts = std::move(polygons.ThetaStarts);
+   state->RangeThetaStarts.push_back(0.0);
+   state->RangeX1s.assign(numRanges + 1, nan);
+   state->RangeY1s.assign(numRanges + 1, nan);
+   state->RangeX2s.assign(numRanges + 1, nan);
+   state->RangeY2s.assign(numRanges + 1, nan);
+   for (auto r = 0; r < numRanges; r++) {
+      auto id = polygons.Ids[r];
+      if (id == kRangeIdInfinitelyFar) continue;
+
+      state->RangeX1s[r] = barriers[id].x1;
+      state->RangeY1s[r] = barriers[id].y1;
+      state->RangeX2s[r] = barriers[id].x2;
+      state->RangeY2s[r] = barriers[id].y2;
+   }
+   return state;
+}
+
+void QueryPointSeeingOrigins(
+   std::shared_ptr<VisibilityPolygonQueryState> statePtr, const point2f64* points, int numPoints,
+   std::vector<int>& offsets, std::vector<int32_t>& originIndices, std::vector<float>& distances
+) {
+   const auto& state = *statePtr;
+   const __m256d zero = _mm256_setzero_pd();
+
+   offsets.resize(numPoints + 1);
+   for (auto p = 0; p < numPoints; p++) {
+      offsets[p] = static_cast<int>(originIndices.size());
+      const auto px = _mm256_set1_pd(points[p].x);
+      const auto py = _mm256_set1_pd(points[p].y);
+
+      for (auto i = 0; i < state.NumOriginsPadded; i += kLanes) {
+         auto dx = _mm256_sub_pd(px, _mm256_loadu_pd(state.OriginXs.data() + i));
+         auto dy = _mm256_sub_pd(py, _mm256_loadu_pd(state.OriginYs.data() + i));
+         auto ranges = FindRangeIndicesAvx2(state, i, PseudoAngleAvx2(dx, dy));
+
+         auto x1 = _mm256_i32gather_pd(state.RangeX1s.data(), ranges, 8);
+         auto y1 = _mm256_i32gather_pd(state.RangeY1s.data(), ranges, 8);
+         auto x2 = _mm256_i32gather_pd(state.RangeX2s.data(), ranges, 8);
+         auto y2 = _mm256_i32gather_pd(state.RangeY2s.data(), ranges, 8);
+
+         // Contained unless Clockness(s1, s2, p) is clockwise; NaN (nothing in sight, padding) fails.
+         auto clk = _mm256_sub_pd(
+            _mm256_mul_pd(_mm256_sub_pd(x2, x1), _mm256_sub_pd(y2, py)),
+            _mm256_mul_pd(_mm256_sub_pd(y2, y1), _mm256_sub_pd(x2, px)));
+         auto inside = _mm256_cmp_pd(clk, zero, _CMP_LE_OQ);
+         auto atOrigin = _mm256_and_pd(_mm256_cmp_pd(dx, zero, _CMP_EQ_OQ), _mm256_cmp_pd(dy, zero, _CMP_EQ_OQ));
+
+         auto mask = _mm256_movemask_pd(_mm256_or_pd(inside, atOrigin));
+         if (!mask) continue;
+
+         alignas(32) double laneDistances[kLanes];
+         _mm256_store_pd(laneDistances, _mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy))));
+         for (auto lane = 0; lane < kLanes; lane++) {
+            if (mask & (1 << lane)) {
+               originIndices.push_back(i + lane);
+               distances.push_back(static_cast<float>(laneDistances[lane]));
+            }
+         }
+      }
+   }
+   offsets[numPoints] = static_cast<int>(originIndices.size());
+}
+
+void QuerySegmentSeeingOrigins(std::shared_ptr<VisibilityPolygonQueryState> statePtr, const seg2f64* segments, int numSegments, uint32_t* seeingOriginBits) {
+   const auto& state = *statePtr;
+   const auto numWords = SeeingOriginsBitsetWords(state);
+   std::fill_n(seeingOriginBits, static_cast<size_t>(numSegments) * numWords, 0u);
+
+   ParallelFor(numSegments, 4, [&](int s) {
+      MarkSegmentSeeingOrigins(state, segments[s], seeingOriginBits + static_cast<size_t>(s) * numWords);
+   });
+}
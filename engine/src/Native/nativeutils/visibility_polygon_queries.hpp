@@ -0,0 +1,38 @@
+#pragma once
+
+#include "visibility_polygons.hpp"
+
+// A sector's waypoint visibility polygons packed for batched queries. Origins are SoA, padded to
+// a multiple of four. Ranges are SoA too, each carrying a copy of the barrier it sees so a lookup
+// needs one gather per coordinate; ranges that see nothing hold NaN, as does a trailing sentinel
+// range that padding lanes point at, so neither ever matches.
+// Coordinates must stay below 2^25 for the double-precision clockness tests to be exact.
+typedef struct VisibilityPolygonQueryState_s {
+   int NumOrigins;
+   int NumOriginsPadded;
+   int SearchSteps; // ceil(log2(largest polygon's range count))
+
+   std::vector<double> OriginXs, OriginYs;
+   std::vector<int32_t> RangeBegins, RangeCounts;
+
+   std::vector<double> RangeThetaStarts;
+   std::vector<double> RangeX1s, RangeY1s, RangeX2s, RangeY2s;
+} VisibilityPolygonQueryState;
+
+std::shared_ptr<VisibilityPolygonQueryState> LoadVisibilityPolygonQueryState(const point2i32* origins, int numOrigins, const seg2i32* barriers, int numBarriers);
+
+// For each point, the origins whose polygon contains it (managed VisibilityPolygon.Contains) and
+// their distance to it. Point i's results are [offsets[i], offsets[i + 1]), origins ascending.
+void QueryPointSeeingOrigins(
+   std::shared_ptr<VisibilityPolygonQueryState> state, const point2f64* points, int numPoints,
+   std::vector<int>& offsets, std::vector<int32_t>& originIndices, std::vector<float>& distances);
+
+// Words per segment in QuerySegmentSeeingOrigins' bitsets.
+FORCEINLINE int SeeingOriginsBitsetWords(const VisibilityPolygonQueryState& state) {
+   return (state.NumOrigins + 31) / 32;
+}
+
+// For each segment, the origins that see some part of it (managed VisibilityPolygon.IsPartiallyVisible,
+// except ranges that see nothing never hide it), as bitsets: origin i sees segment s if bit i % 32
+// of word s * SeeingOriginsBitsetWords() + i / 32 is set.
+void QuerySegmentSeeingOrigins(std::shared_ptr<VisibilityPolygonQueryState> state, const seg2f64* segments, int numSegments, uint32_t* seeingOriginBits);
@@ -0,0 +1,159 @@
+#include "pch.h"
+#include "visibility_polygons.hpp"
+#include "parallel.hpp"
+
+namespace {
+   // Origins per task; a task reuses one builder's scratch buffers across its origins.
+   constexpr int kOriginsPerTask = 16;
+
+   constexpr int kCounterClockwise = -1;
+
+   // Managed GeometryOperations.Clockness(a, b, c).
+   FORCEINLINE int Clockness(int64_t ax, int64_t ay, int64_t bx, int64_t by, int64_t cx, int64_t cy) {
+      return sign((bx - ax) * (by - cy) - (by - ay) * (bx - cx));
+   }
+
+   FORCEINLINE int Clockness(point2i32 a, point2i32 b, point2i32 c) {
+      return Clockness(a.x, a.y, b.x, b.y, c.x, c.y);
+   }
+
+   // Managed OverlappingIntSegmentOriginDistanceComparator.Compare: < 0 if a is nearer to p than b
+   // where their angular ranges overlap. Both must face p.
+   int CompareOriginDistance(point2i32 p, const seg2i32& a, const seg2i32& b) {
+      if (Clockness(p, a.p1, b.p1) != kCounterClockwise) {
+         // b starts first (clockwise of a); which side of b is a on?
+         auto res = Clockness(b.p1, b.p2, a.p1);
+         if (res != 0) return res;
+
+         // b1 b2 a1 collinear; a2 breaks the tie.
+         return Clockness(b.p1, b.p2, a.p2);
+      } else {
+         // a starts first; which side of a is b on?
+         auto res = -Clockness(a.p1, a.p2, b.p1);
+         if (res != 0) return res;
+
+         return -Clockness(a.p1, a.p2, b.p2);
+      }
+   }
+
+   struct SweepEvent {
+      double Theta;
+      int32_t Id;
+      bool Add;
+   };
+
+   class VisibilityPolygonBuilder {
+      std::vector<SweepEvent> events;
+      std::vector<int32_t> active;
+
+   public:
+      void Build(point2i32 origin, const seg2i32* barriers, int numBarriers, std::vector<int32_t>& ids, std::vector<double>& thetaStarts) {
+         events.clear();
+         for (auto i = 0; i < numBarriers; i++) {
+            const auto& s = barriers[i];
+
+            // front-face looks CCW to us
+            if (Clockness(origin, s.p1, s.p2) != kCounterClockwise) continue;
+
+            auto theta1 = PseudoAngle(static_cast<double>(s.x1) - origin.x, static_cast<double>(s.y1) - origin.y);
+            auto theta2 = PseudoAngle(static_cast<double>(s.x2) - origin.x, static_cast<double>(s.y2) - origin.y);
+            if (theta1 == theta2) continue;
+
+            // Facing segments sweep counterclockwise from p1 to p2, so p1 above p2 means they cross theta = 0.
+            if (theta1 < theta2) {
+               events.push_back({ theta1, i, true });
+               events.push_back({ theta2, i, false });
+            } else {
+               if (theta2 > 0) {
+                  events.push_back({ 0.0, i, true });
+                  events.push_back({ theta2, i, false });
+               }
+               events.push_back({ theta1, i, true });
+               events.push_back({ kPseudoAngleFullTurn, i, false });
+            }
+         }
+
+         // Removals sort before additions at the same angle.
+         std::sort(events.begin(), events.end(), [](const SweepEvent& a, const SweepEvent& b) {
+            return a.Theta != b.Theta ? a.Theta < b.Theta : a.Add < b.Add;
+         });
+
+         const auto firstRange = ids.size();
+         auto emit = [&](int32_t id, double thetaStart) {
+            if (ids.size() > firstRange && ids.back() == id) return; // extends the previous range
+            ids.push_back(id);
+            thetaStarts.push_back(thetaStart);
+         };
+
+         // Only the nearest active segment matters, and few are active at once, so track that
+         // and rescan only when it's removed.
+         active.clear();
+         auto nearest = kRangeIdInfinitelyFar;
+         auto lastTheta = 0.0;
+         for (const auto& e : events) {
+            if (e.Theta != lastTheta) {
+               emit(nearest, lastTheta);
+               lastTheta = e.Theta;
+            }
+
+            if (e.Add) {
+               active.push_back(e.Id);
+               if (nearest == kRangeIdInfinitelyFar || CompareOriginDistance(origin, barriers[e.Id], barriers[nearest]) < 0) {
+                  nearest = e.Id;
+               }
+            } else {
+               auto it = std::find(active.begin(), active.end(), e.Id);
+               *it = active.back();
+               active.pop_back();
+
+               if (e.Id == nearest) {
+                  nearest = kRangeIdInfinitelyFar;
+                  for (auto id : active) {
+                     if (nearest == kRangeIdInfinitelyFar || CompareOriginDistance(origin, barriers[id], barriers[nearest]) < 0) {
+                        nearest = id;
+                     }
+                  }
+               }
+            }
+         }
+
+         if (ids.size() == firstRange || lastTheta < kPseudoAngleFullTurn) {
+            emit(kRangeIdInfinitelyFar, lastTheta);
+         }
+      }
+   };
+}
+
+void BuildVisibilityPolygons(const point2i32* origins, int numOrigins, const seg2i32* barriers, int numBarriers, OUT VisibilityPolygonSet& result) {
+   auto numTasks = (numOrigins + kOriginsPerTask - 1) / kOriginsPerTask;
+   std::vector<std::vector<int32_t>> taskIds(numTasks);
+   std::vector<std::vector<double>> taskThetaStarts(numTasks);
+
+   // Offsets[i + 1] holds polygon i's range count until the prefix sum below.
+   result.Offsets.assign(numOrigins + 1, 0);
+   ParallelFor(numTasks, 1, [&](int task) {
+      VisibilityPolygonBuilder builder;
+      auto& ids = taskIds[task];
+      auto& thetaStarts = taskThetaStarts[task];
+
+      auto end = std::min(numOrigins, (task + 1) * kOriginsPerTask);
+      for (auto i = task * kOriginsPerTask; i < end; i++) {
+         auto before = ids.size();
+         builder.Build(origins[i], barriers, numBarriers, ids, thetaStarts);
+         result.Offsets[i + 1] = static_cast<int>(ids.size() - before);
+      }
+   });
+
+   for (auto i = 0; i < numOrigins; i++) {
+      result.Offsets[i + 1] += result.Offsets[i];
+   }
+
+   result.Ids.clear();
+   result.ThetaStarts.clear();
+   result.Ids.reserve(result.Offsets[numOrigins]);
+   result.ThetaStarts.reserve(result.Offsets[numOrigins]);
+   for (auto task = 0; task < numTasks; task++) {
+      result.Ids.insert(result.Ids.end(), taskIds[task].begin(), taskIds[task].end());
+      result.ThetaStarts.insert(result.ThetaStarts.end(), taskThetaStarts[task].begin(), taskThetaStarts[task].end());
+   }
+}
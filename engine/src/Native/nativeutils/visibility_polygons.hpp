@@ -0,0 +1,32 @@
+#pragma once
+
+#include "geometry.hpp"
+
+// Range ids match managed VisibilityPolygon: a barrier index, or nothing in sight.
+constexpr int32_t kRangeIdInfinitelyFar = -1;
+
+// Angles are diamond pseudo-angles: monotonic with atan2 over [0, 2pi) but cost one divide.
+constexpr double kPseudoAngleFullTurn = 4.0;
+
+// Maps direction (dx, dy) != (0, 0) into [0, 4), counterclockwise from +x.
+FORCEINLINE double PseudoAngle(double dx, double dy) {
+   if (dy >= 0) {
+      return dx >= 0 ? dy / (dx + dy) : 1 - dx / (-dx + dy);
+   } else {
+      return dx < 0 ? 2 - dy / (-dx - dy) : 3 + dx / (dx - dy);
+   }
+}
+
+// Visibility polygons of many origins, packed back to back. Polygon i is ranges
+// [Offsets[i], Offsets[i + 1]); range r covers pseudo-angles from ThetaStarts[r] up to the next
+// range's start (kPseudoAngleFullTurn for the polygon's last range) and sees barrier Ids[r].
+typedef struct VisibilityPolygonSet_s {
+   std::vector<int> Offsets;
+   std::vector<int32_t> Ids;
+   std::vector<double> ThetaStarts;
+} VisibilityPolygonSet;
+
+// Same angular sweep as managed VisibilityPolygon.Create, run for every origin in parallel.
+// Only barriers that face an origin (counterclockwise from it) occlude it, and barriers may
+// only intersect at endpoints.
+void BuildVisibilityPolygons(const point2i32* origins, int numOrigins, const seg2i32* barriers, int numBarriers, OUT VisibilityPolygonSet& result);
@@ -0,0 +1,76 @@
+﻿using System;
+using System.Collections.Generic;
+using Xunit;
+
+namespace Dargon.Terragami.Tests {
+   public class AllPairsShortestPathsTests {
+      // The blocked, threaded Floyd-Warshall must match the plain triple loop, including graphs
+      // that don't fill whole tiles and unreachable pairs, and its predecessors must walk back to
+      // the source.
+      [Fact]
+      public void ComputeAllPairsShortestPathsMatchesFloydWarshall() {
+         for (var seed = 0; seed < 30; seed++) {
+            var r = new Random(seed);
+            var numNodes = 1 + r.Next(200);
+            var (offsets, edgeTargets, edgeCosts) = CreateRandomGraph(r, numNodes);
+
+            var expected = new float[numNodes, numNodes];
+            for (var i = 0; i < numNodes; i++) {
+               for (var j = 0; j < numNodes; j++) {
+                  expected[i, j] = i == j ? 0 : float.PositiveInfinity;
+               }
+            }
+            for (var i = 0; i < numNodes; i++) {
+               for (var e = offsets[i]; e < offsets[i + 1]; e++) {
+                  var j = edgeTargets[e];
+                  if (i == j) continue;
+                  expected[i, j] = expected[j, i] = Math.Min(expected[i, j], edgeCosts[e]);
+               }
+            }
+            for (var k = 0; k < numNodes; k++) {
+               for (var i = 0; i < numNodes; i++) {
+                  for (var j = 0; j < numNodes; j++) {
+                     expected[i, j] = Math.Min(expected[i, j], expected[i, k] + expected[k, j]);
+                  }
+               }
+            }
+
+            var (costs, predecessors) = NativeUtils.ComputeAllPairsShortestPaths(offsets, edgeTargets, edgeCosts);
+            for (var i = 0; i < numNodes; i++) {
+               for (var j = 0; j < numNodes; j++) {
+                  var cost = costs[i * numNodes + j];
+                  if (float.IsPositiveInfinity(expected[i, j])) {
+                     Assert.True(float.IsPositiveInfinity(cost));
+                     Assert.Equal(-1, predecessors[i * numNodes + j]);
+                     continue;
+                  }
+
+                  Assert.True(Math.Abs(cost - expected[i, j]) <= 1E-3f * Math.Max(1, expected[i, j]));
+
+                  var current = j;
+                  for (var steps = 0; current != i && steps < numNodes; steps++) {
+                     current = predecessors[i * numNodes + current];
+                  }
+                  Assert.Equal(i, current);
+               }
+            }
+         }
+      }
+
+      // Undirected, with some edges listed once, some twice, parallel edges and isolated nodes.
+      internal static (int[] offsets, int[] edgeTargets, float[] edgeCosts) CreateRandomGraph(Random r, int numNodes) {
+         var offsets = new int[numNodes + 1];
+         var edgeTargets = new List<int>();
+         var edgeCosts = new List<float>();
+         for (var i = 0; i < numNodes; i++) {
+            var degree = r.Next(4);
+            for (var k = 0; k < degree; k++) {
+               edgeTargets.Add(r.Next(numNodes));
+               edgeCosts.Add(1 + (float)r.NextDouble() * 99);
+            }
+            offsets[i + 1] = edgeTargets.Count;
+         }
+         return (offsets, edgeTargets.ToArray(), edgeCosts.ToArray());
+      }
+   }
+}
@@ -0,0 +1,155 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Linq;
+using Dargon.PlayOn;
+using Dargon.PlayOn.Geometry;
+using Xunit;
+
+namespace Dargon.Terragami.Tests {
+   public class ConstrainedDelaunayTests {
+      private static readonly IntVector2[] Land = Contour(0, 0, 100, 0, 100, 100, 0, 100);
+
+      [Fact]
+      public void HoleSharingAnEdgeWithItsLandIsPunched() {
+         AssertTriangulatesArea(10000 - 40 * 30, Land, Contour(0, 30, 40, 30, 40, 60, 0, 60));
+         AssertTriangulatesArea(10000 - 40 * 30, Land, Contour(0, 60, 40, 60, 40, 30, 0, 30));
+      }
+
+      [Fact]
+      public void PointOnAContourEdgeSplitsIt() {
+         // A hole corner on the land's edge, and a hole corner on another hole's edge.
+         AssertTriangulatesArea(10000 - 60 * 40 / 2, Land, Contour(0, 50, 40, 20, 40, 80));
+         AssertTriangulatesArea(10000 - 20 * 20 - 40 * 30 / 2, Land, Contour(20, 20, 40, 20, 40, 40, 20, 40), Contour(40, 30, 70, 10, 70, 50));
+      }
+
+      [Fact]
+      public void CoincidentPointsAreMerged() {
+         // Diamond holes touching at a corner, and a land contour that repeats a point and is closed.
+         AssertTriangulatesArea(10000 - 2 * 800, Land, Contour(10, 50, 30, 30, 50, 50, 30, 70), Contour(50, 50, 70, 30, 90, 50, 70, 70));
+         AssertTriangulatesArea(10000 - 20 * 20, Contour(0, 0, 100, 0, 100, 0, 100, 100, 0, 100, 0, 0), Contour(20, 20, 40, 20, 40, 40, 20, 40));
+      }
+
+      [Fact]
+      public void CrossingContoursThrow() {
+         Assert.Throws<InvalidOperationException>(() => Triangulate(Land, Contour(-20, 40, 40, 40, 40, 60, -20, 60)));
+         Assert.Throws<InvalidOperationException>(() => Triangulate(Land, Contour(10, 10, 50, 10, 50, 50, 10, 50), Contour(30, 30, 70, 30, 70, 70, 30, 70)));
+      }
+
+      // Poly2Tri's sweep and the native triangulator both build the constrained Delaunay
+      // triangulation, which is unique when no four points are cocircular. Jitter on coordinates
+      // this large makes that vanishingly unlikely, so the triangle sets must match exactly.
+      [Fact]
+      public void TriangulateRootNativeMatchesTriangulateRoot() {
+         for (var seed = 0; seed < 20; seed++) {
+            var punchedLand = CreateJitteredPunchedLand(new Random(seed));
+            var expected = new Triangulator().TriangulateRoot(punchedLand);
+            var actual = new Triangulator().TriangulateRootNative(punchedLand);
+
+            Assert.Equal(expected.Islands.Count, actual.Islands.Count);
+            for (var i = 0; i < expected.Islands.Count; i++) {
+               var expectedTriangles = TriangleSet(expected.Islands[i]);
+               var actualTriangles = TriangleSet(actual.Islands[i]);
+               Assert.Equal(expectedTriangles.Count, actualTriangles.Count);
+               Assert.True(expectedTriangles.SetEquals(actualTriangles));
+               Assert.Equal(Area(expected.Islands[i]), Area(actual.Islands[i]));
+            }
+         }
+      }
+
+      private static IntVector2[] Contour(params int[] xy) {
+         var res = new IntVector2[xy.Length / 2];
+         for (var i = 0; i < res.Length; i++) {
+            res[i] = new IntVector2(xy[2 * i], xy[2 * i + 1]);
+         }
+         return res;
+      }
+
+      // Land is the first contour, holes the rest.
+      private static Triangulation Triangulate(IntVector2[] land, params IntVector2[][] holes) {
+         var points = land.Concat(holes.SelectMany(h => h)).ToArray();
+         var contourOffsets = new List<int> { 0, land.Length };
+         var contourParents = new List<int> { -1 };
+         foreach (var hole in holes) {
+            contourOffsets.Add(contourOffsets[^1] + hole.Length);
+            contourParents.Add(0);
+         }
+
+         var (contourTriangleOffsets, triangleVertices, triangleNeighbors, neighborSharedEdges) =
+            NativeUtils.TriangulatePolygonTree(points, contourOffsets.ToArray(), contourParents.ToArray());
+         return new Triangulator().CreateTriangulation(points, contourTriangleOffsets, triangleVertices, triangleNeighbors, neighborSharedEdges);
+      }
+
+      private static void AssertTriangulatesArea(double expectedArea, IntVector2[] land, params IntVector2[][] holes) {
+         var triangulation = Triangulate(land, holes);
+         Assert.Single(triangulation.Islands);
+         foreach (var t in triangulation.Islands[0].Triangles) {
+            Assert.True(SignedArea(t) > 0, $"{t} is degenerate or clockwise");
+         }
+         Assert.Equal(expectedArea, Area(triangulation.Islands[0]));
+      }
+
+      private static double SignedArea(Triangle3 t) {
+         var ab = t.Points[1] - t.Points[0];
+         var ac = t.Points[2] - t.Points[0];
+         return (ab.X * ac.Y - ab.Y * ac.X) / 2;
+      }
+
+      private static double Area(TriangulationIsland island) => island.Triangles.Sum(t => Math.Abs(SignedArea(t)));
+
+      // Triangles as their corners in sorted order, so winding and starting corner don't matter.
+      private static HashSet<(DoubleVector2, DoubleVector2, DoubleVector2)> TriangleSet(TriangulationIsland island) {
+         var res = new HashSet<(DoubleVector2, DoubleVector2, DoubleVector2)>();
+         foreach (var t in island.Triangles) {
+            var corners = new[] { t.Points[0], t.Points[1], t.Points[2] };
+            Array.Sort(corners, (a, b) => a.X != b.X ? a.X.CompareTo(b.X) : a.Y.CompareTo(b.Y));
+            res.Add((corners[0], corners[1], corners[2]));
+         }
+         return res;
+      }
+
+      // Two jittered squares of land, the larger punched by a jittered grid of quad holes, through
+      // the same Clipper punch the sector compiler uses.
+      private static PolygonNode CreateJitteredPunchedLand(Random r) {
+         const int kExtent = 100000;
+         const int kGridWidth = 4;
+         const int kCellSize = 2 * kExtent / kGridWidth;
+
+         int Jitter(int v, int amount) => v + r.Next(-amount, amount + 1);
+
+         // Corners in Polygon2.CreateRect's winding, with extra jittered points along each side.
+         var land = new List<IntVector2>();
+         const int kPointsPerSide = 8;
+         for (var side = 0; side < 4; side++) {
+            for (var i = 0; i < kPointsPerSide; i++) {
+               var t = -kExtent + 2 * kExtent * i / kPointsPerSide;
+               var (x, y) = side == 0 ? (-kExtent, t) : side == 1 ? (t, kExtent) : side == 2 ? (kExtent, -t) : (-t, -kExtent);
+               land.Add(new IntVector2(Jitter(x, 3000), Jitter(y, 3000)));
+            }
+         }
+
+         var islandX = 2 * kExtent;
+         var island = new List<IntVector2> {
+            new IntVector2(Jitter(islandX, 3000), Jitter(-kExtent / 2, 3000)),
+            new IntVector2(Jitter(islandX, 3000), Jitter(kExtent / 2, 3000)),
+            new IntVector2(Jitter(islandX + kExtent, 3000), Jitter(kExtent / 2, 3000)),
+            new IntVector2(Jitter(islandX + kExtent, 3000), Jitter(-kExtent / 2, 3000)),
+         };
+
+         var punch = PolygonOperations.Punch().Include(land).Include(island);
+         for (var gy = 0; gy < kGridWidth; gy++) {
+            for (var gx = 0; gx < kGridWidth; gx++) {
+               var cx = -kExtent + kCellSize * gx + kCellSize / 2;
+               var cy = -kExtent + kCellSize * gy + kCellSize / 2;
+               var radius = kCellSize / 4;
+               punch.Exclude(new List<IntVector2> {
+                  new IntVector2(Jitter(cx - radius, 2000), Jitter(cy - radius, 2000)),
+                  new IntVector2(Jitter(cx - radius, 2000), Jitter(cy + radius, 2000)),
+                  new IntVector2(Jitter(cx + radius, 2000), Jitter(cy + radius, 2000)),
+                  new IntVector2(Jitter(cx + radius, 2000), Jitter(cy - radius, 2000)),
+               });
+            }
+         }
+         return punch.Execute(0, cleanupDegeneraciesWithOffset: false);
+      }
+   }
+}
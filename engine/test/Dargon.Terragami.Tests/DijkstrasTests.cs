@@ -0,0 +1,104 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Linq;
+using Xunit;
+
+namespace Dargon.Terragami.Tests {
+   public class DijkstrasTests {
+      // Every node as a source must reproduce the all-pairs costs, with predecessors walking back
+      // to the source.
+      [Fact]
+      public void DijkstrasBatchMatchesAllPairsShortestPaths() {
+         for (var seed = 0; seed < 20; seed++) {
+            var r = new Random(seed);
+            var numNodes = 1 + r.Next(150);
+            var (offsets, edgeTargets, edgeCosts) = CreateUndirectedGraph(r, numNodes);
+
+            var (expected, _) = NativeUtils.ComputeAllPairsShortestPaths(offsets, edgeTargets, edgeCosts);
+            var (costs, predecessors) = NativeUtils.DijkstrasBatch(offsets, edgeTargets, edgeCosts, Enumerable.Range(0, numNodes).ToArray());
+            for (var s = 0; s < numNodes; s++) {
+               for (var v = 0; v < numNodes; v++) {
+                  AssertCostEqual(expected[s * numNodes + v], costs[s * numNodes + v]);
+                  if (float.IsPositiveInfinity(costs[s * numNodes + v])) continue;
+
+                  var current = v;
+                  for (var steps = 0; current != s && steps < numNodes; steps++) {
+                     current = predecessors[s * numNodes + current];
+                  }
+                  Assert.Equal(s, current);
+               }
+            }
+         }
+      }
+
+      // Seeds with a starting cost behave as sources reached at that cost: each node's cost is the
+      // best seed cost plus its distance from that seed.
+      [Fact]
+      public void DijkstrasFromSeedsMatchesAllPairsShortestPaths() {
+         for (var seed = 0; seed < 20; seed++) {
+            var r = new Random(seed);
+            var numNodes = 1 + r.Next(150);
+            var (offsets, edgeTargets, edgeCosts) = CreateUndirectedGraph(r, numNodes);
+            var (allPairs, _) = NativeUtils.ComputeAllPairsShortestPaths(offsets, edgeTargets, edgeCosts);
+
+            var seeds = new dijkstra_seed[1 + r.Next(4)];
+            for (var i = 0; i < seeds.Length; i++) {
+               var source = r.Next(numNodes);
+               seeds[i] = new dijkstra_seed(source, source, (float)r.NextDouble() * 50);
+            }
+
+            var (costs, _) = NativeUtils.Dijkstras(offsets, edgeTargets, edgeCosts, seeds);
+            for (var v = 0; v < numNodes; v++) {
+               var expected = seeds.Min(s => s.totalCost + allPairs[s.current * numNodes + v]);
+               AssertCostEqual(expected, costs[v]);
+            }
+         }
+      }
+
+      // -1 is the unsettled predecessor and the heap only orders costs >= 0, so such seeds are
+      // rejected rather than silently mis-searched.
+      [Fact]
+      public void DijkstrasRejectsInvalidSeeds() {
+         var offsets = new[] { 0, 1, 2 };
+         var edgeTargets = new[] { 1, 0 };
+         var edgeCosts = new[] { 1f, 1f };
+         var invalidSeeds = new[] {
+            new dijkstra_seed(-1, 0, 0),
+            new dijkstra_seed(0, 0, -1),
+            new dijkstra_seed(0, 2, 0),
+         };
+         foreach (var invalidSeed in invalidSeeds) {
+            Assert.Throws<InvalidOperationException>(() => NativeUtils.Dijkstras(offsets, edgeTargets, edgeCosts, new[] { invalidSeed }));
+         }
+         Assert.Throws<InvalidOperationException>(() => NativeUtils.DijkstrasBatch(offsets, edgeTargets, edgeCosts, new[] { 2 }));
+      }
+
+      // Dijkstras follows edges as listed while the all-pairs pass treats them as undirected, so list
+      // every random edge in both directions.
+      private static (int[] offsets, int[] edgeTargets, float[] edgeCosts) CreateUndirectedGraph(Random r, int numNodes) {
+         var (offsets, edgeTargets, edgeCosts) = AllPairsShortestPathsTests.CreateRandomGraph(r, numNodes);
+         var neighbors = Enumerable.Range(0, numNodes).Select(_ => new List<(int target, float cost)>()).ToArray();
+         for (var i = 0; i < numNodes; i++) {
+            for (var e = offsets[i]; e < offsets[i + 1]; e++) {
+               neighbors[i].Add((edgeTargets[e], edgeCosts[e]));
+               neighbors[edgeTargets[e]].Add((i, edgeCosts[e]));
+            }
+         }
+
+         var undirectedOffsets = new int[numNodes + 1];
+         for (var i = 0; i < numNodes; i++) {
+            undirectedOffsets[i + 1] = undirectedOffsets[i] + neighbors[i].Count;
+         }
+         var all = neighbors.SelectMany(n => n).ToArray();
+         return (undirectedOffsets, all.Select(n => n.target).ToArray(), all.Select(n => n.cost).ToArray());
+      }
+
+      private static void AssertCostEqual(float expected, float actual) {
+         if (float.IsPositiveInfinity(expected)) {
+            Assert.True(float.IsPositiveInfinity(actual));
+         } else {
+            Assert.True(Math.Abs(actual - expected) <= 1E-3f * Math.Max(1, expected));
+         }
+      }
+   }
+}
@@ -0,0 +1,116 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Linq;
+using Xunit;
+
+namespace Dargon.Terragami.Tests {
+   public class FlockingTests {
+      private const int NeighborDistance = 60;
+
+      // The fused kernel must match FlockingSimulator's separate passes run over the same pairs,
+      // except that each pair weighs both entities equally instead of the managed 1 / 0.9 split.
+      // Small spans make coincident entities common; some lists also include the entity itself.
+      [Fact]
+      public void ComputeFlockingForcesMatchesManagedPasses() {
+         for (var seed = 0; seed < 200; seed++) {
+            var r = new Random(seed);
+            var numEntities = 1 + r.Next(200);
+            var span = seed % 2 == 0 ? 400 : 40;
+            var xs = Enumerable.Range(0, numEntities).Select(_ => r.Next(span)).ToArray();
+            var ys = Enumerable.Range(0, numEntities).Select(_ => r.Next(span)).ToArray();
+            float[] RandomFloats(float min, float max) => Enumerable.Range(0, numEntities).Select(_ => min + (max - min) * (float)r.NextDouble()).ToArray();
+            var radii = RandomFloats(2, 20);
+            var seekXs = RandomFloats(-1, 1);
+            var seekYs = RandomFloats(-1, 1);
+            var directSeekXs = RandomFloats(-1, 1);
+            var directSeekYs = RandomFloats(-1, 1);
+            var onGoalTriangle = Enumerable.Range(0, numEntities).Select(_ => r.Next(4) == 0).ToArray();
+            var seekAlignWeights = RandomFloats(0.1f, 1);
+
+            var pairs = new List<(int a, int b)>();
+            for (var a = 0; a < numEntities; a++) {
+               for (var b = a + 1; b < numEntities; b++) {
+                  long dx = xs[b] - xs[a], dy = ys[b] - ys[a];
+                  if (dx * dx + dy * dy < NeighborDistance * NeighborDistance) pairs.Add((a, b));
+               }
+            }
+            var neighborLists = Enumerable.Range(0, numEntities).Select(i => new List<int>(seed % 3 == 0 ? new[] { i } : new int[0])).ToArray();
+            foreach (var (a, b) in pairs) {
+               neighborLists[a].Add(b);
+               neighborLists[b].Add(a);
+            }
+            var neighborOffsets = new int[numEntities + 1];
+            for (var i = 0; i < numEntities; i++) {
+               neighborOffsets[i + 1] = neighborOffsets[i] + neighborLists[i].Count;
+            }
+            var neighbors = neighborLists.SelectMany(l => l.OrderBy(j => j)).ToArray();
+
+            var (forceXs, forceYs) = NativeUtils.ComputeFlockingForces(xs, ys, radii, seekXs, seekYs, directSeekXs, directSeekYs, onGoalTriangle, seekAlignWeights, neighborOffsets, neighbors);
+
+            // CalculateMergedSeekContributions.
+            var steeringXs = new double[numEntities];
+            var steeringYs = new double[numEntities];
+            for (var i = 0; i < numEntities; i++) {
+               steeringXs[i] = onGoalTriangle[i] ? directSeekXs[i] : seekXs[i] * 0.6 + directSeekXs[i] * 0.4;
+               steeringYs[i] = onGoalTriangle[i] ? directSeekYs[i] : seekYs[i] * 0.6 + directSeekYs[i] * 0.4;
+            }
+
+            // CalculateCohesionSeparationContributions and CalculateAlignmentContributions, pair by pair.
+            var separationXs = new double[numEntities];
+            var separationYs = new double[numEntities];
+            var alignmentXs = new double[numEntities];
+            var alignmentYs = new double[numEntities];
+            foreach (var (a, b) in pairs) {
+               alignmentXs[a] += steeringXs[b];
+               alignmentYs[a] += steeringYs[b];
+               alignmentXs[b] += steeringXs[a];
+               alignmentYs[b] += steeringYs[a];
+
+               // Managed visits a cell's entities from the highest index, so b plays TryContribution's a.
+               if (TrySeparate(xs[a] - xs[b], ys[a] - ys[b], (int)(radii[a] + radii[b]), out var vx, out var vy)) {
+                  separationXs[b] += vx;
+                  separationYs[b] += vy;
+                  separationXs[a] -= vx;
+                  separationYs[a] -= vy;
+               }
+            }
+
+            // AggregateForceContributions.
+            for (var i = 0; i < numEntities; i++) {
+               var (ccsX, ccsY) = ToUnit(separationXs[i], separationYs[i]);
+               var (aliX, aliY) = ToUnit(alignmentXs[i], alignmentYs[i]);
+               var seekX = onGoalTriangle[i] ? directSeekXs[i] : seekXs[i] * 0.8 + directSeekXs[i] * 0.2;
+               var seekY = onGoalTriangle[i] ? directSeekYs[i] : seekYs[i] * 0.8 + directSeekYs[i] * 0.2;
+               var wali = Math.Max(0, seekX * aliX + seekY * aliY);
+               var (expectedX, expectedY) = ToUnit(
+                  (seekX * (1 - wali) + aliX * wali) * seekAlignWeights[i] + ccsX,
+                  (seekY * (1 - wali) + aliY * wali) * seekAlignWeights[i] + ccsY);
+               Assert.True(Math.Abs(expectedX - forceXs[i]) < 1E-3 && Math.Abs(expectedY - forceYs[i]) < 1E-3);
+            }
+         }
+      }
+
+      // TryContribution's overlapping branch for aToB = (dx, dy), as the force on a.
+      private static bool TrySeparate(int dx, int dy, int radiusSum, out double vx, out double vy) {
+         var centerDistanceSquared = dx * dx + dy * dy;
+         if (centerDistanceSquared >= radiusSum * radiusSum) {
+            vx = vy = 0;
+            return false;
+         }
+
+         const double k = 700;
+         var centerDistance = (int)Math.Sqrt(centerDistanceSquared);
+         var w = k * k * (0.8 + 0.2 * (1 - Math.Pow((centerDistance * 256L / radiusSum) / 256.0, 0.3)));
+         var (forceX, forceY) = centerDistanceSquared == 0 ? (2, 1) : (-dx, -dy);
+         var forceMagnitude = (int)Math.Sqrt(forceX * forceX + forceY * forceY);
+         vx = w * forceX / forceMagnitude;
+         vy = w * forceY / forceMagnitude;
+         return true;
+      }
+
+      private static (double x, double y) ToUnit(double x, double y) {
+         var norm = Math.Sqrt(x * x + y * y);
+         return norm == 0 ? (0, 0) : (x / norm, y / norm);
+      }
+   }
+}
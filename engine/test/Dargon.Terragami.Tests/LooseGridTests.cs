@@ -0,0 +1,70 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Linq;
+using Dargon.PlayOn.DataStructures;
+using Xunit;
+
+namespace Dargon.Terragami.Tests {
+   public class LooseGridTests {
+      // Each query must return exactly the live rects it intersects, as QuadTree.Query would, after
+      // every round of nudges within a cell, jumps across levels and bounds, removals and re-inserts.
+      // The id buffer starts too small and is reused, so the resize retry runs too.
+      [Fact]
+      public void QueryLooseGridMatchesBruteForce() {
+         for (var seed = 0; seed < 50; seed++) {
+            var r = new Random(seed);
+            var bounds = new IntRect2(r.Next(-500, 500), r.Next(-500, 500), 0, 0);
+            bounds.Right = bounds.Left + r.Next(1000);
+            bounds.Bottom = bounds.Top + r.Next(1000);
+            var minCellSize = 1 + r.Next(64);
+
+            // Mostly small rects inside bounds; some as large as bounds, some anchored outside them.
+            IntRect2 RandomRect() {
+               var x = r.Next(bounds.Left - 100, bounds.Right + 100);
+               var y = r.Next(bounds.Top - 100, bounds.Bottom + 100);
+               var size = r.Next(4) == 0 ? r.Next(1500) : r.Next(2 * minCellSize);
+               return new IntRect2(x, y, x + r.Next(size + 1), y + r.Next(size + 1));
+            }
+
+            var live = new Dictionary<int, IntRect2>();
+            var offsets = new int[257];
+            var ids = new int[1];
+            var grid = NativeUtils.LoadLooseGrid(bounds, minCellSize);
+            try {
+               for (var round = 0; round < 10; round++) {
+                  var updateIds = new List<int>();
+                  var updateRects = new List<IntRect2>();
+                  foreach (var id in Enumerable.Range(0, 400).Where(_ => r.Next(3) == 0)) {
+                     var rect = RandomRect();
+                     if (live.TryGetValue(id, out var previous) && r.Next(2) == 0) {
+                        var dx = r.Next(-3, 4);
+                        var dy = r.Next(-3, 4);
+                        rect = new IntRect2(previous.Left + dx, previous.Top + dy, previous.Right + dx, previous.Bottom + dy);
+                     }
+                     updateIds.Add(id);
+                     updateRects.Add(rect);
+                     live[id] = rect;
+                  }
+                  NativeUtils.UpdateLooseGrid(grid, updateIds.ToArray(), updateRects.ToArray(), updateIds.Count);
+
+                  // Includes ids that were never inserted or are already gone.
+                  var removedIds = Enumerable.Range(0, 450).Where(_ => r.Next(8) == 0).ToArray();
+                  NativeUtils.RemoveLooseGridItems(grid, removedIds, removedIds.Length);
+                  foreach (var id in removedIds) live.Remove(id);
+
+                  var numQueries = r.Next(offsets.Length);
+                  var queries = Enumerable.Range(0, numQueries).Select(_ => RandomRect()).ToArray();
+                  var numIds = NativeUtils.QueryLooseGrid(grid, queries, numQueries, offsets, ref ids);
+                  Assert.Equal(offsets[numQueries], numIds);
+                  for (var i = 0; i < numQueries; i++) {
+                     var expected = live.Where(kvp => kvp.Value.IntersectsWith(queries[i])).Select(kvp => kvp.Key).OrderBy(id => id).ToArray();
+                     Assert.Equal(expected, ids[offsets[i]..offsets[i + 1]].OrderBy(id => id).ToArray());
+                  }
+               }
+            } finally {
+               NativeUtils.FreeLooseGrid(grid);
+            }
+         }
+      }
+   }
+}
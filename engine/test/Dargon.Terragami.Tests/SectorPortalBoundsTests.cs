@@ -0,0 +1,211 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Linq;
+using Dargon.PlayOn.Geometry;
+using Dargon.Terragami.Sectors;
+using Xunit;
+
+namespace Dargon.Terragami.Tests {
+   public class SectorPortalBoundsTests {
+      // Each pair of portals must be bounded by the min and max over their crossover points of the
+      // full shortest path between them, searched over the points and every waypoint with
+      // barrier-checked links.
+      [Fact]
+      public void ComputeSectorPortalDistanceBoundsMatchesFullSearch() {
+         for (var seed = 0; seed < 30; seed++) {
+            var r = new Random(seed);
+            IntVector2 RandomPoint() => new IntVector2(r.Next(300), r.Next(300));
+
+            var portalPoints = Enumerable.Range(0, 2 + r.Next(5)).Select(_ => Enumerable.Range(0, 1 + r.Next(8)).Select(_ => RandomPoint()).ToArray()).ToArray();
+            var waypoints = Enumerable.Range(0, r.Next(20)).Select(_ => RandomPoint()).ToArray();
+            var barriers = new List<IntLineSegment2>();
+            while (barriers.Count < r.Next(15)) {
+               var a = RandomPoint();
+               var b = RandomPoint();
+               if (a != b) barriers.Add(new IntLineSegment2(a, b));
+            }
+
+            bool Visible(IntVector2 a, IntVector2 b) {
+               if (a == b) return true;
+               var link = new IntLineSegment2(a, b);
+               return !barriers.Any(barrier => link.Intersects(barrier));
+            }
+
+            double Distance(IntVector2 a, IntVector2 b) => Math.Sqrt((double)(b.X - a.X) * (b.X - a.X) + (double)(b.Y - a.Y) * (b.Y - a.Y));
+
+            var numWaypoints = waypoints.Length;
+            var waypointCosts = new float[numWaypoints * numWaypoints];
+            for (var u = 0; u < numWaypoints; u++) {
+               for (var v = 0; v < numWaypoints; v++) {
+                  waypointCosts[u * numWaypoints + v] = u == v ? 0 : Visible(waypoints[u], waypoints[v]) ? (float)Distance(waypoints[u], waypoints[v]) : float.PositiveInfinity;
+               }
+            }
+            for (var k = 0; k < numWaypoints; k++) {
+               for (var u = 0; u < numWaypoints; u++) {
+                  for (var v = 0; v < numWaypoints; v++) {
+                     waypointCosts[u * numWaypoints + v] = Math.Min(waypointCosts[u * numWaypoints + v], waypointCosts[u * numWaypoints + k] + waypointCosts[k * numWaypoints + v]);
+                  }
+               }
+            }
+
+            var numPortals = portalPoints.Length;
+            var portalPointCounts = PortalLinkStates.GetPortalPointCounts(portalPoints);
+            var pairWordOffsets = PortalLinkStates.ComputePairWordOffsets(portalPointCounts);
+            var visibleBits = new ulong[pairWordOffsets[pairWordOffsets.Length - 1]];
+            for (int a = 0, pair = 0; a < numPortals; a++) {
+               for (var b = a + 1; b < numPortals; b++, pair++) {
+                  for (var i = 0; i < portalPointCounts[a]; i++) {
+                     for (var j = 0; j < portalPointCounts[b]; j++) {
+                        var link = i * portalPointCounts[b] + j;
+                        if (Visible(portalPoints[a][i], portalPoints[b][j])) visibleBits[pairWordOffsets[pair] + link / 64] |= 1UL << (link % 64);
+                     }
+                  }
+               }
+            }
+
+            var bounds = NativeUtils.ComputeSectorPortalDistanceBounds(portalPoints, new PortalLinkStates(portalPointCounts, visibleBits), waypoints, waypointCosts, barriers.ToArray());
+            for (var a = 0; a < numPortals; a++) {
+               for (var b = 0; b < numPortals; b++) {
+                  var expectedLower = a == b ? 0 : double.PositiveInfinity;
+                  var expectedUpper = 0.0;
+                  if (a != b) {
+                     foreach (var p in portalPoints[a]) {
+                        foreach (var q in portalPoints[b]) {
+                           var nodes = new[] { p, q }.Concat(waypoints).ToArray();
+                           var costs = ShortestPaths(nodes.Length, 0, (u, v) => Visible(nodes[u], nodes[v]) ? Distance(nodes[u], nodes[v]) : double.PositiveInfinity);
+                           expectedLower = Math.Min(expectedLower, costs[1]);
+                           expectedUpper = Math.Max(expectedUpper, costs[1]);
+                        }
+                     }
+                  }
+
+                  AssertClose(expectedLower, bounds[a * numPortals + b].lower);
+                  AssertClose(expectedUpper, bounds[a * numPortals + b].upper);
+               }
+            }
+         }
+      }
+
+      // Searching only the corridor's sectors must find the same optimal cost as searching every
+      // sector, point to point, and upperBound must be a real path's cost no better than the optimum.
+      // Sectors join random portals with arbitrary point-to-point costs, bounded the way
+      // ComputeSectorPortalDistanceBounds bounds them.
+      [Fact]
+      public void FindSectorCorridorKeepsOptimalPath() {
+         for (var seed = 0; seed < 200; seed++) {
+            var r = new Random(seed);
+            var numPortals = 2 + r.Next(30);
+            var numSectors = 1 + r.Next(20);
+            var pointPositions = Enumerable.Range(0, numPortals).Select(_ => Enumerable.Range(0, 1 + r.Next(4)).Select(_ => (x: r.NextDouble() * 100, y: r.NextDouble() * 100)).ToArray()).ToArray();
+            double Noisy((double x, double y) a, (double x, double y) b) => Math.Sqrt((b.x - a.x) * (b.x - a.x) + (b.y - a.y) * (b.y - a.y)) * (1 + r.NextDouble());
+
+            // Point-level costs: sectorCosts[s][(a, i, b, j)] between portal a's i-th and portal b's j-th points.
+            var sectorPortalOffsets = new int[numSectors + 1];
+            var sectorPortals = new List<int>();
+            var sectorCosts = new List<Dictionary<(int, int, int, int), float>>();
+            var sectorBounds = new List<distance_bounds>();
+            for (var s = 0; s < numSectors; s++) {
+               var portals = Enumerable.Range(0, numPortals).OrderBy(_ => r.Next()).Take(Math.Min(numPortals, 2 + r.Next(4))).ToArray();
+               var costs = new Dictionary<(int, int, int, int), float>();
+               foreach (var a in portals) {
+                  foreach (var b in portals) {
+                     if (a == b) {
+                        sectorBounds.Add(new distance_bounds());
+                        continue;
+                     }
+
+                     var res = new distance_bounds { lower = float.PositiveInfinity };
+                     for (var i = 0; i < pointPositions[a].Length; i++) {
+                        for (var j = 0; j < pointPositions[b].Length; j++) {
+                           if (!costs.TryGetValue((b, j, a, i), out var cost)) cost = (float)Noisy(pointPositions[a][i], pointPositions[b][j]);
+                           costs[(a, i, b, j)] = cost;
+                           res.lower = Math.Min(res.lower, cost);
+                           res.upper = Math.Max(res.upper, cost);
+                        }
+                     }
+                     sectorBounds.Add(res);
+                  }
+               }
+               sectorPortals.AddRange(portals);
+               sectorPortalOffsets[s + 1] = sectorPortals.Count;
+               sectorCosts.Add(costs);
+            }
+
+            // Source and destination each link to one sector's portals.
+            (int[] portals, float[][] costs, distance_bounds[] links) CreateEndpoint() {
+               var s = r.Next(numSectors);
+               var position = (x: r.NextDouble() * 100, y: r.NextDouble() * 100);
+               var portals = sectorPortals.Skip(sectorPortalOffsets[s]).Take(sectorPortalOffsets[s + 1] - sectorPortalOffsets[s]).ToArray();
+               var costs = portals.Select(p => pointPositions[p].Select(q => (float)Noisy(position, q)).ToArray()).ToArray();
+               var links = costs.Select(c => new distance_bounds { lower = c.Min(), upper = c.Max() }).ToArray();
+               return (portals, costs, links);
+            }
+            var source = CreateEndpoint();
+            var destination = CreateEndpoint();
+
+            var (_, sectorInCorridor, upperBound) = NativeUtils.FindSectorCorridor(
+               numPortals, sectorPortalOffsets, sectorPortals.ToArray(), sectorBounds.ToArray(),
+               source.portals, source.links, destination.portals, destination.links);
+
+            // Full search over crossover points: node 0 is the source, 1 the destination.
+            var pointOffsets = new int[numPortals + 1];
+            for (var p = 0; p < numPortals; p++) pointOffsets[p + 1] = pointOffsets[p] + pointPositions[p].Length;
+            double Search(Func<int, bool> includeSector) {
+               var numNodes = 2 + pointOffsets[numPortals];
+               var edges = new double[numNodes, numNodes];
+               for (var u = 0; u < numNodes; u++) {
+                  for (var v = 0; v < numNodes; v++) edges[u, v] = double.PositiveInfinity;
+               }
+               for (var k = 0; k < source.portals.Length; k++) {
+                  for (var i = 0; i < source.costs[k].Length; i++) edges[0, 2 + pointOffsets[source.portals[k]] + i] = source.costs[k][i];
+               }
+               for (var k = 0; k < destination.portals.Length; k++) {
+                  for (var i = 0; i < destination.costs[k].Length; i++) edges[2 + pointOffsets[destination.portals[k]] + i, 1] = destination.costs[k][i];
+               }
+               for (var s = 0; s < numSectors; s++) {
+                  if (!includeSector(s)) continue;
+                  foreach (var ((a, i, b, j), cost) in sectorCosts[s]) {
+                     ref var edge = ref edges[2 + pointOffsets[a] + i, 2 + pointOffsets[b] + j];
+                     edge = Math.Min(edge, cost);
+                  }
+               }
+               return ShortestPaths(numNodes, 0, (u, v) => edges[u, v])[1];
+            }
+
+            var optimal = Search(s => true);
+            Assert.Equal(double.IsInfinity(optimal), float.IsInfinity(upperBound));
+            if (double.IsInfinity(optimal)) continue;
+
+            Assert.True(optimal <= upperBound * (1 + 1E-5));
+            AssertClose(optimal, Search(s => sectorInCorridor[s]));
+         }
+      }
+
+      // Dijkstra from source over a dense graph given by its edge costs (+inf where there's no edge).
+      private static double[] ShortestPaths(int numNodes, int source, Func<int, int, double> edgeCost) {
+         var costs = Enumerable.Repeat(double.PositiveInfinity, numNodes).ToArray();
+         var settled = new bool[numNodes];
+         costs[source] = 0;
+         while (true) {
+            var u = -1;
+            for (var v = 0; v < numNodes; v++) {
+               if (!settled[v] && !double.IsInfinity(costs[v]) && (u == -1 || costs[v] < costs[u])) u = v;
+            }
+            if (u == -1) return costs;
+
+            settled[u] = true;
+            for (var v = 0; v < numNodes; v++) {
+               if (!settled[v]) costs[v] = Math.Min(costs[v], costs[u] + edgeCost(u, v));
+            }
+         }
+      }
+
+      private static void AssertClose(double expected, double actual) {
+         if (double.IsInfinity(expected)) {
+            Assert.True(double.IsPositiveInfinity(actual));
+         } else {
+            Assert.True(Math.Abs(expected - actual) <= 1E-4 * Math.Max(1, expected));
+         }
+      }
+   }
+}
@@ -0,0 +1,85 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Linq;
+using Dargon.PlayOn.Geometry;
+using Xunit;
+
+namespace Dargon.Terragami.Tests {
+   public class SpatialHashTests {
+      // Each entity's neighbors must be exactly what EntityGridView enumerates for it, in cell order
+      // then by entity index, across every shape and across re-updates of the same hash.
+      [Fact]
+      public void QuerySpatialHashNeighborsMatchesEntityGrid() {
+         var shapes = new[] { NeighborhoodShape.Circle, NeighborhoodShape.QuarterCircleBR, NeighborhoodShape.QuarterCircleBRExcludeCenter };
+         for (var seed = 0; seed < 50; seed++) {
+            var r = new Random(seed);
+            int originX = r.Next(-500, 500), originY = r.Next(-500, 500);
+            int width = 1 + r.Next(20), height = 1 + r.Next(20), cellSize = 1 + r.Next(30);
+            var hash = NativeUtils.LoadSpatialHash(originX, originY, width, height, cellSize);
+            try {
+               for (var update = 0; update < 3; update++) {
+                  var numEntities = r.Next(300);
+                  var positions = Enumerable.Range(0, numEntities).Select(_ => new IntVector2(originX + r.Next(width * cellSize), originY + r.Next(height * cellSize))).ToArray();
+                  var radii = Enumerable.Range(0, numEntities).Select(_ => r.Next(3 * cellSize)).ToArray();
+                  NativeUtils.UpdateSpatialHash(hash, positions, radii);
+
+                  var cells = new List<int>[height, width];
+                  for (var y = 0; y < height; y++) {
+                     for (var x = 0; x < width; x++) {
+                        cells[y, x] = new List<int>();
+                     }
+                  }
+                  for (var i = 0; i < numEntities; i++) {
+                     cells[(positions[i].Y - originY) / cellSize, (positions[i].X - originX) / cellSize].Add(i);
+                  }
+
+                  foreach (var shape in shapes) {
+                     var queryRadii = Enumerable.Range(0, numEntities).Select(_ => r.Next(4 * cellSize)).ToArray();
+                     var (offsets, neighbors) = NativeUtils.QuerySpatialHashNeighbors(hash, shape, queryRadii);
+                     Assert.Equal(numEntities + 1, offsets.Length);
+                     for (var i = 0; i < numEntities; i++) {
+                        var cx = (positions[i].X - originX) / cellSize;
+                        var cy = (positions[i].Y - originY) / cellSize;
+                        var expected = EnumerateEntityGrid(cells, cx, cy, ComputeRanges(shape, queryRadii[i], cellSize));
+                        Assert.Equal(expected, neighbors[offsets[i]..offsets[i + 1]]);
+                     }
+                  }
+               }
+            } finally {
+               NativeUtils.FreeSpatialHash(hash);
+            }
+         }
+      }
+
+      // Managed EntityGridRangeCalculator, which Terragami can't reference.
+      private static (int offsetTop, int offsetLeft, int width)[] ComputeRanges(NeighborhoodShape shape, int agentRadius, int cellSize) {
+         const int precision = 100;
+         var r = (agentRadius + cellSize - 1) / cellSize;
+         var ranges = new List<(int, int, int)>();
+         for (var y = shape == NeighborhoodShape.Circle ? -r : 0; y <= r; y++) {
+            var xRange = ((int)Math.Sqrt(precision * precision * (r * r - y * y)) + precision - 1) / precision;
+            if (shape == NeighborhoodShape.Circle) {
+               ranges.Add((y, -xRange, xRange * 2 + 1));
+            } else {
+               var sx = (y == 0 && shape == NeighborhoodShape.QuarterCircleBRExcludeCenter) ? 1 : 0;
+               ranges.Add((y, sx, xRange + 1 - sx));
+            }
+         }
+         return ranges.ToArray();
+      }
+
+      // Managed EntityGrid.Enumerator: the ranges' cells in order, clipped to the grid.
+      private static List<int> EnumerateEntityGrid(List<int>[,] cells, int cx, int cy, (int offsetTop, int offsetLeft, int width)[] ranges) {
+         var res = new List<int>();
+         foreach (var (offsetTop, offsetLeft, width) in ranges) {
+            var y = cy + offsetTop;
+            if (y < 0 || y >= cells.GetLength(0)) continue;
+
+            for (var x = Math.Max(0, cx + offsetLeft); x < Math.Min(cells.GetLength(1), cx + offsetLeft + width); x++) {
+               res.AddRange(cells[y, x]);
+            }
+         }
+         return res;
+      }
+   }
+}
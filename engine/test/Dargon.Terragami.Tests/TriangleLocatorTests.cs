@@ -0,0 +1,90 @@
+﻿using System;
+using System.Collections.Generic;
+using Dargon.PlayOn;
+using Dargon.PlayOn.Geometry;
+using Xunit;
+
+namespace Dargon.Terragami.Tests {
+   public class TriangleLocatorTests {
+      // The native point-location grid must pick the same triangle as TriangulationIsland.TryIntersect's
+      // linear scan, including near-miss points it resolves by barycentric nearness.
+      [Fact]
+      public void LocateTriangleMeshPointsMatchesTryIntersect() {
+         for (var seed = 0; seed < 20; seed++) {
+            var r = new Random(seed);
+            var triangulation = CreateJitteredTriangulation(r);
+            foreach (var island in triangulation.Islands) {
+               var bounds = island.IntBounds;
+               var points = new DoubleVector2[2000];
+               for (var i = 0; i < points.Length; i++) {
+                  // Overshoot the bounds a little so misses outside the island are covered too.
+                  var x = bounds.Left - 10 + r.NextDouble() * (bounds.Right - bounds.Left + 20);
+                  var y = bounds.Top - 10 + r.NextDouble() * (bounds.Bottom - bounds.Top + 20);
+                  points[i] = new DoubleVector2(x, y);
+               }
+
+               // Triangle corners and edge midpoints, where containment and nearness ties happen.
+               for (var i = 0; i < Math.Min(island.Triangles.Length, 200); i++) {
+                  var t = island.Triangles[i];
+                  points[i] = i % 2 == 0 ? t.Points[i % 3] : (t.Points[i % 3] + t.Points[(i + 1) % 3]) / 2;
+               }
+
+               var handle = NativeUtils.LoadTriangleMesh(island);
+               try {
+                  var located = NativeUtils.LocateTriangleMeshPoints(handle, points);
+                  for (var i = 0; i < points.Length; i++) {
+                     island.TryIntersect(points[i].X, points[i].Y, out var expected);
+                     Assert.Equal(expected, located[i]);
+                  }
+               } finally {
+                  NativeUtils.FreeTriangleMesh(handle);
+               }
+            }
+         }
+      }
+
+      // A jittered square of land punched by a jittered grid of square holes.
+      private static Triangulation CreateJitteredTriangulation(Random r) {
+         const int kExtent = 1000;
+         const int kGridWidth = 4;
+         const int kCellSize = 2 * kExtent / kGridWidth;
+
+         int Jitter(int v, int amount) => v + r.Next(-amount, amount + 1);
+
+         var points = new List<IntVector2>();
+         var contourOffsets = new List<int> { 0 };
+         var contourParents = new List<int>();
+
+         // Land perimeter, with extra jittered points along each side.
+         const int kPointsPerSide = 8;
+         for (var side = 0; side < 4; side++) {
+            for (var i = 0; i < kPointsPerSide; i++) {
+               var t = -kExtent + 2 * kExtent * i / kPointsPerSide;
+               var (x, y) = side == 0 ? (t, -kExtent) : side == 1 ? (kExtent, t) : side == 2 ? (-t, kExtent) : (-kExtent, -t);
+               points.Add(new IntVector2(Jitter(x, 40), Jitter(y, 40)));
+            }
+         }
+         contourOffsets.Add(points.Count);
+         contourParents.Add(-1);
+
+         for (var gy = 0; gy < kGridWidth; gy++) {
+            for (var gx = 0; gx < kGridWidth; gx++) {
+               var cx = -kExtent + kCellSize * gx + kCellSize / 2;
+               var cy = -kExtent + kCellSize * gy + kCellSize / 2;
+               var radius = kCellSize / 4;
+               points.Add(new IntVector2(Jitter(cx - radius, 20), Jitter(cy - radius, 20)));
+               points.Add(new IntVector2(Jitter(cx + radius, 20), Jitter(cy - radius, 20)));
+               points.Add(new IntVector2(Jitter(cx + radius, 20), Jitter(cy + radius, 20)));
+               points.Add(new IntVector2(Jitter(cx - radius, 20), Jitter(cy + radius, 20)));
+               contourOffsets.Add(points.Count);
+               contourParents.Add(0);
+            }
+         }
+
+         var pointArray = points.ToArray();
+         var (contourTriangleOffsets, triangleVertices, triangleNeighbors, neighborSharedEdges) =
+            NativeUtils.TriangulatePolygonTree(pointArray, contourOffsets.ToArray(), contourParents.ToArray());
+         return new Triangulator().CreateTriangulation(pointArray, contourTriangleOffsets, triangleVertices, triangleNeighbors, neighborSharedEdges);
+      }
+   }
+}
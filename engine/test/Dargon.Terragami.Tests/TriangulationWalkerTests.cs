@@ -0,0 +1,288 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Linq;
+using Dargon.PlayOn;
+using Dargon.PlayOn.Foundation.Terrain;
+using Dargon.PlayOn.Geometry;
+using Xunit;
+
+namespace Dargon.Terragami.Tests {
+   public class TriangulationWalkerTests {
+      // Every batched walk must end where TriangulationWalker2D's does: same triangle, position,
+      // halt segment and distance. Meshes are jittered grids with missing cells, so walks cross
+      // triangles, slide along boundaries, wrap corners and snag.
+      [Fact]
+      public void WalkTriangleMeshMatchesTriangulationWalker2D() {
+         for (var seed = 0; seed < 50; seed++) {
+            var r = new Random(seed);
+            var island = CreateGridIsland(r, 2 + r.Next(10), 2 + r.Next(10));
+            var triangles = island.Triangles;
+
+            var haltSegments = new List<(DoubleLineSegment2, Clockness)>();
+            for (var i = 0; i < seed % 4; i++) {
+               var a = new DoubleVector2(r.NextDouble() * 100, r.NextDouble() * 100);
+               var b = new DoubleVector2(r.NextDouble() * 100, r.NextDouble() * 100);
+               haltSegments.Add((new DoubleLineSegment2(a, b), r.Next(2) == 0 ? Clockness.ClockWise : Clockness.CounterClockWise));
+            }
+
+            var numWalks = 200;
+            var startTriangles = new int[numWalks];
+            var positions = new DoubleVector2[numWalks];
+            var displacements = new DoubleVector2[numWalks];
+            for (var i = 0; i < numWalks; i++) {
+               startTriangles[i] = r.Next(triangles.Length);
+               var wa = 0.05 + 0.9 * r.NextDouble();
+               var wb = (1 - wa) * (0.05 + 0.9 * r.NextDouble());
+               var points = triangles[startTriangles[i]].Points;
+               positions[i] = points.A * wa + points.B * wb + points.C * (1 - wa - wb);
+               var theta = r.NextDouble() * 2 * Math.PI;
+               displacements[i] = new DoubleVector2(Math.Cos(theta), Math.Sin(theta)) * (r.NextDouble() * 60);
+            }
+
+            var mesh = NativeUtils.LoadTriangleMesh(island);
+            try {
+               var results = NativeUtils.WalkTriangleMesh(
+                  mesh, haltSegments.Select(h => h.Item1).ToArray(), haltSegments.Select(h => h.Item2).ToArray(),
+                  startTriangles, positions, displacements);
+               for (var i = 0; i < numWalks; i++) {
+                  var distance = displacements[i].Norm2D();
+                  var expected = new ReferenceWalker(island, haltSegments).Walk(startTriangles[i], positions[i], displacements[i].ToUnit(), distance);
+                  Assert.Equal(expected.triangleIndex, results[i].triangle);
+                  Assert.Equal(expected.haltSegment, results[i].haltSegment);
+                  Assert.True(Math.Abs(expected.p.X - results[i].position.x) < 1E-6 && Math.Abs(expected.p.Y - results[i].position.y) < 1E-6);
+                  Assert.True(Math.Abs(distance - expected.distanceRemaining - results[i].distanceConsumed) < 1E-6);
+               }
+            } finally {
+               NativeUtils.FreeTriangleMesh(mesh);
+            }
+         }
+      }
+
+      // A width x height grid of 10-unit cells, corners jittered, each cell split into two CCW
+      // triangles; about a fifth of the cells are left out.
+      private static TriangulationIsland CreateGridIsland(Random r, int width, int height) {
+         var corners = new DoubleVector2[height + 1, width + 1];
+         for (var y = 0; y <= height; y++) {
+            for (var x = 0; x <= width; x++) {
+               corners[y, x] = new DoubleVector2(10 * x + 5 * (r.NextDouble() - 0.5), 10 * y + 5 * (r.NextDouble() - 0.5));
+            }
+         }
+
+         var triangles = new List<Triangle3>();
+         void AddTriangle(DoubleVector2 a, DoubleVector2 b, DoubleVector2 c) {
+            triangles.Add(new Triangle3 {
+               Index = triangles.Count,
+               Points = new Array3<DoubleVector2>(a, b, c),
+               Centroid = (a + b + c) / 3,
+               NeighborOppositePointIndices = new Array3<int>(Triangle3.NO_NEIGHBOR_INDEX, Triangle3.NO_NEIGHBOR_INDEX, Triangle3.NO_NEIGHBOR_INDEX),
+               NeighborVertexIndexSharingEdgeOppositePointIndices = new Array3<int>(-1, -1, -1),
+            });
+         }
+         for (var y = 0; y < height; y++) {
+            for (var x = 0; x < width; x++) {
+               if (r.Next(5) == 0) continue;
+               AddTriangle(corners[y, x], corners[y, x + 1], corners[y + 1, x + 1]);
+               AddTriangle(corners[y, x], corners[y + 1, x + 1], corners[y + 1, x]);
+            }
+         }
+         if (triangles.Count == 0) AddTriangle(corners[0, 0], corners[0, 1], corners[1, 1]);
+
+         // Link triangles across shared edges; edge j of a triangle is the one opposite point j.
+         var edges = new Dictionary<(DoubleVector2, DoubleVector2), (int triangle, int edge)>();
+         var res = triangles.ToArray();
+         for (var t = 0; t < res.Length; t++) {
+            for (var j = 0; j < 3; j++) {
+               var p1 = res[t].Points[(j + 1) % 3];
+               var p2 = res[t].Points[(j + 2) % 3];
+               if (edges.TryGetValue((p2, p1), out var other)) {
+                  res[t].NeighborOppositePointIndices[j] = other.triangle;
+                  res[t].NeighborVertexIndexSharingEdgeOppositePointIndices[j] = other.edge;
+                  res[other.triangle].NeighborOppositePointIndices[other.edge] = t;
+                  res[other.triangle].NeighborVertexIndexSharingEdgeOppositePointIndices[other.edge] = j;
+               } else {
+                  edges.Add((p1, p2), (t, j));
+               }
+            }
+         }
+         return new TriangulationIsland { Triangles = res };
+      }
+
+      // Managed TriangulationWalker2D.WalkTriangulation, which Terragami can't reference, minus logging.
+      private class ReferenceWalker {
+         private readonly TriangulationIsland island;
+         private readonly List<(DoubleLineSegment2, Clockness)> haltSegments;
+         private DoubleVector2 p, direction;
+         private int currentTriangleIndex;
+         private double distanceRemaining;
+         private int outEdgeOpposingVertexIndex;
+         private int haltingSegment;
+
+         public ReferenceWalker(TriangulationIsland island, List<(DoubleLineSegment2, Clockness)> haltSegments) {
+            this.island = island;
+            this.haltSegments = haltSegments;
+         }
+
+         public (DoubleVector2 p, int triangleIndex, int haltSegment, double distanceRemaining) Walk(int triangleIndex, DoubleVector2 position, DoubleVector2 dir, double initialDistance) {
+            p = position;
+            direction = dir;
+            currentTriangleIndex = triangleIndex;
+            distanceRemaining = initialDistance;
+            outEdgeOpposingVertexIndex = FindOutEdgeIndex(ref p, direction, in island.Triangles[currentTriangleIndex], -1);
+            haltingSegment = -1;
+            Execute();
+            return (p, currentTriangleIndex, haltingSegment, distanceRemaining);
+         }
+
+         private void Execute() {
+            var nextIterationShouldMovePAlongDirectionToEdge = true;
+            while (true) {
+               ref var currentTriangle = ref island.Triangles[currentTriangleIndex];
+               var e0 = currentTriangle.Points[(outEdgeOpposingVertexIndex + 1) % 3];
+               var e1 = currentTriangle.Points[(outEdgeOpposingVertexIndex + 2) % 3];
+               var e0e1 = new DoubleLineSegment2(e0, e1);
+               var e01 = e0.To(e1);
+
+               var distanceToEdge = 0.0;
+               if (nextIterationShouldMovePAlongDirectionToEdge) {
+                  var line = new DoubleLineSegment2(p, p + direction);
+                  GeometryOperations.TryFindNonoverlappingLineSegmentIntersectionT(in line, in e0e1, out var tForRay);
+                  distanceToEdge = tForRay;
+                  var pAtEdge = p + direction * distanceToEdge;
+
+                  if (distanceToEdge >= distanceRemaining) {
+                     var pCompletion = p + direction * distanceRemaining;
+                     if (HaltCheck(pCompletion, distanceRemaining)) break;
+                     p = pCompletion;
+                     distanceRemaining = 0;
+                     break;
+                  }
+
+                  if (HaltCheck(pAtEdge, distanceToEdge)) break;
+                  p = pAtEdge;
+                  distanceRemaining -= distanceToEdge;
+               }
+
+               var neighborTriangleIndex = currentTriangle.NeighborOppositePointIndices[outEdgeOpposingVertexIndex];
+               if (neighborTriangleIndex != Triangle3.NO_NEIGHBOR_INDEX) {
+                  var sharedEdgeIndexInNeighborTriangle = currentTriangle.NeighborVertexIndexSharingEdgeOppositePointIndices[outEdgeOpposingVertexIndex];
+                  currentTriangleIndex = neighborTriangleIndex;
+                  outEdgeOpposingVertexIndex = FindOutEdgeIndex(ref p, direction, in island.Triangles[neighborTriangleIndex], sharedEdgeIndexInNeighborTriangle);
+                  nextIterationShouldMovePAlongDirectionToEdge = true;
+               } else {
+                  var walkToEdgeVertex1 = direction.Dot(e01) > 0;
+                  var corner = walkToEdgeVertex1 ? e1 : e0;
+                  var pToCorner = p.To(corner);
+                  var pToCornerMag = pToCorner.Norm2D();
+                  var pToCornerDirection = pToCorner / pToCornerMag;
+
+                  if (pToCornerMag >= distanceRemaining) {
+                     var pTowardCorner = p + pToCornerDirection * distanceRemaining;
+                     if (HaltCheck(pTowardCorner, distanceRemaining)) break;
+                     p = pTowardCorner;
+                     distanceRemaining = 0;
+                     break;
+                  }
+
+                  if (HaltCheck(corner, distanceToEdge)) break;
+                  p = corner;
+                  distanceRemaining -= pToCornerMag;
+
+                  var cornerIndex = walkToEdgeVertex1 ? (outEdgeOpposingVertexIndex + 2) % 3 : (outEdgeOpposingVertexIndex + 1) % 3;
+                  var edgeToExit = walkToEdgeVertex1 ? (outEdgeOpposingVertexIndex + 1) % 3 : (outEdgeOpposingVertexIndex + 2) % 3;
+                  var wrapDirection = walkToEdgeVertex1 ? Clockness.CounterClockWise : Clockness.ClockWise;
+                  var res = FindExitTriangle(currentTriangleIndex, cornerIndex, edgeToExit, wrapDirection);
+                  if (res.ok) {
+                     currentTriangleIndex = res.triangleIndex;
+                     outEdgeOpposingVertexIndex = res.cornerIndex;
+                     nextIterationShouldMovePAlongDirectionToEdge = true;
+                  } else {
+                     var otherVertOfFollowedEdge = (res.cornerIndex - (int)wrapDirection + 3) % 3;
+                     var vertToSlideToward = island.Triangles[res.triangleIndex].Points[otherVertOfFollowedEdge];
+                     if (corner.To(vertToSlideToward).Dot(direction) > 0) {
+                        currentTriangleIndex = res.triangleIndex;
+                        outEdgeOpposingVertexIndex = (res.cornerIndex + (int)wrapDirection + 3) % 3;
+                        nextIterationShouldMovePAlongDirectionToEdge = false;
+                     } else {
+                        break;
+                     }
+                  }
+               }
+            }
+         }
+
+         private bool HaltCheck(DoubleVector2 next, double distanceToEdge) {
+            if (p == next) return false;
+
+            var haltDirection = p.To(next).ToUnit();
+            var nearest = -1;
+            var nearestDistance = double.PositiveInfinity;
+            for (var i = 0; i < haltSegments.Count; i++) {
+               var (seg, clockReq) = haltSegments[i];
+               var clock = (Clockness)(-(int)GeometryOperations.Clockness(seg.First, seg.Second, p));
+               if (clock == clockReq && GeometryOperations.TryFindNonoverlappingRaySegmentIntersectionT(in p, in haltDirection, in seg, out var tForRay) && nearestDistance > tForRay) {
+                  nearest = i;
+                  nearestDistance = tForRay;
+               }
+            }
+
+            if (nearest != -1 && nearestDistance <= distanceToEdge) {
+               p += haltDirection * nearestDistance;
+               distanceRemaining -= nearestDistance;
+               haltingSegment = nearest;
+               return true;
+            }
+            return false;
+         }
+
+         private static int FindOutEdgeIndex(ref DoubleVector2 p, DoubleVector2 direction, in Triangle3 triangle, int skippedEdge) {
+            int outEdgeOpposingVertexIndex;
+            var it = 0;
+            var offset = DoubleVector2.Zero;
+            while (!GeometryOperations.TryIntersectRayWithContainedOriginForVertexIndexOpposingEdge(p + offset, direction, in triangle, out outEdgeOpposingVertexIndex, skippedEdge)) {
+               offset -= direction * InternalTerrainCompilationConstants.TriangleEdgeBufferRadius;
+               it++;
+               if (it % 5 == 4) {
+                  var offsetToCentroid = p.To(triangle.Centroid);
+                  p = offsetToCentroid.Norm2D() < InternalTerrainCompilationConstants.TriangleEdgeBufferRadius
+                     ? triangle.Centroid
+                     : p + offsetToCentroid.ToUnit() * InternalTerrainCompilationConstants.TriangleEdgeBufferRadius;
+               }
+            }
+            return outEdgeOpposingVertexIndex;
+         }
+
+         private (bool ok, int triangleIndex, int cornerIndex) FindExitTriangle(int initialTriangleIndex, int initialCornerIndex, int initialEdgeToExit, Clockness wrapDirection) {
+            var currentTriangleIndex = initialTriangleIndex;
+            var currentCornerIndex = initialCornerIndex;
+            var corner = island.Triangles[currentTriangleIndex].Points[currentCornerIndex];
+            var edgeToExit = initialEdgeToExit;
+
+            while (true) {
+               ref var currentTriangle = ref island.Triangles[currentTriangleIndex];
+               var neighborIndex = currentTriangle.NeighborOppositePointIndices[edgeToExit];
+               var neighborInEdge = currentTriangle.NeighborVertexIndexSharingEdgeOppositePointIndices[edgeToExit];
+               if (neighborIndex == -1) {
+                  return (false, currentTriangleIndex, currentCornerIndex);
+               }
+
+               var currentTriangleCornerOffset = currentCornerIndex - edgeToExit;
+               var neighborCornerIndex = ((neighborInEdge - currentTriangleCornerOffset) + 3) % 3;
+               ref var neighborTriangle = ref island.Triangles[neighborIndex];
+               var neighborOutEdge = (neighborInEdge + currentTriangleCornerOffset + 3) % 3;
+               var neighborInEdgePoint = neighborTriangle.Points[neighborOutEdge];
+               var neighborOutEdgePoint = neighborTriangle.Points[neighborInEdge];
+
+               var directionCrossOutEdgeRay = GeometryOperations.Clockness(direction, corner.To(neighborOutEdgePoint));
+               var directionCrossInEdgeRay = GeometryOperations.Clockness(direction, corner.To(neighborInEdgePoint));
+               if ((int)directionCrossOutEdgeRay != (int)wrapDirection || (int)directionCrossInEdgeRay != -(int)wrapDirection) {
+                  currentTriangleIndex = neighborIndex;
+                  currentCornerIndex = neighborCornerIndex;
+                  edgeToExit = neighborOutEdge;
+               } else {
+                  return (true, neighborIndex, neighborCornerIndex);
+               }
+            }
+         }
+      }
+   }
+}
@@ -0,0 +1,54 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Linq;
+using Dargon.PlayOn.Geometry;
+using Xunit;
+
+namespace Dargon.Terragami.Tests {
+   public class VisibilityGraphTests {
+      // Waypoints i and j must be linked exactly when their segment misses every barrier, counting
+      // endpoint contact as managed bvh.Intersects does. Small grids make collinear links, links
+      // through barrier endpoints and waypoints on barriers common.
+      [Fact]
+      public void BuildVisibilityGraphMatchesBruteForce() {
+         for (var seed = 0; seed < 200; seed++) {
+            var r = new Random(seed);
+            var gridWidth = 6 + seed % 10;
+            var cells = new List<IntVector2>();
+            for (var y = 0; y < gridWidth; y++) {
+               for (var x = 0; x < gridWidth; x++) {
+                  cells.Add(new IntVector2(10 * x, 10 * y));
+               }
+            }
+            var waypoints = cells.OrderBy(_ => r.Next()).Take(10 + seed % 30).ToArray();
+
+            // Barrier endpoints on a half-cell grid, so they land on waypoints, between them and on links.
+            var barriers = new List<IntLineSegment2>();
+            while (barriers.Count < 1 + seed % 12) {
+               int Coordinate() => 5 * r.Next(0, 2 * (gridWidth - 1) + 1);
+               var a = new IntVector2(Coordinate(), Coordinate());
+               var b = new IntVector2(Coordinate(), Coordinate());
+               if (a.X != b.X || a.Y != b.Y) barriers.Add(new IntLineSegment2(a, b));
+            }
+
+            var (offsets, edgeTargets, edgeCosts) = NativeUtils.BuildVisibilityGraph(waypoints, barriers.ToArray());
+            Assert.Equal(waypoints.Length + 1, offsets.Length);
+            for (var i = 0; i < waypoints.Length; i++) {
+               var expected = new List<int>();
+               for (var j = 0; j < waypoints.Length; j++) {
+                  if (i == j) continue;
+                  var link = new IntLineSegment2(waypoints[i], waypoints[j]);
+                  if (!barriers.Any(barrier => link.Intersects(barrier))) expected.Add(j);
+               }
+
+               Assert.Equal(expected, edgeTargets[offsets[i]..offsets[i + 1]]);
+               for (var k = offsets[i]; k < offsets[i + 1]; k++) {
+                  var dx = waypoints[edgeTargets[k]].X - waypoints[i].X;
+                  var dy = waypoints[edgeTargets[k]].Y - waypoints[i].Y;
+                  Assert.Equal((float)Math.Sqrt(dx * dx + dy * dy), edgeCosts[k], 3);
+               }
+            }
+         }
+      }
+   }
+}
@@ -0,0 +1,76 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Linq;
+using Dargon.PlayOn.Geometry;
+using Xunit;
+
+namespace Dargon.Terragami.Tests {
+   public class VisibilityPolygonTests {
+      // A ray cast at the middle of every range must first hit that range's barrier, counting only
+      // barriers that face the origin, or nothing for -1.
+      [Fact]
+      public void BuildVisibilityPolygonsMatchesRayCasts() {
+         for (var seed = 0; seed < 100; seed++) {
+            var r = new Random(seed);
+
+            // Barriers may only meet at endpoints; keep them disjoint.
+            var barriers = new List<IntLineSegment2>();
+            for (var attempt = 0; attempt < 1000 && barriers.Count < 1 + seed % 40; attempt++) {
+               var a = new IntVector2(r.Next(-100, 101), r.Next(-100, 101));
+               var b = new IntVector2(a.X + r.Next(-30, 31), a.Y + r.Next(-30, 31));
+               if (a.X == b.X && a.Y == b.Y) continue;
+
+               var barrier = new IntLineSegment2(a, b);
+               if (!barriers.Any(other => barrier.Intersects(other))) barriers.Add(barrier);
+            }
+            var origins = Enumerable.Range(0, 1 + seed % 50).Select(_ => new IntVector2(r.Next(-120, 121), r.Next(-120, 121))).ToArray();
+
+            var (offsets, rangeIds, rangeThetaStarts) = NativeUtils.BuildVisibilityPolygons(origins, barriers.ToArray());
+            Assert.Equal(origins.Length + 1, offsets.Length);
+            for (var i = 0; i < origins.Length; i++) {
+               Assert.True(offsets[i] < offsets[i + 1]);
+               Assert.Equal(0.0, rangeThetaStarts[offsets[i]]);
+               for (var k = offsets[i]; k < offsets[i + 1]; k++) {
+                  var thetaEnd = k + 1 < offsets[i + 1] ? rangeThetaStarts[k + 1] : 4.0;
+                  Assert.True(rangeThetaStarts[k] < thetaEnd);
+                  if (thetaEnd - rangeThetaStarts[k] < 1E-6) continue;
+
+                  var expected = CastRay(origins[i], barriers, (rangeThetaStarts[k] + thetaEnd) / 2);
+                  Assert.Equal(expected, rangeIds[k]);
+               }
+            }
+         }
+      }
+
+      // Index of the nearest facing barrier hit from origin at the given pseudo-angle, or -1.
+      private static int CastRay(IntVector2 origin, List<IntLineSegment2> barriers, double theta) {
+         var (dx, dy) = PseudoAngleToDirection(theta);
+         var nearest = -1;
+         var nearestT = double.PositiveInfinity;
+         for (var i = 0; i < barriers.Count; i++) {
+            double ax = barriers[i].First.X - origin.X, ay = barriers[i].First.Y - origin.Y;
+            double bx = barriers[i].Second.X - origin.X, by = barriers[i].Second.Y - origin.Y;
+            if (ax * by - ay * bx <= 0) continue; // back-facing or collinear
+
+            double ex = bx - ax, ey = by - ay;
+            var denominator = dx * ey - dy * ex;
+            if (denominator == 0) continue;
+
+            var u = (ax * dy - ay * dx) / denominator;
+            var t = (ax * ey - ay * ex) / denominator;
+            if (u < 0 || u > 1 || t <= 0 || t >= nearestT) continue;
+            nearest = i;
+            nearestT = t;
+         }
+         return nearest;
+      }
+
+      // Inverse of the native diamond angle, scaled to |dx| + |dy| = 1.
+      private static (double dx, double dy) PseudoAngleToDirection(double theta) {
+         if (theta < 1) return (1 - theta, theta);
+         if (theta < 2) return (1 - theta, 2 - theta);
+         if (theta < 3) return (theta - 3, 2 - theta);
+         return (theta - 3, theta - 4);
+      }
+   }
+}
@@ -51,6 +51,10 @@
 #include <cassert>
 #include <queue>
 #include <iostream>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 namespace ClipperLib {
 
@@ -111,6 +115,8 @@ struct OutRec {
   PolyNode *PolyNd;
   OutPt    *Pts;
   OutPt    *BottomPt;
+  IntRect   Bounds;       //cached bounding box of Pts, see GetOutRecBounds
+  bool      BoundsValid;
 };
 
 class Pool {
@@ -181,6 +187,149 @@ void Join::operator delete(void* memory) {
 };
 
 
+//------------------------------------------------------------------------------
+// Post-processing parallelism
+//------------------------------------------------------------------------------
+
+//Below this many OutRecs, or this many OutPts across all of them, the
+//per-OutRec post-processing passes stay serial; handing work to the pool costs
+//more than fixing up a handful of small rings.
+static size_t const ParallelOutRecThreshold = 64;
+static size_t const ParallelOutPtThreshold = 16384;
+static size_t const ParallelOutRecChunkSize = 16;
+
+//Worker threads for a Clipper's post-processing passes. They're started by
+//the first pass that's big enough to split and then wait between passes and
+//Executes, so a Clipper starts its threads at most once.
+class OutRecWorkers
+{
+public:
+  //numThreads counts the calling thread
+  explicit OutRecWorkers(unsigned numThreads);
+  ~OutRecWorkers();
+  //runs body(i) for i in [0, count) on the caller and the workers
+  void For(size_t count, const std::function<void(size_t)> &body);
+private:
+  void WorkerLoop();
+  void RunChunks();
+  unsigned m_NumThreads;
+  std::vector<std::thread> m_Threads;
+  std::mutex m_Sync;
+  std::condition_variable m_Wake;
+  std::condition_variable m_Done;
+  unsigned long long m_Generation;
+  bool m_Stopping;
+  unsigned m_NumBusy;
+  const std::function<void(size_t)> *m_Body;
+  size_t m_Count;
+  std::atomic<size_t> m_NextChunk;
+};
+//------------------------------------------------------------------------------
+
+OutRecWorkers::OutRecWorkers(unsigned numThreads) :
+  m_NumThreads(std::max(1u, numThreads)), m_Generation(0), m_Stopping(false),
+  m_NumBusy(0), m_Body(0), m_Count(0), m_NextChunk(0)
+{
+}
+//------------------------------------------------------------------------------
+
+OutRecWorkers::~OutRecWorkers()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_Sync);
+    m_Stopping = true;
+  }
+  m_Wake.notify_all();
+  for (size_t i = 0; i < m_Threads.size(); ++i) m_Threads[i].join();
+}
+//------------------------------------------------------------------------------
+
+void OutRecWorkers::RunChunks()
+{
+  for (;;)
+  {
+    size_t start = m_NextChunk.fetch_add(ParallelOutRecChunkSize);
+    if (start >= m_Count) return;
+    size_t end = std::min(start + ParallelOutRecChunkSize, m_Count);
+    for (size_t i = start; i < end; ++i) (*m_Body)(i);
+  }
+}
+//------------------------------------------------------------------------------
+
+void OutRecWorkers::WorkerLoop()
+{
+  unsigned long long seen = 0;
+  for (;;)
+  {
+    {
+      std::unique_lock<std::mutex> lock(m_Sync);
+      m_Wake.wait(lock, [&]() { return m_Stopping || m_Generation != seen; });
+      if (m_Stopping) return;
+      seen = m_Generation;
+    }
+    RunChunks();
+    std::lock_guard<std::mutex> lock(m_Sync);
+    if (--m_NumBusy == 0) m_Done.notify_one();
+  }
+}
+//------------------------------------------------------------------------------
+
+void OutRecWorkers::For(size_t count, const std::function<void(size_t)> &body)
+{
+  if (count < ParallelOutRecThreshold || m_NumThreads <= 1)
+  {
+    for (size_t i = 0; i < count; ++i) body(i);
+    return;
+  }
+
+  if (m_Threads.empty())
+  {
+    m_Threads.reserve(m_NumThreads - 1);
+    for (unsigned t = 1; t < m_NumThreads; ++t)
+      m_Threads.push_back(std::thread(&OutRecWorkers::WorkerLoop, this));
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(m_Sync);
+    m_Body = &body;
+    m_Count = count;
+    m_NextChunk = 0;
+    m_NumBusy = (unsigned)m_Threads.size();
+    ++m_Generation;
+  }
+  m_Wake.notify_all();
+  RunChunks();
+
+  std::unique_lock<std::mutex> lock(m_Sync);
+  m_Done.wait(lock, [&]() { return m_NumBusy == 0; });
+  m_Body = 0;
+}
+//------------------------------------------------------------------------------
+
+//Whether a pass over count OutRecs is big enough to be worth splitting.
+bool Clipper::SplitsOutRecPass(size_t count) const
+{
+  return count >= ParallelOutRecThreshold && m_NumOutPts >= ParallelOutPtThreshold;
+}
+//------------------------------------------------------------------------------
+
+//Runs body(i) for i in [0, count), on the workers if SplitsOutRecPass(count).
+//body must only touch state owned by index i.
+template <typename Body>
+void Clipper::ParallelForOutRecs(size_t count, Body body)
+{
+  if (!SplitsOutRecPass(count))
+  {
+    for (size_t i = 0; i < count; ++i) body(i);
+    return;
+  }
+  if (!m_Workers)
+    m_Workers = new OutRecWorkers(m_PostProcessingThreads ?
+      m_PostProcessingThreads : std::thread::hardware_concurrency());
+  m_Workers->For(count, std::function<void(size_t)>(body));
+}
+//------------------------------------------------------------------------------
+
 struct LocMinSorter
 {
   inline bool operator()(const LocalMinimum& locMin1, const LocalMinimum& locMin2)
@@ -597,6 +746,49 @@ bool Poly2ContainsPoly1(OutPt *OutPt1, OutPt *OutPt2)
 }
 //----------------------------------------------------------------------
 
+//Bounding boxes are cached per OutRec and dropped whenever its ring is
+//rewired (joins, splits, fixups), so FirstLeft fixups can discard far-away
+//OutRecs without walking their points.
+const IntRect& GetOutRecBounds(OutRec &outRec)
+{
+  if (!outRec.BoundsValid)
+  {
+    OutPt* op = outRec.Pts;
+    IntRect& r = outRec.Bounds;
+    r.left = r.right = op->Pt.X;
+    r.top = r.bottom = op->Pt.Y;
+    for (op = op->Next; op != outRec.Pts; op = op->Next)
+    {
+      if (op->Pt.X < r.left) r.left = op->Pt.X;
+      else if (op->Pt.X > r.right) r.right = op->Pt.X;
+      if (op->Pt.Y < r.top) r.top = op->Pt.Y;
+      else if (op->Pt.Y > r.bottom) r.bottom = op->Pt.Y;
+    }
+    outRec.BoundsValid = true;
+  }
+  return outRec.Bounds;
+}
+//----------------------------------------------------------------------
+
+inline void InvalidateOutRecBounds(OutRec &outRec)
+{
+  outRec.BoundsValid = false;
+}
+//----------------------------------------------------------------------
+
+//Exactly equivalent to Poly2ContainsPoly1, but rejects in O(1) when the two
+//rings' boxes don't even touch: then every point of OutRec1 is outside
+//OutRec2, and Poly2ContainsPoly1 would return false on its first point.
+bool OutRec2ContainsOutRec1(OutRec &outRec1, OutRec &outRec2)
+{
+  const IntRect& r1 = GetOutRecBounds(outRec1);
+  const IntRect& r2 = GetOutRecBounds(outRec2);
+  if (r1.left > r2.right || r1.right < r2.left ||
+      r1.top > r2.bottom || r1.bottom < r2.top) return false;
+  return Poly2ContainsPoly1(outRec1.Pts, outRec2.Pts);
+}
+//----------------------------------------------------------------------
+
 bool SlopesEqual(const TEdge &e1, const TEdge &e2, bool UseFullInt64Range)
 {
 #ifndef use_int32
@@ -775,6 +967,20 @@ void DisposeOutPts(OutPt*& pp)
 }
 //------------------------------------------------------------------------------
 
+//Like DisposeOutPts, but defers the deletes: outPtPool is not thread safe, so
+//rings unlinked on worker threads are freed later on the calling thread.
+void CollectOutPts(OutPt*& pp, std::vector<OutPt*>& disposed)
+{
+  if (pp == 0) return;
+    pp->Prev->Next = 0;
+  while( pp )
+  {
+    disposed.push_back(pp);
+    pp = pp->Next;
+  }
+}
+//------------------------------------------------------------------------------
+
 inline void InitEdge(TEdge* e, TEdge* eNext, TEdge* ePrev, const IntPoint& Pt)
 {
   std::memset(e, 0, sizeof(TEdge));
@@ -1101,7 +1307,8 @@ TEdge* ClipperBase::ProcessBound(TEdge* E, bool NextIsForward)
 }
 //------------------------------------------------------------------------------
 
-bool ClipperBase::AddPath(const Path &pg, PolyType PolyTyp, bool Closed)
+template <typename PointAt>
+bool ClipperBase::AddPathInternal(PointAt pg, int pointCount, PolyType PolyTyp, bool Closed)
 {
 #ifdef use_lines
   if (!Closed && PolyTyp == ptClip)
@@ -1111,9 +1318,9 @@ bool ClipperBase::AddPath(const Path &pg, PolyType PolyTyp, bool Closed)
     throw clipperException("AddPath: Open paths have been disabled.");
 #endif
 
-  int highI = (int)pg.size() -1;
-  if (Closed) while (highI > 0 && (pg[highI] == pg[0])) --highI;
-  while (highI > 0 && (pg[highI] == pg[highI -1])) --highI;
+  int highI = pointCount -1;
+  if (Closed) while (highI > 0 && (pg(highI) == pg(0))) --highI;
+  while (highI > 0 && (pg(highI) == pg(highI -1))) --highI;
   if ((Closed && highI < 2) || (!Closed && highI < 1)) return false;
 
   //create a new edge array ...
@@ -1123,15 +1330,15 @@ bool ClipperBase::AddPath(const Path &pg, PolyType PolyTyp, bool Closed)
   //1. Basic (first) edge initialization ...
   try
   {
-    edges[1].Curr = pg[1];
-    RangeTest(pg[0], m_UseFullRange);
-    RangeTest(pg[highI], m_UseFullRange);
-    InitEdge(&edges[0], &edges[1], &edges[highI], pg[0]);
-    InitEdge(&edges[highI], &edges[0], &edges[highI-1], pg[highI]);
+    edges[1].Curr = pg(1);
+    RangeTest(pg(0), m_UseFullRange);
+    RangeTest(pg(highI), m_UseFullRange);
+    InitEdge(&edges[0], &edges[1], &edges[highI], pg(0));
+    InitEdge(&edges[highI], &edges[0], &edges[highI-1], pg(highI));
     for (int i = highI - 1; i >= 1; --i)
     {
-      RangeTest(pg[i], m_UseFullRange);
-      InitEdge(&edges[i], &edges[i+1], &edges[i-1], pg[i]);
+      RangeTest(pg(i), m_UseFullRange);
+      InitEdge(&edges[i], &edges[i+1], &edges[i-1], pg(i));
     }
   }
   catch(...)
@@ -1280,6 +1487,22 @@ bool ClipperBase::AddPath(const Path &pg, PolyType PolyTyp, bool Closed)
 }
 //------------------------------------------------------------------------------
 
+bool ClipperBase::AddPath(const Path &pg, PolyType PolyTyp, bool Closed)
+{
+  return AddPathInternal([&pg](int i) -> const IntPoint& { return pg[i]; },
+    (int)pg.size(), PolyTyp, Closed);
+}
+//------------------------------------------------------------------------------
+
+bool ClipperBase::AddPath(const cInt *xy, size_t pointCount, PolyType PolyTyp, bool Closed)
+{
+  //xy is interleaved (x0, y0, x1, y1, ...) and is read in place, so callers
+  //holding coordinates in a flat (e.g. pinned managed) buffer skip building a Path.
+  return AddPathInternal([xy](int i) { return IntPoint(xy[2 * i], xy[2 * i + 1]); },
+    (int)pointCount, PolyTyp, Closed);
+}
+//------------------------------------------------------------------------------
+
 bool ClipperBase::AddPaths(const Paths &ppg, PolyType PolyTyp, bool Closed)
 {
   bool result = false;
@@ -1289,6 +1512,18 @@ bool ClipperBase::AddPaths(const Paths &ppg, PolyType PolyTyp, bool Closed)
 }
 //------------------------------------------------------------------------------
 
+bool ClipperBase::AddPaths(const cInt *xy, const int *pathPointCounts, size_t pathCount, PolyType PolyTyp, bool Closed)
+{
+  bool result = false;
+  for (size_t i = 0; i < pathCount; ++i)
+  {
+    if (AddPath(xy, pathPointCounts[i], PolyTyp, Closed)) result = true;
+    xy += 2 * pathPointCounts[i];
+  }
+  return result;
+}
+//------------------------------------------------------------------------------
+
 void ClipperBase::Clear()
 {
   DisposeLocalMinimaList();
@@ -1445,6 +1680,7 @@ OutRec* ClipperBase::CreateOutRec()
   result->Pts = 0;
   result->BottomPt = 0;
   result->PolyNd = 0;
+  result->BoundsValid = false;
   m_PolyOuts.push_back(result);
   result->Idx = (int)m_PolyOuts.size() - 1;
   return result;
@@ -1538,12 +1774,31 @@ Clipper::Clipper(int initOptions) : ClipperBase() //constructor
   m_StrictSimple = ((initOptions & ioStrictlySimple) != 0);
   m_PreserveCollinear = ((initOptions & ioPreserveCollinear) != 0);
   m_HasOpenPaths = false;
+  m_PostProcessingThreads = 0;
+  m_Workers = 0;
+  m_NumOutPts = 0;
 #ifdef use_xyz  
   m_ZFill = 0;
 #endif
 }
 //------------------------------------------------------------------------------
 
+Clipper::~Clipper() //destructor
+{
+  delete m_Workers;
+}
+//------------------------------------------------------------------------------
+
+void Clipper::PostProcessingThreads(unsigned value)
+{
+  if (value == m_PostProcessingThreads) return;
+  m_PostProcessingThreads = value;
+  //the pool is sized when it starts, so restart it on the next big pass
+  delete m_Workers;
+  m_Workers = 0;
+}
+//------------------------------------------------------------------------------
+
 #ifdef use_xyz  
 void Clipper::ZFillFunction(ZFillCallback zFillFunc)
 {  
@@ -1619,6 +1874,7 @@ void Clipper::FixHoleLinkage(OutRec &outrec)
 bool Clipper::ExecuteInternal()
 {
   bool succeeded = true;
+  m_NumOutPts = 0;
   try {
     Reset();
     m_Maxima = MaximaList();
@@ -1649,26 +1905,38 @@ bool Clipper::ExecuteInternal()
 
   if (succeeded)
   {
-    //fix orientations ...
-    for (PolyOutList::size_type i = 0; i < m_PolyOuts.size(); ++i)
+    //fix orientations (each OutRec owns its own OutPt ring, so this and the
+    //fixups below are independent per OutRec) ...
+    ParallelForOutRecs(m_PolyOuts.size(), [this](size_t i)
     {
       OutRec *outRec = m_PolyOuts[i];
-      if (!outRec->Pts || outRec->IsOpen) continue;
+      if (!outRec->Pts || outRec->IsOpen) return;
       if ((outRec->IsHole ^ m_ReverseOutput) == (Area(*outRec) > 0))
         ReversePolyPtLinks(outRec->Pts);
-    }
+    });
 
     if (!m_Joins.empty()) JoinCommonEdges();
 
     //unfortunately FixupOutPolygon() must be done after JoinCommonEdges()
-    for (PolyOutList::size_type i = 0; i < m_PolyOuts.size(); ++i)
+    //(a list of disposed OutPts per OutRec if the pass is split, else just one)
+    std::vector<std::vector<OutPt*> > &disposed = m_DisposedOutPts;
+    bool split = SplitsOutRecPass(m_PolyOuts.size());
+    size_t numLists = split ? m_PolyOuts.size() : 1;
+    if (disposed.size() < numLists) disposed.resize(numLists);
+    ParallelForOutRecs(m_PolyOuts.size(), [this, &disposed, split](size_t i)
     {
       OutRec *outRec = m_PolyOuts[i];
-      if (!outRec->Pts) continue;
+      if (!outRec->Pts) return;
       if (outRec->IsOpen)
-        FixupOutPolyline(*outRec);
+        FixupOutPolyline(*outRec, disposed[split ? i : 0]);
       else
-        FixupOutPolygon(*outRec);
+        FixupOutPolygon(*outRec, disposed[split ? i : 0]);
+    });
+    for (size_t i = 0; i < numLists; ++i)
+    {
+      for (size_t j = 0; j < disposed[i].size(); ++j)
+        delete disposed[i][j];
+      disposed[i].clear();
     }
 
     if (m_StrictSimple) DoSimplePolygons();
@@ -2526,6 +2794,7 @@ OutPt* Clipper::AddOutPt(TEdge *e, const IntPoint &pt)
     OutRec *outRec = CreateOutRec();
     outRec->IsOpen = (e->WindDelta == 0);
     OutPt* newOp = new (outPtPool) OutPt;
+    ++m_NumOutPts;
     outRec->Pts = newOp;
     newOp->Idx = outRec->Idx;
     newOp->Pt = pt;
@@ -2546,6 +2815,7 @@ OutPt* Clipper::AddOutPt(TEdge *e, const IntPoint &pt)
     else if (!ToFront && (pt == op->Prev->Pt)) return op->Prev;
 
     OutPt* newOp = new (outPtPool) OutPt;
+    ++m_NumOutPts;
     newOp->Idx = outRec->Idx;
     newOp->Pt = pt;
     newOp->Next = op;
@@ -3165,7 +3435,7 @@ void Clipper::ProcessEdgesAtTopOfScanbeam(const cInt topY)
 }
 //------------------------------------------------------------------------------
 
-void Clipper::FixupOutPolyline(OutRec &outrec)
+void Clipper::FixupOutPolyline(OutRec &outrec, std::vector<OutPt*> &disposed)
 {
   OutPt *pp = outrec.Pts;
   OutPt *lastPP = pp->Prev;
@@ -3178,21 +3448,21 @@ void Clipper::FixupOutPolyline(OutRec &outrec)
       OutPt *tmpPP = pp->Prev;
       tmpPP->Next = pp->Next;
       pp->Next->Prev = tmpPP;
-      delete pp;
+      disposed.push_back(pp);
       pp = tmpPP;
     }
   }
 
   if (pp == pp->Prev)
   {
-    DisposeOutPts(pp);
+    CollectOutPts(pp, disposed);
     outrec.Pts = 0;
     return;
   }
 }
 //------------------------------------------------------------------------------
 
-void Clipper::FixupOutPolygon(OutRec &outrec)
+void Clipper::FixupOutPolygon(OutRec &outrec, std::vector<OutPt*> &disposed)
 {
     //FixupOutPolygon() - removes duplicate points and simplifies consecutive
     //parallel edges by removing the middle vertex.
@@ -3205,7 +3475,7 @@ void Clipper::FixupOutPolygon(OutRec &outrec)
     {
         if (pp->Prev == pp || pp->Prev == pp->Next)
         {
-            DisposeOutPts(pp);
+            CollectOutPts(pp, disposed);
             outrec.Pts = 0;
             return;
         }
@@ -3220,7 +3490,7 @@ void Clipper::FixupOutPolygon(OutRec &outrec)
             pp->Prev->Next = pp->Next;
             pp->Next->Prev = pp->Prev;
             pp = pp->Prev;
-            delete tmp;
+            disposed.push_back(tmp);
         }
         else if (pp == lastOK) break;
         else
@@ -3273,11 +3543,18 @@ void Clipper::BuildResult2(PolyTree& polytree)
 {
     polytree.Clear();
     polytree.AllNodes.reserve(m_PolyOuts.size());
-    //add each output polygon/contour to polytree ...
+    //add each output polygon/contour to polytree. Hole linkage walks other
+    //OutRecs' FirstLeft chains, so it stays serial; contours are copied after.
+    std::vector<int> &counts = m_PointCounts;
+    counts.resize(m_PolyOuts.size());
+    ParallelForOutRecs(m_PolyOuts.size(), [this, &counts](size_t i)
+    {
+        counts[i] = PointCount(m_PolyOuts[i]->Pts);
+    });
     for (PolyOutList::size_type i = 0; i < m_PolyOuts.size(); i++)
     {
         OutRec* outRec = m_PolyOuts[i];
-        int cnt = PointCount(outRec->Pts);
+        int cnt = counts[i];
         if ((outRec->IsOpen && cnt < 2) || (!outRec->IsOpen && cnt < 3)) continue;
         FixHoleLinkage(*outRec);
         PolyNode* pn = new PolyNode();
@@ -3286,14 +3563,21 @@ void Clipper::BuildResult2(PolyTree& polytree)
         outRec->PolyNd = pn;
         pn->Parent = 0;
         pn->Index = 0;
-        pn->Contour.reserve(cnt);
+    }
+    ParallelForOutRecs(m_PolyOuts.size(), [this, &counts](size_t i)
+    {
+        OutRec* outRec = m_PolyOuts[i];
+        PolyNode* pn = outRec->PolyNd;
+        if (!pn) return;
+        int cnt = counts[i];
+        pn->Contour.resize(cnt);
         OutPt *op = outRec->Pts->Prev;
         for (int j = 0; j < cnt; j++)
         {
-            pn->Contour.push_back(op->Pt);
+            pn->Contour[j] = op->Pt;
             op = op->Prev;
         }
-    }
+    });
 
     //fixup PolyNode links etc ...
     polytree.Childs.reserve(m_PolyOuts.size());
@@ -3683,7 +3967,7 @@ void Clipper::FixupFirstLefts1(OutRec* OldOutRec, OutRec* NewOutRec)
     OutRec* firstLeft = ParseFirstLeft(outRec->FirstLeft);
     if (outRec->Pts  && firstLeft == OldOutRec)
     {
-      if (Poly2ContainsPoly1(outRec->Pts, NewOutRec->Pts))
+      if (OutRec2ContainsOutRec1(*outRec, *NewOutRec))
         outRec->FirstLeft = NewOutRec;
     }
   }
@@ -3706,9 +3990,9 @@ void Clipper::FixupFirstLefts2(OutRec* InnerOutRec, OutRec* OuterOutRec)
     OutRec* firstLeft = ParseFirstLeft(outRec->FirstLeft);
     if (firstLeft != orfl && firstLeft != InnerOutRec && firstLeft != OuterOutRec)
       continue;
-    if (Poly2ContainsPoly1(outRec->Pts, InnerOutRec->Pts))
+    if (OutRec2ContainsOutRec1(*outRec, *InnerOutRec))
       outRec->FirstLeft = InnerOutRec;
-    else if (Poly2ContainsPoly1(outRec->Pts, OuterOutRec->Pts))
+    else if (OutRec2ContainsOutRec1(*outRec, *OuterOutRec))
       outRec->FirstLeft = OuterOutRec;
     else if (outRec->FirstLeft == InnerOutRec || outRec->FirstLeft == OuterOutRec)
       outRec->FirstLeft = orfl;
@@ -3730,6 +4014,9 @@ void Clipper::FixupFirstLefts3(OutRec* OldOutRec, OutRec* NewOutRec)
 
 void Clipper::JoinCommonEdges()
 {
+  for (PolyOutList::size_type i = 0; i < m_PolyOuts.size(); ++i)
+    InvalidateOutRecBounds(*m_PolyOuts[i]);
+
   for (JoinList::size_type i = 0; i < m_Joins.size(); i++)
   {
     Join* join = m_Joins[i];
@@ -3749,6 +4036,8 @@ void Clipper::JoinCommonEdges()
     else holeStateRec = GetLowermostRec(outRec1, outRec2);
 
     if (!JoinPoints(join, outRec1, outRec2)) continue;
+    InvalidateOutRecBounds(*outRec1);
+    InvalidateOutRecBounds(*outRec2);
 
     if (outRec1 == outRec2)
     {
@@ -4270,16 +4559,96 @@ void ClipperOffset::DoRound(int j, int k)
 // Miscellaneous public functions
 //------------------------------------------------------------------------------
 
+inline unsigned long long PointKey(const IntPoint &pt)
+{
+  return ((unsigned long long)(unsigned)pt.X << 32) | (unsigned)pt.Y;
+}
+//------------------------------------------------------------------------------
+
+//Collects the positions visited more than once by the ring at pts into the
+//front of keys, sorted so they can be binary searched, and returns how many
+//there are. keys must have room for every point of the ring. Zero means the
+//ring has no self-touches and needs no splitting.
+size_t FindRepeatedPoints(OutPt *pts, unsigned long long *keys)
+{
+  size_t n = 0;
+  OutPt *op = pts;
+  do
+  {
+    keys[n++] = PointKey(op->Pt);
+    op = op->Next;
+  }
+  while (op != pts);
+  std::sort(keys, keys + n);
+  //keep one copy of each key that occurs more than once
+  size_t cnt = 0;
+  for (size_t i = 1; i < n; ++i)
+    if (keys[i] == keys[i - 1] && (cnt == 0 || keys[cnt - 1] != keys[i]))
+      keys[cnt++] = keys[i];
+  return cnt;
+}
+//------------------------------------------------------------------------------
+
 void Clipper::DoSimplePolygons()
 {
+  //Detecting self-touches is independent per OutRec, so it's done up front in
+  //parallel; only OutRecs with a repeated vertex go through the splitting loop.
+  //Splits rewire FirstLeft across all OutRecs and so remain serial. OutRecs
+  //created by splits are checked as they come up. Every ring's keys share one
+  //buffer, kept between Executes, so this doesn't allocate per OutRec.
+  PolyOutList::size_type initialCount = m_PolyOuts.size();
+  std::vector<std::pair<size_t, size_t> > &ranges = m_RepeatedPointRanges;
+  ranges.resize(initialCount);
+  ParallelForOutRecs(initialCount, [this, &ranges](size_t i)
+  {
+    OutRec* outrec = m_PolyOuts[i];
+    ranges[i].second = (outrec->Pts && !outrec->IsOpen) ? PointCount(outrec->Pts) : 0;
+  });
+  size_t numKeys = 0;
+  for (PolyOutList::size_type i = 0; i < initialCount; ++i)
+  {
+    ranges[i].first = numKeys;
+    numKeys += ranges[i].second;
+  }
+  if (m_RepeatedPoints.size() < numKeys) m_RepeatedPoints.resize(numKeys);
+  unsigned long long *keys = m_RepeatedPoints.data();
+  ParallelForOutRecs(initialCount, [this, &ranges, keys](size_t i)
+  {
+    if (!ranges[i].second) return;
+    ranges[i].second = ranges[i].first +
+      FindRepeatedPoints(m_PolyOuts[i]->Pts, keys + ranges[i].first);
+  });
+
+  for (PolyOutList::size_type i = 0; i < initialCount; ++i)
+    InvalidateOutRecBounds(*m_PolyOuts[i]);
+
   PolyOutList::size_type i = 0;
   while (i < m_PolyOuts.size()) 
   {
-    OutRec* outrec = m_PolyOuts[i++];
+    OutRec* outrec = m_PolyOuts[i];
     OutPt* op = outrec->Pts;
-    if (!op || outrec->IsOpen) continue;
+    if (!op || outrec->IsOpen) { ++i; continue; }
+    unsigned long long *repeated, *repeatedEnd;
+    if (i < initialCount)
+    {
+      repeated = keys + ranges[i].first;
+      repeatedEnd = keys + ranges[i].second;
+    }
+    else
+    {
+      //a split-off ring; the original rings' keys are done with by now
+      size_t cnt = PointCount(op);
+      if (m_RepeatedPoints.size() < cnt) m_RepeatedPoints.resize(cnt);
+      keys = m_RepeatedPoints.data();
+      repeated = keys;
+      repeatedEnd = keys + FindRepeatedPoints(op, keys);
+    }
+    ++i;
+    if (repeated == repeatedEnd) continue;
     do //for each Pt in Polygon until duplicate found do ...
     {
+      if (!std::binary_search(repeated, repeatedEnd, PointKey(op->Pt)))
+        { op = op->Next; continue; }
       OutPt* op2 = op->Next;
       while (op2 != outrec->Pts) 
       {
@@ -4294,6 +4663,7 @@ void Clipper::DoSimplePolygons()
           op3->Next = op2;
 
           outrec->Pts = op;
+          InvalidateOutRecBounds(*outrec);
           OutRec* outrec2 = CreateOutRec();
           outrec2->Pts = op2;
           UpdateOutPtIdxs(*outrec2);
@@ -204,6 +204,7 @@ struct LocalMinimum;
 struct OutPt;
 struct OutRec;
 struct Join;
+class OutRecWorkers;
 
 typedef std::vector < OutRec* > PolyOutList;
 typedef std::vector < TEdge* > EdgeList;
@@ -221,7 +222,9 @@ public:
   ClipperBase();
   virtual ~ClipperBase();
   virtual bool AddPath(const Path &pg, PolyType PolyTyp, bool Closed);
+  bool AddPath(const cInt *xy, size_t pointCount, PolyType PolyTyp, bool Closed);
   bool AddPaths(const Paths &ppg, PolyType PolyTyp, bool Closed);
+  bool AddPaths(const cInt *xy, const int *pathPointCounts, size_t pathCount, PolyType PolyTyp, bool Closed);
   virtual void Clear();
   IntRect GetBounds();
   bool PreserveCollinear() {return m_PreserveCollinear;};
@@ -241,6 +244,8 @@ protected:
   void SwapPositionsInAEL(TEdge *edge1, TEdge *edge2);
   void DeleteFromAEL(TEdge *e);
   void UpdateEdgeIntoAEL(TEdge *&e);
+  template <typename PointAt>
+  bool AddPathInternal(PointAt pg, int pointCount, PolyType PolyTyp, bool Closed);
 
   typedef std::vector<LocalMinimum> MinimaList;
   MinimaList::iterator m_CurrentLM;
@@ -262,6 +267,7 @@ class Clipper : public virtual ClipperBase
 {
 public:
   Clipper(int initOptions = 0);
+  ~Clipper();
   bool Execute(ClipType clipType,
       Paths &solution,
       PolyFillType fillType = pftEvenOdd);
@@ -280,6 +286,9 @@ public:
   void ReverseSolution(bool value) {m_ReverseOutput = value;};
   bool StrictlySimple() {return m_StrictSimple;};
   void StrictlySimple(bool value) {m_StrictSimple = value;};
+  //threads for the per-OutRec post-processing passes, 0 (default) for one per core
+  unsigned PostProcessingThreads() {return m_PostProcessingThreads;};
+  void PostProcessingThreads(unsigned value);
   //set the callback function for z value filling on intersections (otherwise Z is 0)
 #ifdef use_xyz
   void ZFillFunction(ZFillCallback zFillFunc);
@@ -300,6 +309,15 @@ private:
   bool             m_ReverseOutput;
   bool             m_UsingPolyTree; 
   bool             m_StrictSimple;
+  unsigned         m_PostProcessingThreads;
+  OutRecWorkers   *m_Workers; //started by the first pass big enough to split
+  size_t           m_NumOutPts; //OutPts added by AddOutPt this Execute
+  //per-OutRec scratch for the post-processing passes, kept between Executes
+  //so repeated small clips don't reallocate it
+  std::vector<std::vector<OutPt*> > m_DisposedOutPts;
+  std::vector<unsigned long long> m_RepeatedPoints;
+  std::vector<std::pair<size_t, size_t> > m_RepeatedPointRanges;
+  std::vector<int> m_PointCounts;
 #ifdef use_xyz
   ZFillCallback   m_ZFill; //custom callback 
 #endif
@@ -334,8 +352,8 @@ private:
   void SetHoleState(TEdge *e, OutRec *outrec);
   void DisposeIntersectNodes();
   bool FixupIntersectionOrder();
-  void FixupOutPolygon(OutRec &outrec);
-  void FixupOutPolyline(OutRec &outrec);
+  void FixupOutPolygon(OutRec &outrec, std::vector<OutPt*> &disposed);
+  void FixupOutPolyline(OutRec &outrec, std::vector<OutPt*> &disposed);
   bool IsHole(TEdge *e);
   bool FindOwnerFromSplitRecs(OutRec &outRec, OutRec *&currOrfl);
   void FixHoleLinkage(OutRec &outrec);
@@ -346,6 +364,8 @@ private:
   bool JoinPoints(Join *j, OutRec* outRec1, OutRec* outRec2);
   void JoinCommonEdges();
   void DoSimplePolygons();
+  bool SplitsOutRecPass(size_t count) const;
+  template <typename Body> void ParallelForOutRecs(size_t count, Body body);
   void FixupFirstLefts1(OutRec* OldOutRec, OutRec* NewOutRec);
   void FixupFirstLefts2(OutRec* InnerOutRec, OutRec* OuterOutRec);
   void FixupFirstLefts3(OutRec* OldOutRec, OutRec* NewOutRec);
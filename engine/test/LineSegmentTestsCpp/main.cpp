@@ -1,6 +1,13 @@
+#include <atomic>
+#include <cmath>
 #include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <fstream>
+#include <new>
+#include <random>
+#include <string>
 #include <vector>
 #include <chrono>
 #include <stack>
@@ -70,7 +77,25 @@ bool intersects(IntLineSegment2& a, IntLineSegment2& b) {
    return Intersects(ax, ay, bx, by, cx, cy, dx, dy);
 }
 
-void runTrial(IntLineSegment2* ls, int n) {
+// Counts every global operator new so benchmarks can report allocations/op.
+// Note Clipper's OutPt/Join pools fall back to malloc and aren't counted here.
+static std::atomic<uint64_t> g_allocations{ 0 };
+
+void* operator new(size_t size) {
+   g_allocations.fetch_add(1, std::memory_order_relaxed);
+   if (auto p = std::malloc(size ? size : 1)) return p;
+   throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+   std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+   std::free(p);
+}
+
+long runTrial(IntLineSegment2* ls, int n) {
    long count = 0;
    for (auto i = 0; i < n; i++) {
       for (auto j = 0; j < n; j++) {
@@ -79,103 +104,367 @@ void runTrial(IntLineSegment2* ls, int n) {
          }
       }
    }
-   std::cout << count << std::endl;
+   return count;
 }
 
-void runTrial2(ClipperLib::Paths& included, ClipperLib::Paths& excluded) {
-   ClipperLib::Clipper x { ClipperLib::ioStrictlySimple };
-   x.AddPaths(included, ClipperLib::ptSubject, true);
-   x.AddPaths(excluded, ClipperLib::ptClip, true);
+// Flat contour set: interleaved (x, y) coordinates plus per-contour point counts,
+// the same shape as pinned IntVector2[] buffers handed over from managed code.
+struct FlatPaths {
+   std::vector<ClipperLib::cInt> Xy;
+   std::vector<int> PointCounts;
+
+   int NumVertices() const { return static_cast<int>(Xy.size() / 2); }
+
+   ClipperLib::Paths ToPaths() const {
+      ClipperLib::Paths res;
+      auto p = Xy.data();
+      for (auto count : PointCounts) {
+         ClipperLib::Path path;
+         for (auto i = 0; i < count; i++, p += 2) {
+            path.push_back({ p[0], p[1] });
+         }
+         res.push_back(path);
+      }
+      return res;
+   }
+};
 
-   // std::cout << included.size() << " " << excluded.size() << std::endl;
+int runTrial2(FlatPaths& included, FlatPaths& excluded) {
+   ClipperLib::Clipper x { ClipperLib::ioStrictlySimple };
+   x.AddPaths(included.Xy.data(), included.PointCounts.data(), included.PointCounts.size(), ClipperLib::ptSubject, true);
+   x.AddPaths(excluded.Xy.data(), excluded.PointCounts.data(), excluded.PointCounts.size(), ClipperLib::ptClip, true);
 
    ClipperLib::PolyTree res{};
    x.Execute(ClipperLib::ctDifference, res, ClipperLib::pftPositive);
-   return;
+   return res.Total();
+}
 
-   std::function<void(ClipperLib::PolyNode*, int)> R = [&](ClipperLib::PolyNode* n, int depth) {
-      std::cout << ":";
-      for (auto i = 0; i < depth; i++) {
-         std::cout << " ";
-      }
-      
-      int counter = 0;
-      for (auto& p : n->Contour) {
-         std::cout << p.X << " " << p.Y << (counter + 1 == n->Contour.size() ? "" : ", ");
-         counter++;
-      }
-      std::cout << std::endl;
+int runUnion(FlatPaths& paths) {
+   ClipperLib::Clipper x;
+   x.AddPaths(paths.Xy.data(), paths.PointCounts.data(), paths.PointCounts.size(), ClipperLib::ptSubject, true);
 
-      //for (auto x : n->Childs) {
-      for (auto it = n->Childs.rbegin(); 
-           it != n->Childs.rend();
-           ++it) {
-         R(*it, depth + 1);
-      }
-   };
+   ClipperLib::PolyTree res{};
+   x.Execute(ClipperLib::ctUnion, res, ClipperLib::pftNonZero);
+   return res.Total();
+}
 
-   R(&res, 0);
-   while (true) srand(0);
+int runOffset(ClipperLib::Paths& paths) {
+   ClipperLib::ClipperOffset x;
+   x.AddPaths(paths, ClipperLib::jtMiter, ClipperLib::etClosedPolygon);
+
+   ClipperLib::Paths res;
+   x.Execute(res, 15.0);
+   return static_cast<int>(res.size());
 }
 
-int main() {
-   std::cout << std::setprecision(10) << std::fixed;
+int runMinkowski(ClipperLib::Path& pattern, ClipperLib::Paths& paths) {
+   ClipperLib::Paths res;
+   ClipperLib::MinkowskiSum(pattern, paths, res, true);
+   return static_cast<int>(res.size());
+}
 
-   //auto y = R"A(v:\my-repositories\miyu\derp\TestProjects\LineSegmentTestsCpp\segments.txt)A";
-   auto y = R"A(v:\my-repositories\miyu\derp\TestProjects\LineSegmentTestsCpp\test2d.txt)A";
-   std::fstream fs(y, std::fstream::in);
+// Fixtures live next to the project and are copied next to the binary, so the
+// benchmark runs from either the project directory or the output directory.
+std::ifstream OpenFixture(const std::string& name) {
+   std::ifstream fs(name);
+   if (!fs) {
+      std::cerr << "Could not open fixture " << name << std::endl;
+      std::exit(1);
+   }
+   return fs;
+}
+
+std::vector<IntLineSegment2> LoadSegments(const std::string& name) {
+   auto fs = OpenFixture(name);
+   std::vector<IntLineSegment2> ls;
+   int a, b, c, d;
+   while (fs >> a && fs >> b && fs >> c && fs >> d) {
+      ls.push_back({ {a, b}, {c, d} });
+   }
+   return ls;
+}
 
-   ClipperLib::Paths included, excluded;
+void LoadContours(const std::string& name, FlatPaths& included, FlatPaths& excluded) {
+   auto fs = OpenFixture(name);
 
    int a;
    while (fs >> a) {
-      ClipperLib::Path path;
-      
+      auto& dest = a == 0 ? included : excluded;
+
       int c;  
       fs >> c;
+      dest.PointCounts.push_back(c);
 
       for (auto i = 0; i < c; i++) {
          int x, y;
          fs >> x;
          fs >> y;
 
-         path.push_back({ x, y });
+         dest.Xy.push_back(x);
+         dest.Xy.push_back(y);
       }
+   }
+}
 
-      if (a == 0) {
-         included.push_back(path);
-      } else {
-         excluded.push_back(path);
+// Synthetic map: one square of land with a jittered grid of n-gon holes, sized so
+// land + holes total roughly numVertices. Coordinates stay within Clipper's
+// use_int32 range (+/- 0x7FFF).
+void BuildSyntheticMap(int numVertices, FlatPaths& land, FlatPaths& holes) {
+   const int kExtent = 30000;
+   const int kHoleVertices = 8;
+
+   land.Xy = { -kExtent, -kExtent, kExtent, -kExtent, kExtent, kExtent, -kExtent, kExtent };
+   land.PointCounts = { 4 };
+
+   auto numHoles = std::max(1, (numVertices - 4) / kHoleVertices);
+   auto gridWidth = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(numHoles))));
+   auto cellSize = 2 * kExtent / gridWidth;
+   auto radius = cellSize * 0.45;
+
+   std::mt19937 rng(gridWidth);
+   std::uniform_real_distribution<double> jitter(-0.04, 0.04);
+
+   for (auto i = 0; i < numHoles; i++) {
+      auto cx = -kExtent + cellSize * (i % gridWidth) + cellSize / 2 + jitter(rng) * cellSize;
+      auto cy = -kExtent + cellSize * (i / gridWidth) + cellSize / 2 + jitter(rng) * cellSize;
+      for (auto j = 0; j < kHoleVertices; j++) {
+         auto theta = 2 * 3.14159265358979 * j / kHoleVertices;
+         holes.Xy.push_back(static_cast<ClipperLib::cInt>(cx + radius * std::cos(theta)));
+         holes.Xy.push_back(static_cast<ClipperLib::cInt>(cy + radius * std::sin(theta)));
       }
+      holes.PointCounts.push_back(kHoleVertices);
    }
+}
 
-//   int a, b, c, d;
-//   std::vector<IntLineSegment2> ls; 
-//   while (fs >> a && fs >> b && fs >> c && fs >> d) {
-//      //std::cout << a << " " << b << " " << c << " " << d << std::endl;
-//      ls.push_back({ {a, b}, {c ,d} });
-//   }
+// A square of land with gridWidth x gridWidth diamond holes whose corners
+// touch their neighbours', so the StrictlySimple difference splits the land at
+// every touch and fixes up FirstLeft for each split.
+void BuildDiamondGridMap(int gridWidth, FlatPaths& land, FlatPaths& holes) {
+   const int kCellSize = 100;
+   const int kExtent = gridWidth * kCellSize / 2 + kCellSize;
+
+   land.Xy = { -kExtent, -kExtent, kExtent, -kExtent, kExtent, kExtent, -kExtent, kExtent };
+   land.PointCounts = { 4 };
+
+   for (auto y = 0; y < gridWidth; y++) {
+      for (auto x = 0; x < gridWidth; x++) {
+         ClipperLib::cInt cx = (x - gridWidth / 2) * kCellSize, cy = (y - gridWidth / 2) * kCellSize, r = kCellSize / 2;
+         holes.Xy.insert(holes.Xy.end(), { cx - r, cy, cx, cy - r, cx + r, cy, cx, cy + r });
+         holes.PointCounts.push_back(4);
+      }
+   }
+}
 
-   for (auto trial = 0; trial < 50000; trial++) {
-      runTrial2(included, excluded);
+// Serialises a PolyTree's shape (nesting depth, hole flag, contour) so two
+// results can be compared exactly.
+void DumpPolyTree(const ClipperLib::PolyNode& node, int depth, std::string& out) {
+   for (auto child : node.Childs) {
+      out += std::to_string(depth) + (child->IsHole() ? "h" : "o") + std::to_string(child->Contour.size()) + ":";
+      for (auto& p : child->Contour) out += " " + std::to_string(p.X) + "," + std::to_string(p.Y);
+      out += "\n";
+      DumpPolyTree(*child, depth + 1, out);
    }
+}
 
-   std::cout << "Starting" << std::endl;
+// One verification case: a random soup of overlapping polygons, dense enough to
+// produce well over ParallelOutRecThreshold OutRecs and plenty of joins.
+std::string RunVerifyCase(int seed, unsigned threads) {
+   std::mt19937 rng(seed);
+   ClipperLib::Clipper x { seed % 8 < 4 ? ClipperLib::ioStrictlySimple : 0 };
+   x.PostProcessingThreads(threads);
 
-   std::chrono::high_resolution_clock::time_point t1 = std::chrono::high_resolution_clock::now();
+   auto numPolygons = 50 + static_cast<int>(rng() % 250);
+   for (auto i = 0; i < numPolygons; i++) {
+      ClipperLib::Path path;
+      auto cx = static_cast<ClipperLib::cInt>(rng() % 4000);
+      auto cy = static_cast<ClipperLib::cInt>(rng() % 4000);
+      auto radius = 5 + static_cast<int>(rng() % 300);
+      auto numVertices = 3 + static_cast<int>(rng() % 6);
+      for (auto j = 0; j < numVertices; j++) {
+         auto theta = 2 * 3.14159265358979 * j / numVertices + (rng() % 100) / 300.0;
+         auto r = radius * (50 + static_cast<int>(rng() % 50)) / 100;
+         path.push_back({ cx + static_cast<ClipperLib::cInt>(r * std::cos(theta)), cy + static_cast<ClipperLib::cInt>(r * std::sin(theta)) });
+      }
+      x.AddPath(path, i % 3 ? ClipperLib::ptSubject : ClipperLib::ptClip, true);
+   }
 
-   for (auto trial = 0; trial < 100000; trial++) {
-      runTrial2(included, excluded);
+   ClipperLib::PolyTree res{};
+   x.Execute(static_cast<ClipperLib::ClipType>(seed % 4), res, ClipperLib::pftNonZero, ClipperLib::pftEvenOdd);
+   std::string out;
+   DumpPolyTree(res, 0, out);
+   return out;
+}
+
+// The map case from the difference_strictly_simple benchmark, on the PolyTree path.
+std::string RunVerifyMap(unsigned threads) {
+   FlatPaths included, excluded;
+   LoadContours("test2d.txt", included, excluded);
+   ClipperLib::Clipper x { ClipperLib::ioStrictlySimple };
+   x.PostProcessingThreads(threads);
+   x.AddPaths(included.ToPaths(), ClipperLib::ptSubject, true);
+   x.AddPaths(excluded.ToPaths(), ClipperLib::ptClip, true);
+
+   ClipperLib::PolyTree res{};
+   x.Execute(ClipperLib::ctDifference, res, ClipperLib::pftPositive);
+   std::string out;
+   DumpPolyTree(res, 0, out);
+   return out;
+}
+
+// FNV-1a, enough to tell PolyTree dumps apart without storing them.
+uint64_t HashDump(const std::string& dump) {
+   uint64_t hash = 14695981039346656037ull;
+   for (auto c : dump) {
+      hash ^= static_cast<unsigned char>(c);
+      hash *= 1099511628211ull;
+   }
+   return hash;
+}
+
+// Checks that the parallel post-processing passes produce exactly the serial
+// result, and that the serial result still matches polytree_reference.txt,
+// which was recorded with Clipper before the OutRec bounds and index were
+// added to the FirstLeft fixups. Eight threads are forced so the parallel path
+// runs on any machine.
+int RunVerify() {
+   std::vector<std::pair<std::string, uint64_t>> reference;
+   auto fs = OpenFixture("polytree_reference.txt");
+   std::string name;
+   uint64_t hash;
+   while (fs >> name >> std::hex >> hash >> std::dec) reference.emplace_back(name, hash);
+
+   auto failures = 0;
+   for (auto& entry : reference) {
+      auto isMap = entry.first == "test2d";
+      auto seed = isMap ? 0 : std::atoi(entry.first.c_str());
+      auto serial = isMap ? RunVerifyMap(1) : RunVerifyCase(seed, 1);
+      auto parallel = isMap ? RunVerifyMap(8) : RunVerifyCase(seed, 8);
+      if (serial != parallel) {
+         std::cout << "case " << entry.first << ": parallel PolyTree differs from serial" << std::endl;
+         failures++;
+      } else if (HashDump(serial) != entry.second) {
+         std::cout << "case " << entry.first << ": PolyTree differs from polytree_reference.txt" << std::endl;
+         failures++;
+      }
+   }
+   std::cout << (reference.size() - failures) << "/" << reference.size() << " verification cases passed" << std::endl;
+   return failures == 0 && !reference.empty() ? 0 : 1;
+}
+
+struct BenchmarkResult {
+   std::string Name;
+   int Vertices;
+   long long Iterations;
+   double NsPerOp;
+   double AllocationsPerOp;
+};
+
+static volatile long long g_sink = 0;
+
+// Runs fn until ~minDuration has elapsed (after one warmup call), reporting the mean.
+template <typename TFunc>
+BenchmarkResult RunBenchmark(const std::string& name, int vertices, TFunc fn) {
+   const auto minDuration = std::chrono::milliseconds(250);
+   g_sink += fn();
+
+   long long iterations = 0;
+   auto allocationsStart = g_allocations.load();
+   auto start = std::chrono::high_resolution_clock::now();
+   auto now = start;
+   do {
+      g_sink += fn();
+      iterations++;
+      now = std::chrono::high_resolution_clock::now();
+   } while (now - start < minDuration);
+   auto allocations = g_allocations.load() - allocationsStart;
+
+   auto ns = std::chrono::duration_cast<std::chrono::duration<double, std::nano>>(now - start).count();
+   BenchmarkResult result{ name, vertices, iterations, ns / iterations, static_cast<double>(allocations) / iterations };
+   std::cout << std::left << std::setw(36) << name << std::right
+             << std::setw(8) << vertices << " verts "
+             << std::setw(18) << std::setprecision(1) << result.NsPerOp << " ns/op "
+             << std::setw(12) << std::setprecision(1) << result.AllocationsPerOp << " allocs/op "
+             << std::setw(8) << iterations << " iters" << std::endl;
+   return result;
+}
+
+void WriteJson(const std::string& path, const std::vector<BenchmarkResult>& results) {
+   std::ofstream out(path);
+   out << std::setprecision(3) << std::fixed;
+   out << "[" << std::endl;
+   for (size_t i = 0; i < results.size(); i++) {
+      const auto& r = results[i];
+      out << "  { \"name\": \"" << r.Name << "\", \"vertices\": " << r.Vertices
+          << ", \"iterations\": " << r.Iterations << ", \"ns_per_op\": " << r.NsPerOp
+          << ", \"allocs_per_op\": " << r.AllocationsPerOp << " }"
+          << (i + 1 == results.size() ? "" : ",") << std::endl;
+   }
+   out << "]" << std::endl;
+}
+
+// Usage: LineSegmentTestsCpp [--json results.json] [--filter substring] [--verify]
+// --verify skips the benchmarks and checks Clipper's output instead.
+int main(int argc, char** argv) {
+   std::cout << std::setprecision(10) << std::fixed;
+
+   std::string jsonPath, filter;
+   for (auto i = 1; i < argc; i++) {
+      if (std::strcmp(argv[i], "--verify") == 0) return RunVerify();
+      if (i + 1 == argc) break;
+      if (std::strcmp(argv[i], "--json") == 0) jsonPath = argv[++i];
+      else if (std::strcmp(argv[i], "--filter") == 0) filter = argv[++i];
+   }
+   auto enabled = [&](const std::string& name) { return filter.empty() || name.find(filter) != std::string::npos; };
+
+   std::vector<BenchmarkResult> results;
+
+   if (enabled("all_pairs_segments")) {
+      auto segments = LoadSegments("segments.txt");
+      for (auto n = 10; n <= static_cast<int>(segments.size()); n *= 10) {
+         results.push_back(RunBenchmark("all_pairs_segments", n, [&] { return runTrial(segments.data(), n); }));
+      }
+   }
+
+   if (enabled("difference_strictly_simple")) {
+      FlatPaths included, excluded;
+      LoadContours("test2d.txt", included, excluded);
+      results.push_back(RunBenchmark("difference_strictly_simple/test2d", included.NumVertices() + excluded.NumVertices(), [&] { return runTrial2(included, excluded); }));
+
+      for (auto gridWidth = 10; gridWidth <= 100; gridWidth *= 10) {
+         FlatPaths land, holes;
+         BuildDiamondGridMap(gridWidth, land, holes);
+         results.push_back(RunBenchmark("difference_strictly_simple/diamond_grid", land.NumVertices() + holes.NumVertices(), [&] { return runTrial2(land, holes); }));
+      }
    }
 
-   std::chrono::high_resolution_clock::time_point t2 = std::chrono::high_resolution_clock::now();
-   std::chrono::duration<double> time_span = std::chrono::duration_cast<std::chrono::duration<double>>(t2 - t1);
+   for (auto n = 10; n <= 100000; n *= 10) {
+      FlatPaths land, holes;
+      BuildSyntheticMap(n, land, holes);
+      auto vertices = land.NumVertices() + holes.NumVertices();
+
+      if (enabled("difference_strictly_simple")) {
+         results.push_back(RunBenchmark("difference_strictly_simple", vertices, [&] { return runTrial2(land, holes); }));
+      }
+
+      if (enabled("union")) {
+         results.push_back(RunBenchmark("union", vertices, [&] { return runUnion(holes); }));
+      }
+
+      if (enabled("offset")) {
+         auto paths = holes.ToPaths();
+         results.push_back(RunBenchmark("offset", vertices, [&] { return runOffset(paths); }));
+      }
 
-   std::cout << "It took me " << time_span.count() << " seconds.";
-   std::cout << std::endl;
+      if (enabled("minkowski")) {
+         auto paths = holes.ToPaths();
+         ClipperLib::Path pattern = { { -10, -10 }, { 10, -10 }, { 10, 10 }, { -10, 10 } };
+         results.push_back(RunBenchmark("minkowski", vertices, [&] { return runMinkowski(pattern, paths); }));
+      }
+   }
 
-   while (true) {
-      srand(0);
+   if (!jsonPath.empty()) {
+      WriteJson(jsonPath, results);
+      std::cout << "Wrote " << results.size() << " results to " << jsonPath << std::endl;
    }
    return 0;
-}
\ No newline at end of file
+}